@@ -0,0 +1,152 @@
+/*
+* export-giggle
+* LatencyHistogram.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_LATENCYHISTOGRAM_HPP
+#define EXPORT_GIGGLE_LATENCYHISTOGRAM_HPP
+
+#include <Types.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace giggle::bench
+{
+
+	using namespace giggle::common;
+
+	/**
+	 * @brief A fixed-precision latency histogram in the style of HdrHistogram.
+	 *
+	 * Values are counted in log-linear buckets: every power of two range
+	 * is split into SUB_BUCKETS / 2 linear buckets, so any recorded value
+	 * is reported within 1 / (SUB_BUCKETS / 2) of its true value, from
+	 * nanoseconds up to hours, with a fixed memory footprint and an O(1),
+	 * allocation-free Record(). Histograms recorded on different threads
+	 * are combined with Merge().
+	 */
+	class LatencyHistogram
+	{
+	public:
+
+		enum
+		{
+			SUB_BUCKET_BITS = 8,
+			SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+			HALF_SUB_BUCKETS = SUB_BUCKETS / 2,
+			BUCKETS = (64 - SUB_BUCKET_BITS + 2) * HALF_SUB_BUCKETS
+		};
+
+		LatencyHistogram():
+			_counts(BUCKETS, 0),
+			_total(0),
+			_sum(0),
+			_min(~UInt64(0)),
+			_max(0)
+		{
+
+		}
+
+		/**
+		 * @brief Counts a single value.
+		 */
+		void Record(UInt64 l_value)
+		{
+			++_counts[IndexOf(l_value)];
+			++_total;
+			_sum += l_value;
+			_min = std::min(_min, l_value);
+			_max = std::max(_max, l_value);
+		}
+
+		/**
+		 * @brief Adds the counts of another histogram to this one.
+		 */
+		void Merge(const LatencyHistogram& l_other)
+		{
+			for (std::size_t i = 0; i < _counts.size(); ++i)
+			{
+				_counts[i] += l_other._counts[i];
+			}
+
+			_total += l_other._total;
+			_sum += l_other._sum;
+			_min = std::min(_min, l_other._min);
+			_max = std::max(_max, l_other._max);
+		}
+
+		/**
+		 * @brief Returns the value below which the given percentage of the
+		 * recorded values fall, rounded up to the top of its bucket.
+		 * @param l_percentile A percentage between 0 and 100.
+		 */
+		UInt64 Percentile(double l_percentile) const
+		{
+			if (_total == 0)
+				return 0;
+
+			auto rank = static_cast<UInt64>(l_percentile / 100.0 * _total + 0.5);
+			rank = std::max<UInt64>(1, std::min(rank, _total));
+
+			UInt64 seen = 0;
+			for (std::size_t i = 0; i < _counts.size(); ++i)
+			{
+				seen += _counts[i];
+				if (seen >= rank)
+					return std::min(HighestEquivalent(i), _max);
+			}
+
+			return _max;
+		}
+
+		UInt64 Count() const { return _total; }
+		UInt64 Min() const { return _total == 0 ? 0 : _min; }
+		UInt64 Max() const { return _max; }
+		double Mean() const { return _total == 0 ? 0.0 : static_cast<double>(_sum) / _total; }
+
+	private:
+
+		static std::size_t IndexOf(UInt64 l_value)
+		{
+			if (l_value < SUB_BUCKETS)
+				return static_cast<std::size_t>(l_value);
+
+			// Values in [2^n, 2^(n+1)) keep their top SUB_BUCKET_BITS bits.
+			auto shift = 63 - __builtin_clzll(l_value) - (SUB_BUCKET_BITS - 1);
+			return static_cast<std::size_t>(shift) * HALF_SUB_BUCKETS + static_cast<std::size_t>(l_value >> shift);
+		}
+
+		static UInt64 HighestEquivalent(std::size_t l_index)
+		{
+			if (l_index < SUB_BUCKETS)
+				return l_index;
+
+			auto shift = (l_index / HALF_SUB_BUCKETS) - 1;
+			auto mantissa = static_cast<UInt64>(l_index - shift * HALF_SUB_BUCKETS);
+			return ((mantissa + 1) << shift) - 1;
+		}
+
+		std::vector<UInt64>	_counts;
+		UInt64				_total;
+		UInt64				_sum;
+		UInt64				_min;
+		UInt64				_max;
+	};
+
+} // namespace bench
+
+#endif //EXPORT_GIGGLE_LATENCYHISTOGRAM_HPP
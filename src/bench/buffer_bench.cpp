@@ -0,0 +1,241 @@
+/*
+* export-giggle
+* buffer_bench.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+/*
+ * Microbenchmarks for memory::Buffer against std::vector<char> and
+ * std::string.
+ *
+ *  - bytes:  builds a --size byte buffer one byte at a time
+ *  - chunks: builds a --size byte buffer from --chunk byte pieces
+ *  - short:  creates a 4 byte buffer (a frame header) and drops it
+ *  - fill:   has a writer produce --size bytes in place, in --chunk
+ *            byte steps (Reserve()/Commit() for Buffer, resize() then
+ *            writing for the standard containers)
+ *
+ * Each workload reports nanoseconds per operation, where an operation
+ * is one append, one buffer or one chunk respectively.
+ */
+
+#include <memory/Buffer.hpp>
+#include <Types.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace giggle::common;
+using namespace giggle::common::memory;
+
+namespace
+{
+
+	struct Options
+	{
+		std::size_t Size = 65536;
+		std::size_t Chunk = 100;
+		UInt32 Iterations = 200;
+	};
+
+	void Usage()
+	{
+		std::cerr <<
+			"usage: buffer_bench [options]\n"
+			"  --size=BYTES      the size buffers are built up to (65536)\n"
+			"  --chunk=BYTES     the piece size of the chunk and fill workloads (100)\n"
+			"  --iterations=N    buffers built per workload (200)\n";
+	}
+
+	bool Parse(int argc, char** argv, Options& l_options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string argument = argv[i];
+			auto separator = argument.find('=');
+			auto key = argument.substr(0, separator);
+			auto value = separator == std::string::npos ? std::string() : argument.substr(separator + 1);
+
+			if (key == "--size") l_options.Size = std::stoul(value);
+			else if (key == "--chunk") l_options.Chunk = std::stoul(value);
+			else if (key == "--iterations") l_options.Iterations = std::stoul(value);
+			else return false;
+		}
+
+		return l_options.Size > 0 && l_options.Chunk > 0 && l_options.Iterations > 0;
+	}
+
+	/// Keeps the compiler from optimizing the buffers away.
+	volatile std::size_t s_sink;
+
+	template <class F>
+	double Measure(UInt64 l_operations, F&& l_workload)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		l_workload();
+		auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+		return elapsed / static_cast<double>(l_operations);
+	}
+
+	/*
+	 * One adapter per container, so every workload is written once.
+	 */
+
+	struct BufferAdapter
+	{
+		static constexpr const char* Name = "Buffer";
+
+		Buffer<char> Data{0};
+
+		void Append(char l_value) { Data.Append(l_value); }
+		void Append(const char* l_data, std::size_t l_size) { Data.Append(l_data, l_size); }
+		char* Reserve(std::size_t l_size) { return Data.Reserve(l_size); }
+		void Commit(std::size_t l_size) { Data.Commit(l_size); }
+		std::size_t Size() const { return Data.Size(); }
+
+		static std::size_t Short(const char* l_header)
+		{
+			Buffer<char> buffer(l_header, 4);
+			return static_cast<std::size_t>(buffer.Begin()[3]);
+		}
+	};
+
+	struct VectorAdapter
+	{
+		static constexpr const char* Name = "std::vector";
+
+		std::vector<char> Data;
+
+		void Append(char l_value) { Data.push_back(l_value); }
+		void Append(const char* l_data, std::size_t l_size) { Data.insert(Data.end(), l_data, l_data + l_size); }
+		char* Reserve(std::size_t l_size) { Data.resize(Data.size() + l_size); return Data.data() + Data.size() - l_size; }
+		void Commit(std::size_t) { }
+		std::size_t Size() const { return Data.size(); }
+
+		static std::size_t Short(const char* l_header)
+		{
+			std::vector<char> buffer(l_header, l_header + 4);
+			return static_cast<std::size_t>(buffer[3]);
+		}
+	};
+
+	struct StringAdapter
+	{
+		static constexpr const char* Name = "std::string";
+
+		std::string Data;
+
+		void Append(char l_value) { Data.push_back(l_value); }
+		void Append(const char* l_data, std::size_t l_size) { Data.append(l_data, l_size); }
+		char* Reserve(std::size_t l_size) { Data.resize(Data.size() + l_size); return &Data[Data.size() - l_size]; }
+		void Commit(std::size_t) { }
+		std::size_t Size() const { return Data.size(); }
+
+		static std::size_t Short(const char* l_header)
+		{
+			std::string buffer(l_header, 4);
+			return static_cast<std::size_t>(buffer[3]);
+		}
+	};
+
+	template <class C>
+	void Report(const Options& l_options, const std::vector<char>& l_chunk)
+	{
+		const char header[4] = {0, 0, 0, 42};
+		auto bytes = static_cast<UInt64>(l_options.Size) * l_options.Iterations;
+		auto chunks = (l_options.Size + l_options.Chunk - 1) / l_options.Chunk * l_options.Iterations;
+
+		auto perByte = Measure(bytes, [&]()
+		{
+			for (UInt32 i = 0; i < l_options.Iterations; ++i)
+			{
+				C container;
+				for (std::size_t n = 0; n < l_options.Size; ++n)
+					container.Append(static_cast<char>(n));
+				s_sink = container.Size();
+			}
+		});
+
+		auto perChunk = Measure(chunks, [&]()
+		{
+			for (UInt32 i = 0; i < l_options.Iterations; ++i)
+			{
+				C container;
+				while (container.Size() < l_options.Size)
+					container.Append(l_chunk.data(), l_chunk.size());
+				s_sink = container.Size();
+			}
+		});
+
+		auto perShort = Measure(bytes, [&]()
+		{
+			std::size_t sum = 0;
+			for (UInt64 i = 0; i < bytes; ++i)
+				sum += C::Short(header);
+			s_sink = sum;
+		});
+
+		auto perFill = Measure(chunks, [&]()
+		{
+			for (UInt32 i = 0; i < l_options.Iterations; ++i)
+			{
+				C container;
+				while (container.Size() < l_options.Size)
+				{
+					auto space = container.Reserve(l_options.Chunk);
+					std::memset(space, static_cast<int>(i), l_options.Chunk);
+					container.Commit(l_options.Chunk);
+				}
+				s_sink = container.Size();
+			}
+		});
+
+		std::printf("%-12s %12.2f %12.2f %12.2f %12.2f\n", C::Name, perByte, perChunk, perShort, perFill);
+	}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	try
+	{
+		if (!Parse(argc, argv, options))
+		{
+			Usage();
+			return EXIT_FAILURE;
+		}
+	}
+	catch (const std::exception&)
+	{
+		Usage();
+		return EXIT_FAILURE;
+	}
+
+	std::vector<char> chunk(options.Chunk, 'x');
+
+	std::printf("%-12s %12s %12s %12s %12s\n", "ns/op", "bytes", "chunks", "short", "fill");
+	Report<BufferAdapter>(options, chunk);
+	Report<VectorAdapter>(options, chunk);
+	Report<StringAdapter>(options, chunk);
+
+	return EXIT_SUCCESS;
+}
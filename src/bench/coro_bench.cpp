@@ -0,0 +1,261 @@
+/*
+* export-giggle
+* coro_bench.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+/*
+ * A benchmark of the coroutine runtime.
+ *
+ * Measures awaiting a Task that completes at once, hopping a coroutine
+ * onto a ThreadPool with Schedule(), and the round trip of a small
+ * message through a loopback echo server whose connections are each
+ * served by one coroutine over an AsyncStream. Needs C++20; the rest of
+ * the tree builds as C++17.
+ */
+
+#include <net/AsyncStream.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef GIGGLE_HAVE_COROUTINES
+#error "coro_bench needs a compiler with C++20 coroutines"
+#endif
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+using namespace giggle::common::threading;
+
+namespace
+{
+
+	struct Options
+	{
+		UInt32 Port = 8061;
+		UInt32 Iterations = 1000000;
+		UInt32 Messages = 20000;
+		std::size_t MessageSize = 64;
+	};
+
+	void Usage()
+	{
+		std::cerr <<
+			"usage: coro_bench [options]\n"
+			"  --port=N         port of the echo server (8061)\n"
+			"  --iterations=N   awaits and hops measured (1000000)\n"
+			"  --messages=N     echo round trips measured (20000)\n"
+			"  --size=BYTES     echo message size (64)\n";
+	}
+
+	bool Parse(int argc, char** argv, Options& l_options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string argument = argv[i];
+			auto separator = argument.find('=');
+			auto key = argument.substr(0, separator);
+			auto value = separator == std::string::npos ? std::string() : argument.substr(separator + 1);
+
+			if (key == "--port") l_options.Port = std::stoul(value);
+			else if (key == "--iterations") l_options.Iterations = std::stoul(value);
+			else if (key == "--messages") l_options.Messages = std::stoul(value);
+			else if (key == "--size") l_options.MessageSize = std::stoul(value);
+			else return false;
+		}
+
+		return l_options.Iterations > 0 && l_options.Messages > 0 && l_options.MessageSize > 0;
+	}
+
+	double Seconds(std::chrono::steady_clock::time_point l_begin)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - l_begin).count();
+	}
+
+	Task<UInt32> Value(UInt32 l_value)
+	{
+		co_return l_value;
+	}
+
+	Task<UInt64> Sum(UInt32 l_count)
+	{
+		UInt64 sum = 0;
+		for (UInt32 i = 0; i < l_count; ++i)
+		{
+			sum += co_await Value(i);
+		}
+		co_return sum;
+	}
+
+	Task<void> Hop(Executor& l_executor, UInt32 l_count)
+	{
+		for (UInt32 i = 0; i < l_count; ++i)
+		{
+			co_await Schedule(l_executor);
+		}
+	}
+
+	Task<void> Echo(std::shared_ptr<AsyncStream> l_stream)
+	{
+		char buffer[4096];
+
+		while (auto count = co_await AsyncRead(*l_stream, buffer, sizeof(buffer)))
+		{
+			if (!co_await AsyncWrite(*l_stream, buffer, count))
+				break;
+		}
+	}
+
+	Task<void> Accept(AsyncListener& l_listener)
+	{
+		while (auto stream = co_await AsyncAccept(l_listener))
+		{
+			Spawn(stream->Executor(), Echo(stream));
+		}
+	}
+
+	int Connect(UInt32 l_port)
+	{
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(l_port);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		// The server may still be binding; give it a moment.
+		for (int attempt = 0; attempt < 100; ++attempt)
+		{
+			int descriptor = socket(AF_INET, SOCK_STREAM, 0);
+			if (descriptor < 0)
+				break;
+
+			if (connect(descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0)
+			{
+				int enable = 1;
+				setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+				return descriptor;
+			}
+
+			close(descriptor);
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}
+
+		return -1;
+	}
+
+	/**
+	 * @brief Sends l_messages messages one at a time, waiting for each echo.
+	 * @return Seconds per round trip, or a negative value on failure.
+	 */
+	double PingPong(const Options& l_options)
+	{
+		auto descriptor = Connect(l_options.Port);
+		if (descriptor < 0)
+			return -1;
+
+		std::string message(l_options.MessageSize, 'x');
+		std::string reply(l_options.MessageSize, '\0');
+
+		auto begin = std::chrono::steady_clock::now();
+
+		for (UInt32 i = 0; i < l_options.Messages; ++i)
+		{
+			if (send(descriptor, message.data(), message.size(), 0) != static_cast<ssize_t>(message.size()))
+				return -1;
+
+			for (std::size_t received = 0; received < reply.size();)
+			{
+				auto count = recv(descriptor, &reply[received], reply.size() - received, 0);
+				if (count <= 0)
+					return -1;
+				received += static_cast<std::size_t>(count);
+			}
+		}
+
+		auto seconds = Seconds(begin) / l_options.Messages;
+		close(descriptor);
+		return reply == message ? seconds : -1;
+	}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	try
+	{
+		if (!Parse(argc, argv, options))
+		{
+			Usage();
+			return EXIT_FAILURE;
+		}
+	}
+	catch (const std::exception&)
+	{
+		Usage();
+		return EXIT_FAILURE;
+	}
+
+	auto begin = std::chrono::steady_clock::now();
+	auto sum = SyncWait(Sum(options.Iterations));
+	auto awaited = Seconds(begin) / options.Iterations;
+
+	if (sum != static_cast<UInt64>(options.Iterations) * (options.Iterations - 1) / 2)
+	{
+		std::cerr << "wrong sum " << sum << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	ThreadPool pool(1);
+	PoolExecutor executor(pool);
+
+	begin = std::chrono::steady_clock::now();
+	SyncWait(Hop(executor, options.Iterations));
+	auto hopped = Seconds(begin) / options.Iterations;
+
+	TcpServer server(options.Port, 64);
+	AsyncListener listener(server);
+	Spawn(executor, Accept(listener));
+
+	std::thread serverThread([&server]() { server.Listen(); });
+	auto roundTrip = PingPong(options);
+
+	server.Close();
+	serverThread.join();
+	listener.Close();
+
+	if (roundTrip < 0)
+	{
+		std::cerr << "echo failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::printf("%-28s %10.1f ns\n", "co_await ready Task", awaited * 1e9);
+	std::printf("%-28s %10.1f ns\n", "Schedule() onto ThreadPool", hopped * 1e9);
+	std::printf("%-28s %10.1f us\n", "AsyncStream echo round trip", roundTrip * 1e6);
+
+	return EXIT_SUCCESS;
+}
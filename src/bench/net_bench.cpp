@@ -0,0 +1,622 @@
+/*
+* export-giggle
+* net_bench.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+/*
+ * A loopback load generator and latency benchmark for TcpServer.
+ *
+ * Starts an echo TcpServer in-process (or targets an external one with
+ * --external) and drives it with length-prefixed request frames from
+ * a set of client threads, each multiplexing its share of the connections
+ * on its own epoll instance. Every request carries the time it was meant
+ * to be sent, which the server echoes back in the response, so latency
+ * is measured without any per-request bookkeeping.
+ *
+ * Closed loop (the default) keeps --depth requests in flight on every
+ * connection. Open loop (--rate) issues requests on a fixed schedule
+ * regardless of responses and measures from the scheduled time, so a
+ * stalled server shows up in the tail instead of silently lowering the
+ * offered load (coordinated omission).
+ *
+ * Server modes:
+ *   reactor	frames are answered on the epoll reactor thread
+ *   uring		frames are answered on the io_uring reactor thread
+ *   pool		frames are handed to a ThreadPool, which answers through
+ *			TcpServer::Send(), the thread-per-request model
+ */
+
+#include "LatencyHistogram.hpp"
+
+#include <net/TcpServer.hpp>
+#include <net/FrameDecoder.hpp>
+#include <threading/ThreadPool.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+using namespace giggle::bench;
+
+namespace
+{
+
+	typedef std::chrono::steady_clock Clock;
+
+	const std::size_t TIMESTAMP_SIZE = sizeof(UInt64);
+	const std::size_t READ_SIZE = 65536;
+
+	struct Options
+	{
+		std::string Mode = "reactor";
+		std::string Host = "127.0.0.1";
+		UInt32 Port = 9900;
+		bool External = false;
+		UInt32 Reactors = 1;
+		UInt32 Workers = std::max(1u, std::thread::hardware_concurrency());
+		UInt32 Connections = 64;
+		UInt32 Threads = 2;
+		UInt32 RequestSize = 64;
+		UInt32 ResponseSize = 0;
+		UInt32 Depth = 1;
+		UInt64 Rate = 0;
+		double Duration = 10;
+		double Warmup = 1;
+	};
+
+	/**
+	 * @brief Everything a client thread measured.
+	 */
+	struct Result
+	{
+		LatencyHistogram Latency;
+		UInt64 Requests = 0;
+		UInt64 BytesOut = 0;
+		UInt64 BytesIn = 0;
+		UInt64 Errors = 0;
+	};
+
+	struct Client
+	{
+		int Descriptor = -1;
+		FrameDecoder Decoder;
+		std::vector<char> Output;
+		std::size_t Written = 0;
+		bool Open = true;
+	};
+
+	UInt64 Nanoseconds(Clock::time_point l_time)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(l_time.time_since_epoch()).count();
+	}
+
+	UInt64 Now()
+	{
+		return Nanoseconds(Clock::now());
+	}
+
+	void Usage()
+	{
+		std::cerr <<
+			"usage: net_bench [options]\n"
+			"  --mode=reactor|uring|pool  server mode (reactor)\n"
+			"  --reactors=N               server reactors (1)\n"
+			"  --workers=N                ThreadPool threads in pool mode (hardware threads)\n"
+			"  --external                 do not start a server, target --host/--port\n"
+			"  --host=ADDR                server address (127.0.0.1)\n"
+			"  --port=N                   server port (9900)\n"
+			"  --connections=N            client connections (64)\n"
+			"  --threads=N                client threads (2)\n"
+			"  --size=BYTES               request payload size, at least 8 (64)\n"
+			"  --response=BYTES           response payload size, at least 8 (request size)\n"
+			"  --depth=N                  requests in flight per connection, closed loop (1)\n"
+			"  --rate=N                   requests per second over all connections, open loop (0: closed loop)\n"
+			"  --duration=SECONDS         measured duration (10)\n"
+			"  --warmup=SECONDS           unmeasured warmup (1)\n";
+	}
+
+	bool Parse(int argc, char** argv, Options& l_options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string argument = argv[i];
+			auto separator = argument.find('=');
+			auto key = argument.substr(0, separator);
+			auto value = separator == std::string::npos ? std::string() : argument.substr(separator + 1);
+
+			if (key == "--mode") l_options.Mode = value;
+			else if (key == "--host") l_options.Host = value;
+			else if (key == "--port") l_options.Port = std::stoul(value);
+			else if (key == "--external") l_options.External = true;
+			else if (key == "--reactors") l_options.Reactors = std::stoul(value);
+			else if (key == "--workers") l_options.Workers = std::stoul(value);
+			else if (key == "--connections") l_options.Connections = std::stoul(value);
+			else if (key == "--threads") l_options.Threads = std::stoul(value);
+			else if (key == "--size") l_options.RequestSize = std::stoul(value);
+			else if (key == "--response") l_options.ResponseSize = std::stoul(value);
+			else if (key == "--depth") l_options.Depth = std::stoul(value);
+			else if (key == "--rate") l_options.Rate = std::stoull(value);
+			else if (key == "--duration") l_options.Duration = std::stod(value);
+			else if (key == "--warmup") l_options.Warmup = std::stod(value);
+			else return false;
+		}
+
+		if (l_options.ResponseSize == 0)
+			l_options.ResponseSize = l_options.RequestSize;
+
+		l_options.Threads = std::max(1u, std::min(l_options.Threads, l_options.Connections));
+		if (l_options.Rate != 0)
+			l_options.Threads = static_cast<UInt32>(std::min<UInt64>(l_options.Threads, l_options.Rate));
+		l_options.Depth = std::max(1u, l_options.Depth);
+
+		return l_options.Connections > 0 &&
+			   l_options.RequestSize >= TIMESTAMP_SIZE && l_options.ResponseSize >= TIMESTAMP_SIZE &&
+			   (l_options.Mode == "reactor" || l_options.Mode == "uring" || l_options.Mode == "pool");
+	}
+
+	/**
+	 * @brief Builds a response frame, header included, echoing the request timestamp.
+	 */
+	memory::Buffer<char> Response(const char* l_timestamp, UInt32 l_size)
+	{
+		memory::Buffer<char> frame(FrameDecoder::HEADER_SIZE + l_size);
+		std::memset(frame.Begin(), 0, frame.Size());
+		FrameDecoder::EncodeHeader(frame.Begin(), l_size);
+		std::memcpy(frame.Begin() + FrameDecoder::HEADER_SIZE, l_timestamp, TIMESTAMP_SIZE);
+		return frame;
+	}
+
+	int Connect(const Options& l_options)
+	{
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(l_options.Port);
+		if (inet_pton(AF_INET, l_options.Host.c_str(), &address.sin_addr) != 1)
+		{
+			std::cerr << "invalid address " << l_options.Host << std::endl;
+			return -1;
+		}
+
+		// The in-process server may still be binding; give it a moment.
+		for (int attempt = 0; attempt < 100; ++attempt)
+		{
+			int descriptor = socket(AF_INET, SOCK_STREAM, 0);
+			if (descriptor < 0)
+				break;
+
+			if (connect(descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0)
+			{
+				int enable = 1;
+				setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+				fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL, 0) | O_NONBLOCK);
+				return descriptor;
+			}
+
+			auto error = errno;
+			close(descriptor);
+			if (error != ECONNREFUSED)
+			{
+				errno = error;
+				break;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}
+
+		std::cerr << "connect: " << std::strerror(errno) << std::endl;
+		return -1;
+	}
+
+	/**
+	 * @brief Drives the given number of connections until l_end (in ns),
+	 * recording latencies of responses received after l_measureFrom.
+	 */
+	class LoadThread
+	{
+	public:
+
+		LoadThread(const Options& l_options, UInt32 l_connections, UInt64 l_rate,
+				   UInt64 l_measureFrom, UInt64 l_end):
+			_options(l_options),
+			_clients(l_connections),
+			_rate(l_rate),
+			_measureFrom(l_measureFrom),
+			_end(l_end),
+			_next(0),
+			_epoll(-1)
+		{
+
+		}
+
+		~LoadThread()
+		{
+			for (auto& client : _clients)
+			{
+				if (client.Descriptor >= 0)
+					close(client.Descriptor);
+			}
+
+			if (_epoll >= 0)
+				close(_epoll);
+		}
+
+		void Run()
+		{
+			_epoll = epoll_create1(0);
+
+			for (auto& client : _clients)
+			{
+				client.Descriptor = Connect(_options);
+				if (client.Descriptor < 0)
+				{
+					client.Open = false;
+					++_result.Errors;
+					continue;
+				}
+
+				epoll_event event{};
+				event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+				event.data.ptr = &client;
+				epoll_ctl(_epoll, EPOLL_CTL_ADD, client.Descriptor, &event);
+			}
+
+			auto start = Now();
+
+			if (_rate == 0)
+			{
+				for (auto& client : _clients)
+				{
+					for (UInt32 i = 0; i < _options.Depth; ++i)
+						Request(client, start);
+				}
+			}
+
+			auto interval = _rate == 0 ? 0 : std::max<UInt64>(1, 1000000000ull / _rate);
+			UInt64 scheduled = start;
+			std::vector<epoll_event> events(_clients.size());
+
+			for (auto now = start; now < _end; now = Now())
+			{
+				auto timeout = std::min<UInt64>(_end - now, 100000000ull);
+
+				if (_rate != 0)
+				{
+					// Catch up on every request that was due, even late ones; their
+					// latency counts from when they should have gone out.
+					while (scheduled <= now)
+					{
+						Request(NextClient(), scheduled);
+						scheduled += interval;
+					}
+
+					timeout = scheduled - now;
+				}
+
+				auto ready = epoll_wait(_epoll, events.data(), static_cast<int>(events.size()),
+										static_cast<int>(timeout / 1000000ull));
+				if (ready < 0 && errno != EINTR)
+				{
+					std::cerr << "epoll_wait: " << std::strerror(errno) << std::endl;
+					break;
+				}
+
+				for (int i = 0; i < ready; ++i)
+				{
+					auto& client = *static_cast<Client*>(events[i].data.ptr);
+
+					if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+						Read(client);
+
+					if (events[i].events & EPOLLOUT)
+						Write(client);
+				}
+			}
+		}
+
+		const Result& Measured() const
+		{
+			return _result;
+		}
+
+	private:
+
+		Client& NextClient()
+		{
+			for (std::size_t i = 0; i < _clients.size(); ++i)
+			{
+				auto& client = _clients[_next++ % _clients.size()];
+				if (client.Open)
+					return client;
+			}
+
+			return _clients[0];
+		}
+
+		void Request(Client& l_client, UInt64 l_timestamp)
+		{
+			if (!l_client.Open)
+				return;
+
+			auto offset = l_client.Output.size();
+			l_client.Output.resize(offset + FrameDecoder::HEADER_SIZE + _options.RequestSize, 0);
+
+			auto frame = l_client.Output.data() + offset;
+			FrameDecoder::EncodeHeader(frame, _options.RequestSize);
+			std::memcpy(frame + FrameDecoder::HEADER_SIZE, &l_timestamp, TIMESTAMP_SIZE);
+
+			Write(l_client);
+		}
+
+		void Write(Client& l_client)
+		{
+			while (l_client.Open && l_client.Written < l_client.Output.size())
+			{
+				auto sent = send(l_client.Descriptor, l_client.Output.data() + l_client.Written,
+								 l_client.Output.size() - l_client.Written, MSG_NOSIGNAL);
+				if (sent < 0)
+				{
+					if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+						Fail(l_client);
+
+					if (errno != EINTR)
+						return;
+
+					continue;
+				}
+
+				l_client.Written += sent;
+				if (Now() >= _measureFrom)
+					_result.BytesOut += sent;
+			}
+
+			l_client.Output.clear();
+			l_client.Written = 0;
+		}
+
+		void Read(Client& l_client)
+		{
+			char buffer[READ_SIZE];
+
+			while (l_client.Open)
+			{
+				auto received = recv(l_client.Descriptor, buffer, sizeof(buffer), 0);
+				if (received <= 0)
+				{
+					if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+						Fail(l_client);
+
+					if (received < 0 && errno == EINTR)
+						continue;
+
+					return;
+				}
+
+				auto now = Now();
+				auto measured = now >= _measureFrom;
+				if (measured)
+					_result.BytesIn += received;
+
+				auto valid = l_client.Decoder.Feed(buffer, static_cast<std::size_t>(received), [&](const Frame& l_frame)
+				{
+					if (l_frame.Size < TIMESTAMP_SIZE)
+						return true;
+
+					UInt64 timestamp;
+					std::memcpy(&timestamp, l_frame.Data, TIMESTAMP_SIZE);
+
+					if (measured && timestamp >= _measureFrom)
+					{
+						_result.Latency.Record(now > timestamp ? now - timestamp : 0);
+						++_result.Requests;
+					}
+
+					if (_rate == 0 && now < _end)
+						Request(l_client, now);
+
+					return l_client.Open;
+				});
+
+				if (!valid)
+					Fail(l_client);
+			}
+		}
+
+		void Fail(Client& l_client)
+		{
+			if (!l_client.Open)
+				return;
+
+			l_client.Open = false;
+			++_result.Errors;
+			epoll_ctl(_epoll, EPOLL_CTL_DEL, l_client.Descriptor, nullptr);
+		}
+
+		const Options&		_options;
+		std::vector<Client>	_clients;
+		const UInt64		_rate;
+		const UInt64		_measureFrom;
+		const UInt64		_end;
+		std::size_t			_next;
+		int 				_epoll;
+		Result				_result;
+	};
+
+	void Report(const Options& l_options, const TcpServer* l_server, const Result& l_result)
+	{
+		auto seconds = l_options.Duration;
+		auto micro = [](UInt64 l_nanoseconds) { return l_nanoseconds / 1000.0; };
+
+		std::string backend = "external";
+		if (l_server != nullptr)
+			backend = l_server->Backend() == IoBackend::IoUring ? "io_uring" : "epoll";
+
+		std::printf("mode          %s (%s, %u reactor(s)%s)\n", l_options.Mode.c_str(), backend.c_str(),
+					l_server != nullptr ? l_server->Reactors() : 0, l_options.Mode == "pool" ? (", " + std::to_string(l_options.Workers) + " workers").c_str() : "");
+		std::printf("load          %u connections on %u threads, %s, %u/%u byte frames\n",
+					l_options.Connections, l_options.Threads,
+					l_options.Rate == 0 ? ("closed loop, depth " + std::to_string(l_options.Depth)).c_str()
+										: ("open loop, " + std::to_string(l_options.Rate) + " req/s").c_str(),
+					l_options.RequestSize, l_options.ResponseSize);
+		std::printf("requests      %llu in %.1fs, %.0f req/s, %llu errors\n",
+					static_cast<unsigned long long>(l_result.Requests), seconds, l_result.Requests / seconds,
+					static_cast<unsigned long long>(l_result.Errors));
+		std::printf("throughput    out %.1f MB/s, in %.1f MB/s\n",
+					l_result.BytesOut / seconds / 1e6, l_result.BytesIn / seconds / 1e6);
+		std::printf("latency (us)  min %.1f  mean %.1f  p50 %.1f  p90 %.1f  p99 %.1f  p999 %.1f  max %.1f\n",
+					micro(l_result.Latency.Min()), l_result.Latency.Mean() / 1000.0,
+					micro(l_result.Latency.Percentile(50)), micro(l_result.Latency.Percentile(90)),
+					micro(l_result.Latency.Percentile(99)), micro(l_result.Latency.Percentile(99.9)),
+					micro(l_result.Latency.Max()));
+	}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	try
+	{
+		if (!Parse(argc, argv, options))
+		{
+			Usage();
+			return EXIT_FAILURE;
+		}
+	}
+	catch (const std::exception&)
+	{
+		Usage();
+		return EXIT_FAILURE;
+	}
+
+	std::unique_ptr<TcpServer> server;
+	std::unique_ptr<threading::ThreadPool> pool;
+	std::thread serverThread;
+
+	if (!options.External)
+	{
+		TcpServerOptions serverOptions;
+		serverOptions.Reactors = options.Reactors;
+		serverOptions.MaxConnections = std::max<UInt32>(options.Connections, DEFAULT_MAX_CONNECTIONS);
+		serverOptions.Backend = options.Mode == "uring" ? IoBackend::IoUring : IoBackend::Epoll;
+
+		server.reset(new TcpServer(options.Port, serverOptions));
+		auto responseSize = options.ResponseSize;
+
+		if (options.Mode == "pool")
+		{
+			pool.reset(new threading::ThreadPool(options.Workers));
+			auto target = server.get();
+			auto workers = pool.get();
+
+			server->SetFrameHandler([target, workers, responseSize](Connection& l_connection, const Frame& l_frame)
+			{
+				UInt64 timestamp = 0;
+				std::memcpy(&timestamp, l_frame.Data, std::min(l_frame.Size, TIMESTAMP_SIZE));
+				auto id = l_connection.Id();
+
+				workers->enqueue([target, id, timestamp, responseSize]
+				{
+					target->Send(id, Response(reinterpret_cast<const char*>(&timestamp), responseSize));
+				});
+			});
+		}
+		else
+		{
+			server->SetFrameHandler([responseSize](Connection& l_connection, const Frame& l_frame)
+			{
+				UInt64 timestamp = 0;
+				std::memcpy(&timestamp, l_frame.Data, std::min(l_frame.Size, TIMESTAMP_SIZE));
+				l_connection.Send(Response(reinterpret_cast<const char*>(&timestamp), responseSize));
+			});
+		}
+
+		serverThread = std::thread([&server]
+		{
+			try
+			{
+				server->Listen();
+			}
+			catch (const std::exception& l_exception)
+			{
+				std::cerr << "server: " << l_exception.what() << std::endl;
+				std::exit(EXIT_FAILURE);
+			}
+		});
+	}
+
+	auto start = Now();
+	auto measureFrom = start + static_cast<UInt64>(options.Warmup * 1e9);
+	auto end = measureFrom + static_cast<UInt64>(options.Duration * 1e9);
+
+	std::vector<std::unique_ptr<LoadThread>> loads;
+	std::vector<std::thread> threads;
+
+	for (UInt32 i = 0; i < options.Threads; ++i)
+	{
+		// Spread connections and rate as evenly as possible over the threads.
+		auto connections = options.Connections / options.Threads + (i < options.Connections % options.Threads ? 1 : 0);
+		auto rate = options.Rate / options.Threads + (i < options.Rate % options.Threads ? 1 : 0);
+
+		loads.emplace_back(new LoadThread(options, connections, rate, measureFrom, end));
+		threads.emplace_back(&LoadThread::Run, loads.back().get());
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	Result total;
+	for (auto& load : loads)
+	{
+		auto& measured = load->Measured();
+		total.Latency.Merge(measured.Latency);
+		total.Requests += measured.Requests;
+		total.BytesOut += measured.BytesOut;
+		total.BytesIn += measured.BytesIn;
+		total.Errors += measured.Errors;
+	}
+
+	Report(options, server.get(), total);
+
+	if (server)
+	{
+		server->Close();
+		serverThread.join();
+	}
+
+	loads.clear();
+	pool.reset();
+
+	return total.Errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,168 @@
+/*
+* export-giggle
+* pool_bench.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+/*
+ * A contention benchmark for MemoryPool.
+ *
+ * Every thread repeatedly takes a handful of blocks from one shared pool
+ * and releases them again, the pattern of a server worker handling
+ * requests. The run is repeated for 1 to --threads threads (doubling),
+ * once with the per-thread magazines and once without, where every call
+ * takes the pool mutex, and the aggregate operations per second are
+ * reported for each.
+ */
+
+#include <memory/MemoryPool.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace giggle::common;
+using namespace giggle::common::memory;
+
+namespace
+{
+
+	struct Options
+	{
+		UInt32 Threads = 64;
+		UInt32 Iterations = 200000;
+		UInt32 Burst = 8;
+		std::size_t BlockSize = 256;
+	};
+
+	void Usage()
+	{
+		std::cerr <<
+			"usage: pool_bench [options]\n"
+			"  --threads=N      the largest thread count (64)\n"
+			"  --iterations=N   bursts per thread (200000)\n"
+			"  --burst=N        blocks taken before releasing them (8)\n"
+			"  --block=BYTES    block size (256)\n";
+	}
+
+	bool Parse(int argc, char** argv, Options& l_options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string argument = argv[i];
+			auto separator = argument.find('=');
+			auto key = argument.substr(0, separator);
+			auto value = separator == std::string::npos ? std::string() : argument.substr(separator + 1);
+
+			if (key == "--threads") l_options.Threads = std::stoul(value);
+			else if (key == "--iterations") l_options.Iterations = std::stoul(value);
+			else if (key == "--burst") l_options.Burst = std::stoul(value);
+			else if (key == "--block") l_options.BlockSize = std::stoul(value);
+			else return false;
+		}
+
+		return l_options.Threads > 0 && l_options.Iterations > 0 && l_options.Burst > 0 && l_options.BlockSize > 0;
+	}
+
+	/**
+	 * @brief Runs the workload on l_threads threads.
+	 * @return Operations (a GetMemory() or a Release()) per second.
+	 */
+	double Run(const Options& l_options, UInt32 l_threads, std::size_t l_magazineSize)
+	{
+		MemoryPool pool(l_options.BlockSize, 0, 0, l_magazineSize);
+
+		std::atomic<UInt32> ready{0};
+		std::atomic_bool start{false};
+		std::vector<std::thread> threads;
+
+		for (UInt32 i = 0; i < l_threads; ++i)
+		{
+			threads.emplace_back([&]()
+								 {
+									 std::vector<void*> blocks(l_options.Burst);
+
+									 ++ready;
+									 while (!start)
+									 {
+										 std::this_thread::yield();
+									 }
+
+									 for (UInt32 n = 0; n < l_options.Iterations; ++n)
+									 {
+										 for (auto& block : blocks)
+											 block = pool.GetMemory();
+
+										 // Touch the memory, as a real user would.
+										 static_cast<char*>(blocks.front())[0] = static_cast<char>(n);
+
+										 for (auto block : blocks)
+											 pool.Release(block);
+									 }
+								 });
+		}
+
+		while (ready < l_threads)
+		{
+			std::this_thread::yield();
+		}
+
+		auto begin = std::chrono::steady_clock::now();
+		start = true;
+
+		for (auto& thread : threads)
+			thread.join();
+
+		auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		return 2.0 * l_options.Burst * l_options.Iterations * l_threads / seconds;
+	}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	try
+	{
+		if (!Parse(argc, argv, options))
+		{
+			Usage();
+			return EXIT_FAILURE;
+		}
+	}
+	catch (const std::exception&)
+	{
+		Usage();
+		return EXIT_FAILURE;
+	}
+
+	std::printf("%8s %18s %18s %8s\n", "threads", "mutex (Mops/s)", "magazines (Mops/s)", "speedup");
+
+	for (UInt32 threads = 1; threads <= options.Threads; threads *= 2)
+	{
+		auto locked = Run(options, threads, 0);
+		auto cached = Run(options, threads, MemoryPool::DEFAULT_MAGAZINE_SIZE);
+
+		std::printf("%8u %18.2f %18.2f %7.1fx\n", threads, locked / 1e6, cached / 1e6, cached / locked);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,282 @@
+/*
+* export-giggle
+* spsc_bench.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+/*
+ * A throughput benchmark for handing items from one thread to another.
+ *
+ * A producer thread passes --items 64 bit integers to a consumer thread
+ * through a ThreadSafeQueue, an MpmcQueue, an SpscRing one item at a time and
+ * in batches of --batch, and finally passes the same number of --message
+ * byte records through an SpscByteRing, mirrored and not. Both sides spin
+ * (yielding) on a full or empty ring, as a busy reactor or writer would.
+ */
+
+#include <threading/MpmcQueue.hpp>
+#include <threading/SpscRing.hpp>
+#include <threading/ThreadSafeQueue.hpp>
+
+#include <Types.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace giggle::common;
+using namespace giggle::common::threading;
+
+namespace
+{
+
+	struct Options
+	{
+		UInt64 Items = 10000000;
+		std::size_t Capacity = 4096;
+		std::size_t Batch = 32;
+		std::size_t Message = 100;
+	};
+
+	void Usage()
+	{
+		std::cerr <<
+			"usage: spsc_bench [options]\n"
+			"  --items=N         items passed per run (10000000)\n"
+			"  --capacity=N      ring capacity in items, or in KiB for byte rings (4096)\n"
+			"  --batch=N         items per batch push/pop (32)\n"
+			"  --message=BYTES   record size for the byte rings (100)\n";
+	}
+
+	bool Parse(int argc, char** argv, Options& l_options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string argument = argv[i];
+			auto separator = argument.find('=');
+			auto key = argument.substr(0, separator);
+			auto value = separator == std::string::npos ? std::string() : argument.substr(separator + 1);
+
+			if (key == "--items") l_options.Items = std::stoull(value);
+			else if (key == "--capacity") l_options.Capacity = std::stoul(value);
+			else if (key == "--batch") l_options.Batch = std::stoul(value);
+			else if (key == "--message") l_options.Message = std::stoul(value);
+			else return false;
+		}
+
+		return l_options.Items > 0 && l_options.Capacity > 0 && l_options.Batch > 0 && l_options.Message > 0;
+	}
+
+	/**
+	 * @brief Runs l_producer and l_consumer on two threads.
+	 * @return Items per second; 0 if the consumer saw the wrong data.
+	 */
+	template <class P, class C>
+	double Run(UInt64 l_items, P&& l_producer, C&& l_consumer)
+	{
+		bool valid = false;
+		auto begin = std::chrono::steady_clock::now();
+
+		std::thread consumer([&]() { valid = l_consumer(); });
+		l_producer();
+		consumer.join();
+
+		auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		return valid ? l_items / seconds : 0;
+	}
+
+	template <class Q>
+	double QueueRun(const Options& l_options)
+	{
+		Q queue;
+
+		return Run(l_options.Items,
+				   [&]()
+				   {
+					   for (UInt64 i = 0; i < l_options.Items; ++i)
+						   queue.Push(i);
+				   },
+				   [&]()
+				   {
+					   UInt64 value;
+					   for (UInt64 i = 0; i < l_options.Items; ++i)
+					   {
+						   if (!queue.WaitPop(value) || value != i)
+							   return false;
+					   }
+					   return true;
+				   });
+	}
+
+	double RingRun(const Options& l_options)
+	{
+		SpscRing<UInt64> ring(l_options.Capacity);
+
+		return Run(l_options.Items,
+				   [&]()
+				   {
+					   for (UInt64 i = 0; i < l_options.Items; ++i)
+					   {
+						   while (!ring.TryPush(i))
+							   std::this_thread::yield();
+					   }
+				   },
+				   [&]()
+				   {
+					   UInt64 value;
+					   for (UInt64 i = 0; i < l_options.Items; ++i)
+					   {
+						   while (!ring.TryPop(value))
+							   std::this_thread::yield();
+						   if (value != i)
+							   return false;
+					   }
+					   return true;
+				   });
+	}
+
+	double BatchRun(const Options& l_options)
+	{
+		SpscRing<UInt64> ring(l_options.Capacity);
+
+		return Run(l_options.Items,
+				   [&]()
+				   {
+					   std::vector<UInt64> batch(l_options.Batch);
+					   for (UInt64 next = 0; next < l_options.Items;)
+					   {
+						   auto count = std::min<UInt64>(batch.size(), l_options.Items - next);
+						   for (UInt64 i = 0; i < count; ++i)
+							   batch[i] = next + i;
+
+						   std::size_t pushed = 0;
+						   while (pushed < count)
+						   {
+							   auto n = ring.TryPush(batch.data() + pushed, count - pushed);
+							   if (n == 0)
+								   std::this_thread::yield();
+							   pushed += n;
+						   }
+						   next += count;
+					   }
+				   },
+				   [&]()
+				   {
+					   std::vector<UInt64> batch(l_options.Batch);
+					   for (UInt64 next = 0; next < l_options.Items;)
+					   {
+						   auto count = ring.TryPop(batch.data(), batch.size());
+						   if (count == 0)
+							   std::this_thread::yield();
+
+						   for (std::size_t i = 0; i < count; ++i, ++next)
+						   {
+							   if (batch[i] != next)
+								   return false;
+						   }
+					   }
+					   return true;
+				   });
+	}
+
+	double ByteRun(const Options& l_options, bool l_mirrored)
+	{
+		SpscByteRing ring(l_options.Capacity * 1024, l_mirrored);
+		auto total = l_options.Items * l_options.Message;
+
+		return Run(l_options.Items,
+				   [&]()
+				   {
+					   std::vector<char> record(l_options.Message, 'r');
+					   for (UInt64 i = 0; i < l_options.Items; ++i)
+					   {
+						   std::size_t written = 0;
+						   while (written < record.size())
+						   {
+							   auto n = ring.Write(record.data() + written, record.size() - written);
+							   if (n == 0)
+								   std::this_thread::yield();
+							   written += n;
+						   }
+					   }
+				   },
+				   [&]()
+				   {
+					   // Reads in place, as a parser would; only full records are taken.
+					   UInt64 read = 0;
+					   UInt64 checksum = 0;
+					   while (read < total)
+					   {
+						   std::size_t available;
+						   auto data = ring.ReadSpace(available);
+						   auto records = available / l_options.Message;
+						   if (records == 0)
+						   {
+							   // Without mirroring a record may straddle the end of the buffer.
+							   if (available > 0 && !ring.Mirrored())
+							   {
+								   checksum += static_cast<unsigned char>(data[0]) * available;
+								   ring.Consume(available);
+								   read += available;
+							   }
+							   else
+								   std::this_thread::yield();
+							   continue;
+						   }
+
+						   auto bytes = records * l_options.Message;
+						   for (std::size_t i = 0; i < bytes; i += l_options.Message)
+							   checksum += static_cast<unsigned char>(data[i]) * l_options.Message;
+						   ring.Consume(bytes);
+						   read += bytes;
+					   }
+					   return checksum == total * 'r';
+				   });
+	}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	try
+	{
+		if (!Parse(argc, argv, options))
+		{
+			Usage();
+			return EXIT_FAILURE;
+		}
+	}
+	catch (const std::exception&)
+	{
+		Usage();
+		return EXIT_FAILURE;
+	}
+
+	std::printf("%-26s %12s\n", "", "Mitems/s");
+	std::printf("%-26s %12.2f\n", "ThreadSafeQueue", QueueRun<ThreadSafeQueue<UInt64>>(options) / 1e6);
+	std::printf("%-26s %12.2f\n", "MpmcQueue", QueueRun<MpmcQueue<UInt64>>(options) / 1e6);
+	std::printf("%-26s %12.2f\n", "SpscRing", RingRun(options) / 1e6);
+	std::printf("%-26s %12.2f\n", "SpscRing (batch)", BatchRun(options) / 1e6);
+	std::printf("%-26s %12.2f\n", "SpscByteRing", ByteRun(options, false) / 1e6);
+	std::printf("%-26s %12.2f\n", "SpscByteRing (mirrored)", ByteRun(options, true) / 1e6);
+
+	return EXIT_SUCCESS;
+}
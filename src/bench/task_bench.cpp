@@ -0,0 +1,189 @@
+/*
+* export-giggle
+* task_bench.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+/*
+ * A submission overhead benchmark for ThreadPool.
+ *
+ * Measures the cost of a submit-and-run round trip of an empty task:
+ * posted from a thread outside the pool, one by one and in batches,
+ * posted by a task to its own worker, posted as a chain where every
+ * task posts the next one, and through enqueue() with its future. Each row reports the
+ * nanoseconds per task, from the first submission until the last task
+ * ran.
+ */
+
+#include <threading/ThreadPool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace giggle::common;
+using namespace giggle::common::threading;
+
+namespace
+{
+
+	struct Options
+	{
+		UInt32 Threads = 1;
+		UInt32 Tasks = 1000000;
+	};
+
+	void Usage()
+	{
+		std::cerr <<
+			"usage: task_bench [options]\n"
+			"  --threads=N   workers in the pool (1)\n"
+			"  --tasks=N     tasks per measurement (1000000)\n";
+	}
+
+	bool Parse(int argc, char** argv, Options& l_options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string argument = argv[i];
+			auto separator = argument.find('=');
+			auto key = argument.substr(0, separator);
+			auto value = separator == std::string::npos ? std::string() : argument.substr(separator + 1);
+
+			if (key == "--threads") l_options.Threads = std::stoul(value);
+			else if (key == "--tasks") l_options.Tasks = std::stoul(value);
+			else return false;
+		}
+
+		return l_options.Threads > 0 && l_options.Tasks > 0;
+	}
+
+	void WaitFor(const std::atomic<UInt32>& l_counter, UInt32 l_value)
+	{
+		while (l_counter.load(std::memory_order_acquire) < l_value)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	/**
+	 * @brief A task that posts the next one until l_tasks ran.
+	 */
+	struct Link
+	{
+		ThreadPool* Pool;
+		std::atomic<UInt32>* Counter;
+		UInt32 Tasks;
+
+		void operator()() const
+		{
+			if (Counter->fetch_add(1, std::memory_order_release) + 1 < Tasks)
+				Pool->Post(*this);
+		}
+	};
+
+	/**
+	 * @brief Times l_submit, which must make l_counter reach l_tasks.
+	 * @return Nanoseconds per task.
+	 */
+	template <class Submit>
+	double Measure(UInt32 l_tasks, std::atomic<UInt32>& l_counter, Submit l_submit)
+	{
+		l_counter = 0;
+
+		auto begin = std::chrono::steady_clock::now();
+		l_submit();
+		WaitFor(l_counter, l_tasks);
+
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / l_tasks;
+	}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	try
+	{
+		if (!Parse(argc, argv, options))
+		{
+			Usage();
+			return EXIT_FAILURE;
+		}
+	}
+	catch (const std::exception&)
+	{
+		Usage();
+		return EXIT_FAILURE;
+	}
+
+	ThreadPool pool(options.Threads);
+	std::atomic<UInt32> counter{0};
+	auto tasks = options.Tasks;
+
+	auto external = Measure(tasks, counter, [&]()
+	{
+		for (UInt32 i = 0; i < tasks; ++i)
+			pool.Post([&counter]() { counter.fetch_add(1, std::memory_order_release); });
+	});
+
+	auto batched = Measure(tasks, counter, [&]()
+	{
+		auto increment = [&counter]() { counter.fetch_add(1, std::memory_order_release); };
+		std::vector<decltype(increment)> batch(256, increment);
+
+		for (UInt32 i = 0; i < tasks; i += batch.size())
+		{
+			auto count = std::min<std::size_t>(batch.size(), tasks - i);
+			pool.EnqueueBatch(batch.begin(), batch.begin() + count);
+		}
+	});
+
+	auto local = Measure(tasks, counter, [&]()
+	{
+		pool.Post([&]()
+		{
+			for (UInt32 i = 0; i < tasks; ++i)
+				pool.Post([&counter]() { counter.fetch_add(1, std::memory_order_release); });
+		});
+	});
+
+	auto chained = Measure(tasks, counter, [&]()
+	{
+		pool.Post(Link{&pool, &counter, tasks});
+	});
+
+	auto futures = Measure(tasks, counter, [&]()
+	{
+		for (UInt32 i = 0; i < tasks; ++i)
+			pool.enqueue([&counter]() { counter.fetch_add(1, std::memory_order_release); }).get();
+	});
+
+	std::printf("%-28s %10s\n", "submission", "ns/task");
+	std::printf("%-28s %10.1f\n", "Post() from outside", external);
+	std::printf("%-28s %10.1f\n", "EnqueueBatch() from outside", batched);
+	std::printf("%-28s %10.1f\n", "Post() from a worker", local);
+	std::printf("%-28s %10.1f\n", "Post() chained", chained);
+	std::printf("%-28s %10.1f\n", "enqueue().get()", futures);
+
+	return EXIT_SUCCESS;
+}
@@ -151,6 +151,20 @@ bool UUID::TryParse(const std::string &uuid)
 std::string UUID::ToString() const
 {
 	std::string result;
+	Format(result);
+	return result;
+}
+
+std::pmr::string UUID::ToString(std::pmr::memory_resource* l_resource) const
+{
+	std::pmr::string result(l_resource);
+	Format(result);
+	return result;
+}
+
+template <class S>
+void UUID::Format(S& result) const
+{
 	result.reserve(36);
 	AppendHex(result, _timeLow);
 	result += '-';
@@ -162,7 +176,6 @@ std::string UUID::ToString() const
 	result += '-';
 	for (int i = 0; i < sizeof(_node); ++i)
 		AppendHex(result, _node[i]);
-	return result;
 }
 
 void UUID::CopyFrom(const char *buffer)
@@ -301,20 +314,23 @@ int UUID::Compare(const UUID &uuid) const
 	return 0;
 }
 
-void UUID::AppendHex(std::string &str, UInt8 n)
+template <class S>
+void UUID::AppendHex(S &str, UInt8 n)
 {
 	static const char* digits = "0123456789abcdef";
 	str += digits[(n >> 4) & 0xF];
 	str += digits[n & 0xF];
 }
 
-void UUID::AppendHex(std::string &str, UInt16 n)
+template <class S>
+void UUID::AppendHex(S &str, UInt16 n)
 {
 	AppendHex(str, UInt8(n >> 8));
 	AppendHex(str, UInt8(n & 0xFF));
 }
 
-void UUID::AppendHex(std::string &str, UInt32 n)
+template <class S>
+void UUID::AppendHex(S &str, UInt32 n)
 {
 	AppendHex(str, UInt16(n >> 16));
 	AppendHex(str, UInt16(n & 0xFFFF));
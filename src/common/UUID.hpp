@@ -19,6 +19,7 @@
 #ifndef EXPORT_GIGGLE_UUID_HPP
 #define EXPORT_GIGGLE_UUID_HPP
 
+#include <memory_resource>
 #include <string>
 #include "Types.hpp"
 
@@ -106,6 +107,12 @@ namespace giggle::common
 		 */
 		std::string ToString() const;
 
+		/**
+		 * @brief Returns the string representation, see ToString(),
+		 * allocated from the given memory resource.
+		 */
+		std::pmr::string ToString(std::pmr::memory_resource* l_resource) const;
+
 		/**
 		 * @brief Copies the UUID (16 bytes) from a buffer or byte array.
 		 * The UUID fields are expected to be
@@ -180,9 +187,15 @@ namespace giggle::common
 		UUID(UInt32 timeLow, UInt32 timeMid, UInt32 timeHiAndVersion, UInt16 clockSeq, UInt8 node[]);
 		UUID(const char* bytes, Version version);
 		int Compare(const UUID& uuid) const;
-		static void AppendHex(std::string& str, UInt8 n);
-		static void AppendHex(std::string& str, UInt16 n);
-		static void AppendHex(std::string& str, UInt32 n);
+		template <class S>
+		void Format(S& str) const;
+
+		template <class S>
+		static void AppendHex(S& str, UInt8 n);
+		template <class S>
+		static void AppendHex(S& str, UInt16 n);
+		template <class S>
+		static void AppendHex(S& str, UInt32 n);
 		static Int16 Nibble(char hex);
 		void FromNetwork();
 		void ToNetwork();
@@ -86,3 +86,13 @@ std::string giggle::common::formatting::toJSON(const std::string& l_value, int l
 
 	return ret;
 }
+
+std::pmr::string giggle::common::formatting::toJSON(const std::string& l_value, int l_options,
+													std::pmr::memory_resource* l_resource)
+{
+	std::pmr::string ret(l_resource);
+
+	writeString<std::pmr::string, std::pmr::string::size_type>(l_value, ret, &std::pmr::string::append, l_options);
+
+	return ret;
+}
@@ -19,6 +19,7 @@
 #ifndef EXPORT_GIGGLE_JSONSTRING_HPP
 #define EXPORT_GIGGLE_JSONSTRING_HPP
 
+#include <memory_resource>
 #include <ostream>
 #include <string>
 
@@ -76,6 +77,17 @@ namespace giggle::common::formatting
 	 */
 	std::string toJSON(const std::string& l_value, int l_options);
 
+	/**
+	 * Formats string value by escaping control characters, like toJSON(l_value, l_options),
+	 * allocating the result from the given memory resource, e.g. a per-request Arena.
+	 *
+	 * @param l_value
+	 * @param l_options
+	 * @param l_resource
+	 * @return formatted string
+	 */
+	std::pmr::string toJSON(const std::string& l_value, int l_options, std::pmr::memory_resource* l_resource);
+
 } // namespace formatting
 
 
@@ -0,0 +1,167 @@
+/*
+* export-giggle
+* Arena.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "Arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+using namespace giggle::common;
+using namespace giggle::common::memory;
+
+namespace
+{
+	/// Makes room for one more element ahead of time, so the push_back after
+	/// an allocation cannot throw and leak it. Grows geometrically.
+	template <class Vector>
+	void ReserveOneMore(Vector& l_vector)
+	{
+		if (l_vector.size() == l_vector.capacity())
+			l_vector.reserve(std::max<std::size_t>(8, 2 * l_vector.size()));
+	}
+}
+
+Arena::Arena(MemoryPool& l_pool):
+	_pool(l_pool),
+	_chunks(),
+	_next(0),
+	_cursor(nullptr),
+	_end(nullptr),
+	_used(0),
+	_large()
+{
+
+}
+
+Arena::~Arena()
+{
+	Release();
+}
+
+void* Arena::Allocate(std::size_t l_size, std::size_t l_alignment)
+{
+	auto aligned = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(_cursor) + l_alignment - 1) &
+										   ~(static_cast<std::uintptr_t>(l_alignment) - 1));
+
+	if (_cursor == nullptr || aligned > _end || static_cast<std::size_t>(_end - aligned) < l_size)
+	{
+		// Chunks start out aligned like operator new; anything stricter may need the padding.
+		auto worstCase = l_size + (l_alignment > alignof(std::max_align_t) ? l_alignment : 0);
+		if (worstCase > _pool.BlockSize())
+			return AllocateLarge(l_size, l_alignment);
+
+		NextChunk();
+		aligned = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(_cursor) + l_alignment - 1) &
+										  ~(static_cast<std::uintptr_t>(l_alignment) - 1));
+	}
+
+	_cursor = aligned + l_size;
+	_used += l_size;
+	return aligned;
+}
+
+void Arena::Reset()
+{
+	FreeLarge();
+
+	_next = 0;
+	_cursor = nullptr;
+	_end = nullptr;
+	_used = 0;
+}
+
+void Arena::Release()
+{
+	Reset();
+
+	for (auto chunk : _chunks)
+	{
+		_pool.Release(chunk);
+	}
+	_chunks.clear();
+}
+
+std::size_t Arena::Used() const
+{
+	return _used;
+}
+
+std::size_t Arena::Capacity() const
+{
+	return _chunks.size() * _pool.BlockSize();
+}
+
+void* Arena::AllocateLarge(std::size_t l_size, std::size_t l_alignment)
+{
+	ReserveOneMore(_large);
+
+	auto ptr = ::operator new(l_size, std::align_val_t(l_alignment));
+	_large.emplace_back(ptr, l_alignment);
+
+	_used += l_size;
+	return ptr;
+}
+
+void Arena::NextChunk()
+{
+	if (_next == _chunks.size())
+	{
+		ReserveOneMore(_chunks);
+		_chunks.push_back(static_cast<char*>(_pool.GetMemory()));
+	}
+
+	_cursor = _chunks[_next++];
+	_end = _cursor + _pool.BlockSize();
+}
+
+void Arena::FreeLarge()
+{
+	for (auto& large : _large)
+	{
+		::operator delete(large.first, std::align_val_t(large.second));
+	}
+	_large.clear();
+}
+
+ArenaResource::ArenaResource(Arena& l_arena):
+	_arena(l_arena)
+{
+
+}
+
+Arena& ArenaResource::GetArena() const
+{
+	return _arena;
+}
+
+void* ArenaResource::do_allocate(std::size_t l_bytes, std::size_t l_alignment)
+{
+	return _arena.Allocate(l_bytes, l_alignment);
+}
+
+void ArenaResource::do_deallocate(void*, std::size_t, std::size_t)
+{
+
+}
+
+bool ArenaResource::do_is_equal(const std::pmr::memory_resource& l_other) const noexcept
+{
+	auto other = dynamic_cast<const ArenaResource*>(&l_other);
+	return other != nullptr && &other->_arena == &_arena;
+}
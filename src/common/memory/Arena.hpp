@@ -0,0 +1,135 @@
+/*
+* export-giggle
+* Arena.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_ARENA_HPP
+#define EXPORT_GIGGLE_ARENA_HPP
+
+#include "MemoryPool.hpp"
+
+#include <cstddef>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace giggle::common::memory
+{
+
+	/**
+	 * @brief A bump-pointer allocator for memory that dies all at once,
+	 * such as the scratch objects of a single request.
+	 *
+	 * Memory is carved out of chunks taken from a MemoryPool by moving
+	 * a cursor; nothing is freed individually. Reset() rewinds the cursor
+	 * to the first chunk in constant time and keeps the chunks, so a
+	 * request that fits in the memory of the previous ones allocates
+	 * without touching the pool at all. Requests larger than a chunk
+	 * are served by operator new and freed on Reset().
+	 *
+	 * Destructors of objects placed in the arena are not run; use it for
+	 * trivially destructible data or through ArenaResource, whose users
+	 * (std::pmr containers) destroy their elements themselves.
+	 *
+	 * Not thread safe; an arena belongs to whoever handles the request.
+	 */
+	class Arena
+	{
+	public:
+
+		/**
+		 * @brief Creates the arena; no memory is taken until the first allocation.
+		 * @param l_pool The pool chunks are taken from, which must outlive the arena.
+		 */
+		explicit Arena(MemoryPool& l_pool);
+
+		/**
+		 * @brief Returns every chunk to the pool.
+		 */
+		~Arena();
+
+		Arena(const Arena&) = delete;
+		Arena& operator = (const Arena&) = delete;
+
+		/**
+		 * @brief Returns l_size bytes aligned to l_alignment, a power of two.
+		 * @throws OutOfMemoryException if the pool is exhausted.
+		 */
+		void* Allocate(std::size_t l_size, std::size_t l_alignment = alignof(std::max_align_t));
+
+		/**
+		 * @brief Makes all memory available again, keeping the chunks.
+		 * Everything allocated so far must no longer be used.
+		 */
+		void Reset();
+
+		/**
+		 * @brief Like Reset(), but also returns every chunk to the pool.
+		 */
+		void Release();
+
+		/**
+		 * @brief Returns the bytes handed out since the last reset.
+		 */
+		std::size_t Used() const;
+
+		/**
+		 * @brief Returns the bytes held in chunks, used or not.
+		 */
+		std::size_t Capacity() const;
+
+	private:
+
+		void* AllocateLarge(std::size_t l_size, std::size_t l_alignment);
+		void NextChunk();
+		void FreeLarge();
+
+		MemoryPool&									_pool;
+		std::vector<char*>							_chunks;
+		std::size_t									_next;
+		char*										_cursor;
+		char*										_end;
+		std::size_t									_used;
+		std::vector<std::pair<void*, std::size_t>>	_large;
+	};
+
+	/**
+	 * @brief Lets standard containers allocate from an Arena, e.g.
+	 * std::pmr::vector<std::pmr::string> l_items{&resource}.
+	 * Deallocation does nothing; the memory comes back on Arena::Reset().
+	 */
+	class ArenaResource : public std::pmr::memory_resource
+	{
+	public:
+
+		explicit ArenaResource(Arena& l_arena);
+
+		Arena& GetArena() const;
+
+	protected:
+
+		void* do_allocate(std::size_t l_bytes, std::size_t l_alignment) override;
+		void do_deallocate(void* l_ptr, std::size_t l_bytes, std::size_t l_alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& l_other) const noexcept override;
+
+	private:
+
+		Arena& _arena;
+	};
+
+} // namespace memory
+
+#endif //EXPORT_GIGGLE_ARENA_HPP
@@ -0,0 +1,180 @@
+/*
+* export-giggle
+* BlockSource.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "BlockSource.hpp"
+#include <exceptions/OutOfMemoryException.hpp>
+#include <exceptions/SystemException.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace giggle::common;
+using namespace giggle::common::memory;
+
+namespace
+{
+	std::size_t RoundUp(std::size_t l_size, std::size_t l_multiple)
+	{
+		return (l_size + l_multiple - 1) / l_multiple * l_multiple;
+	}
+}
+
+HeapBlockSource& HeapBlockSource::Instance()
+{
+	static HeapBlockSource instance;
+	return instance;
+}
+
+char* HeapBlockSource::Allocate(std::size_t l_size)
+{
+	return new char[l_size];
+}
+
+void HeapBlockSource::Free(char* l_block, std::size_t)
+{
+	delete [] l_block;
+}
+
+MappedBlockSource::MappedBlockSource(std::size_t l_block_size, std::size_t l_blocks, HugePages l_hugePages,
+									 bool l_populate):
+	_block_size(l_block_size),
+	_blocks(l_blocks),
+	_pages(l_hugePages),
+	_region(nullptr),
+	_mappedSize(0),
+	_next(0)
+{
+	auto size = std::max<std::size_t>(_block_size * _blocks, 1);
+	void* region = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+	if (_pages == HugePages::EXPLICIT)
+	{
+		_mappedSize = RoundUp(size, HUGE_PAGE_SIZE);
+		region = mmap(nullptr, _mappedSize, PROT_READ | PROT_WRITE,
+					  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (l_populate ? MAP_POPULATE : 0), -1, 0);
+	}
+#endif
+
+	if (region == MAP_FAILED && _pages != HugePages::NONE)
+	{
+		// Over-reserve by a huge page so the region can start on a huge page boundary.
+		_pages = HugePages::TRANSPARENT;
+		_mappedSize = RoundUp(size, HUGE_PAGE_SIZE);
+
+		auto reserved = mmap(nullptr, _mappedSize + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+							 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (reserved != MAP_FAILED)
+		{
+			auto start = reinterpret_cast<std::uintptr_t>(reserved);
+			auto aligned = RoundUp(start, HUGE_PAGE_SIZE);
+			auto tail = HUGE_PAGE_SIZE - (aligned - start);
+
+			if (aligned > start)
+				munmap(reserved, aligned - start);
+			if (tail > 0)
+				munmap(reinterpret_cast<char*>(aligned) + _mappedSize, tail);
+
+			region = reinterpret_cast<void*>(aligned);
+
+#ifdef MADV_HUGEPAGE
+			if (madvise(region, _mappedSize, MADV_HUGEPAGE) != 0)
+				_pages = HugePages::NONE;
+#else
+			_pages = HugePages::NONE;
+#endif
+
+			// MAP_POPULATE would fault in small pages before the advice applies.
+			if (l_populate)
+			{
+				auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+				for (std::size_t offset = 0; offset < _mappedSize; offset += page)
+				{
+					static_cast<volatile char*>(region)[offset] = 0;
+				}
+			}
+		}
+	}
+	else if (region == MAP_FAILED)
+	{
+		_mappedSize = RoundUp(size, static_cast<std::size_t>(sysconf(_SC_PAGESIZE)));
+		region = mmap(nullptr, _mappedSize, PROT_READ | PROT_WRITE,
+					  MAP_PRIVATE | MAP_ANONYMOUS | (l_populate ? MAP_POPULATE : 0), -1, 0);
+	}
+
+	if (region == MAP_FAILED)
+	{
+		throw exception::SystemException("Error mapping block region.", std::strerror(errno), errno);
+	}
+
+	_region = static_cast<char*>(region);
+	_free.reserve(_blocks);
+}
+
+MappedBlockSource::~MappedBlockSource()
+{
+	munmap(_region, _mappedSize);
+}
+
+char* MappedBlockSource::Allocate(std::size_t l_size)
+{
+	if (l_size != _block_size)
+		throw exception::OutOfMemoryException("Block size does not match the mapped region.");
+
+	std::lock_guard<std::mutex> lock{_mutex};
+
+	if (!_free.empty())
+	{
+		auto block = _free.back();
+		_free.pop_back();
+		return block;
+	}
+
+	if (_next == _blocks)
+		throw exception::OutOfMemoryException("Mapped region exhausted.");
+
+	return _region + _block_size * _next++;
+}
+
+void MappedBlockSource::Free(char* l_block, std::size_t)
+{
+	std::lock_guard<std::mutex> lock{_mutex};
+
+	// Reserved for every block in the constructor, so this never allocates.
+	_free.push_back(l_block);
+}
+
+MappedBlockSource::HugePages MappedBlockSource::Pages() const
+{
+	return _pages;
+}
+
+std::size_t MappedBlockSource::MappedSize() const
+{
+	return _mappedSize;
+}
+
+std::size_t MappedBlockSource::Blocks() const
+{
+	return _blocks;
+}
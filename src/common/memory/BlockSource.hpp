@@ -0,0 +1,163 @@
+/*
+* export-giggle
+* BlockSource.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_BLOCKSOURCE_HPP
+#define EXPORT_GIGGLE_BLOCKSOURCE_HPP
+
+#include <Types.hpp>
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace giggle::common::memory
+{
+
+	/**
+	 * @brief Where a MemoryPool gets the memory of its blocks from.
+	 *
+	 * A pool only asks its source for a block when its free list is
+	 * empty and only gives blocks back when it is cleared or destroyed,
+	 * so sources need not be fast; they decide how the memory is laid out.
+	 *
+	 * Sources are shared by reference and must outlive every pool using them.
+	 */
+	class BlockSource
+	{
+	public:
+
+		virtual ~BlockSource() = default;
+
+		/**
+		 * @brief Returns a new block of l_size bytes.
+		 * @throws OutOfMemoryException
+		 */
+		virtual char* Allocate(std::size_t l_size) = 0;
+
+		/**
+		 * @brief Gives back a block obtained from Allocate() with the same l_size.
+		 */
+		virtual void Free(char* l_block, std::size_t l_size) = 0;
+	};
+
+	/**
+	 * @brief Allocates every block on its own with operator new[].
+	 *
+	 * The default source of a MemoryPool.
+	 */
+	class HeapBlockSource : public BlockSource
+	{
+	public:
+
+		/**
+		 * @brief Returns the shared instance; the source is stateless.
+		 */
+		static HeapBlockSource& Instance();
+
+		char* Allocate(std::size_t l_size) override;
+		void Free(char* l_block, std::size_t l_size) override;
+	};
+
+	/**
+	 * @brief Carves blocks out of one contiguous anonymous mapping.
+	 *
+	 * Blocks allocated on the heap one at a time end up scattered over
+	 * many pages, each faulted in by whichever request touches it first.
+	 * This source reserves room for a fixed number of blocks with a single
+	 * mmap(), so the pool's memory is contiguous and can be backed by
+	 * huge pages, cutting TLB misses; with Populate the whole region is
+	 * faulted in by the constructor, so startup pays for the page faults
+	 * instead of the first requests.
+	 *
+	 * Blocks handed back are kept for reuse; the region is only unmapped
+	 * when the source is destroyed. Thread safe.
+	 */
+	class MappedBlockSource : public BlockSource
+	{
+	public:
+
+		enum class HugePages : UInt8
+		{
+			/// Regular pages.
+			NONE,
+			/// Transparent huge pages, requested with madvise(MADV_HUGEPAGE).
+			TRANSPARENT,
+			/// Pages from the hugetlbfs pool (MAP_HUGETLB), falling back to TRANSPARENT
+			/// when the pool has too few free pages.
+			EXPLICIT
+		};
+
+		enum
+		{
+			HUGE_PAGE_SIZE = 2 * 1024 * 1024
+		};
+
+		/**
+		 * @brief Maps room for l_blocks blocks of l_block_size bytes.
+		 * @throws SystemException if the mapping fails.
+		 * @param l_block_size The size of a block; Allocate() only serves this size.
+		 * @param l_blocks The number of blocks; a pool using the source should have at most as many.
+		 * @param l_hugePages Which pages back the region.
+		 * @param l_populate Whether to fault in the whole region right away (MAP_POPULATE).
+		 */
+		MappedBlockSource(std::size_t l_block_size, std::size_t l_blocks,
+						  HugePages l_hugePages = HugePages::NONE, bool l_populate = false);
+
+		~MappedBlockSource() override;
+
+		MappedBlockSource(const MappedBlockSource&) = delete;
+		MappedBlockSource& operator = (const MappedBlockSource&) = delete;
+
+		/**
+		 * @brief Returns the next free block of the region.
+		 * @throws OutOfMemoryException if every block is in use or l_size is not the block size.
+		 */
+		char* Allocate(std::size_t l_size) override;
+		void Free(char* l_block, std::size_t l_size) override;
+
+		/**
+		 * @brief Returns which pages actually back the region, after any fallback.
+		 */
+		HugePages Pages() const;
+
+		/**
+		 * @brief Returns the size of the mapping in bytes.
+		 */
+		std::size_t MappedSize() const;
+
+		/**
+		 * @brief Returns the number of blocks the region holds.
+		 */
+		std::size_t Blocks() const;
+
+	private:
+
+		std::size_t			_block_size;
+		std::size_t			_blocks;
+		HugePages			_pages;
+		char*				_region;
+		std::size_t			_mappedSize;
+
+		std::mutex			_mutex;
+		std::size_t			_next;
+		std::vector<char*>	_free;
+	};
+
+} // namespace memory
+
+#endif //EXPORT_GIGGLE_BLOCKSOURCE_HPP
@@ -21,6 +21,7 @@
 
 #include <cstddef>
 #include <cstring>
+#include <utility>
 #include <exceptions/InvalidAccessException.hpp>
 #include <exceptions/IndexOutOfBoundsException.hpp>
 
@@ -33,25 +34,41 @@ namespace giggle::common::memory
 	 *
 	 * This class is useful everywhere where a temporary buffer
 	 * is needed.
+	 *
+	 * Buffers of up to INLINE_BYTES bytes live inside the object itself,
+	 * so short ones such as frame headers never touch the heap. Appending
+	 * grows the capacity geometrically, so building a buffer piece by
+	 * piece costs amortized constant time per element; writers that
+	 * produce data in place use Reserve() and Commit() instead.
+	 *
+	 * T must be trivially copyable; elements are moved with memcpy.
 	 */
 	template <class T>
 	class Buffer
 	{
 	public:
 
+		enum
+		{
+			/// Bytes of storage inside the object, used until a buffer outgrows them.
+			INLINE_BYTES = 16,
+			INLINE_CAPACITY = INLINE_BYTES / sizeof(T)
+		};
+
 		/**
 		 * @brief Creates and allocates the Buffer.
 		 * @param l_length The buffer size.
 		 */
 		explicit Buffer(std::size_t l_length):
-			_capacity(l_length),
+			_capacity(INLINE_CAPACITY),
 			_used(l_length),
-			_ptr(0),
+			_ptr(Inline()),
 			_ownMem(true)
 		{
-			if (l_length > 0)
+			if (l_length > INLINE_CAPACITY)
 			{
 				_ptr = new T[l_length];
+				_capacity = l_length;
 			}
 		}
 
@@ -79,15 +96,11 @@ namespace giggle::common::memory
 		 * number of elements of type T.
 		 */
 		Buffer(const T* l_pMem, std::size_t l_length):
-			_capacity(l_length),
-			_used(l_length),
-			_ptr(0),
-			_ownMem(true)
+			Buffer(l_length)
 		{
-			if (_capacity > 0)
+			if (_used > 0)
 			{
-				_ptr = new T[_capacity];
-				std::memcpy(_ptr, _used * sizeof(T));
+				std::memcpy(_ptr, l_pMem, _used * sizeof(T));
 			}
 		}
 
@@ -96,16 +109,9 @@ namespace giggle::common::memory
 		 * @param l_other
 		 */
 		Buffer(const Buffer& l_other):
-			_capacity(l_other._used),
-			_used(l_other._used),
-			_ptr(0),
-			_ownMem(true)
+			Buffer(static_cast<const T*>(l_other._ptr), l_other._used)
 		{
-			if (_used)
-			{
-				_ptr = new T[_used];
-				std::memcpy(_ptr, l_other._ptr, _used * sizeof(T));
-			}
+
 		}
 
 		/**
@@ -124,39 +130,29 @@ namespace giggle::common::memory
 		}
 
 		/**
-		 * @brief Copy constructor.
+		 * @brief Move constructor.
 		 * @param l_other
 		 */
 		Buffer(Buffer&& l_other) noexcept :
-			_capacity(l_other._capacity),
-			_used(l_other._used),
-			_ptr(l_other._ptr),
-			_ownMem(l_other._ownMem)
+			_capacity(INLINE_CAPACITY),
+			_used(0),
+			_ptr(Inline()),
+			_ownMem(true)
 		{
-			l_other._capacity = 0;
-			l_other._used = 0;
-			l_other._ownMem = false;
-			l_other._ptr = nullptr;
+			Take(l_other);
 		}
 
 		/**
-		 * @brief Assignment operator
-		 * @param other
+		 * @brief Move assignment operator.
+		 * @param l_other
 		 * @return
 		 */
-		Buffer& operator = (Buffer&& other) noexcept
+		Buffer& operator = (Buffer&& l_other) noexcept
 		{
-			if (this != &other)
+			if (this != &l_other)
 			{
-				_capacity = other._capacity;
-				_used = other._used;
-				_ptr = other._ptr;
-				_ownMem = other._ownMem;
-
-				other._capacity = 0;
-				other._used = 0;
-				other._ownMem = false;
-				other._ptr = nullptr;
+				Deallocate();
+				Take(l_other);
 			}
 
 			return *this;
@@ -167,7 +163,7 @@ namespace giggle::common::memory
 		 */
 		~Buffer()
 		{
-			if (_ownMem) delete [] _ptr;
+			Deallocate();
 		}
 
 		/**
@@ -192,14 +188,7 @@ namespace giggle::common::memory
 
 			if (l_newCapacity > _capacity)
 			{
-				T* ptr = new T[l_newCapacity];
-				if (l_preserveContent)
-				{
-					std::memcpy(ptr, _ptr, _used * sizeof(T));
-				}
-				delete [] _ptr;
-				_ptr = ptr;
-				_capacity = l_newCapacity;
+				Reallocate(l_newCapacity, l_preserveContent);
 			}
 
 			_used = l_newCapacity;
@@ -211,7 +200,8 @@ namespace giggle::common::memory
 		 * new buffer. The new capacity can be larger or smaller than
 		 * the current one; size will be set to the new capacity only if
 		 * new capacity is smaller than the current size, otherwise it will
-		 * remain intact.
+		 * remain intact. Capacities that fit inline are raised to
+		 * INLINE_CAPACITY.
 		 *
 		 * Buffers only wrapping externally owned storage can not be
 		 * resized. If resize is attempted on those, IllegalAccessException
@@ -226,25 +216,46 @@ namespace giggle::common::memory
 			if (!_ownMem)
 				throw exception::InvalidAccessException("Cannot resize buffer which does not own its storage.");
 
+			if (l_newCapacity < _used)
+				_used = l_newCapacity;
+
 			if (l_newCapacity != _capacity)
 			{
-				T* ptr = 0;
-				if (l_newCapacity > 0)
-				{
-					ptr = new T[l_newCapacity];
-					if (l_preserveContent)
-					{
-						std::size_t  newSize = _used < l_newCapacity ? _used : l_newCapacity;
-						std::memcpy(ptr, _ptr, newSize * sizeof(T));
-					}
-				}
-				delete [] _ptr;
-				_ptr = ptr;
-				_capacity = l_newCapacity;
+				Reallocate(l_newCapacity, l_preserveContent);
+			}
+		}
 
-				if (l_newCapacity < _used)
-					_used= l_newCapacity;
+		/**
+		 * Makes room for at least l_count more elements past End(), growing
+		 * the capacity geometrically if needed, without changing the size.
+		 * Write up to l_count elements there and publish them with Commit().
+		 *
+		 * @throws IllegalAccessException if the buffer has to grow but does not own its storage.
+		 * @param l_count
+		 * @return The write position, End().
+		 */
+		T* Reserve(std::size_t l_count)
+		{
+			if (_capacity - _used < l_count)
+			{
+				Grow(_used + l_count);
 			}
+
+			return _ptr + _used;
+		}
+
+		/**
+		 * Adds l_count elements written past End() to the buffer.
+		 *
+		 * @throws IndexOutOfBoundsException if that exceeds the capacity.
+		 * @param l_count
+		 */
+		void Commit(std::size_t l_count)
+		{
+			if (_capacity - _used < l_count)
+				throw exception::IndexOutOfBoundsException("Commit exceeds the reserved capacity.");
+
+			_used += l_count;
 		}
 
 		/**
@@ -262,7 +273,7 @@ namespace giggle::common::memory
 		}
 
 		/**
-		 * Resizes this buffer and appends the argument buffer.
+		 * Appends the argument buffer, growing the capacity geometrically.
 		 *
 		 * @param l_buffer
 		 * @param l_size
@@ -270,23 +281,23 @@ namespace giggle::common::memory
 		void Append(const T* l_buffer, std::size_t l_size)
 		{
 			if (l_size == 0) return;
-			Resize(_used + l_size, true);
-			std::memcpy(_ptr + _used - l_size, l_buffer, l_size * sizeof(T));
+			std::memcpy(Reserve(l_size), l_buffer, l_size * sizeof(T));
+			_used += l_size;
 		}
 
 		/**
-		 * Resizes this buffer by one element and appends the argument value.
+		 * Appends the argument value, growing the capacity geometrically.
 		 *
 		 * @param l_value
 		 */
 		void Append(T l_value)
 		{
-			Resize(_used + 1, true);
-			_ptr[_used - 1] = l_value;
+			*Reserve(1) = l_value;
+			++_used;
 		}
 
 		/**
-		 * Resizes this buffer and appends the argument buffer.
+		 * Appends the argument buffer.
 		 *
 		 * @param l_buffer
 		 */
@@ -322,14 +333,13 @@ namespace giggle::common::memory
 		 */
 		void Swap(Buffer& l_other)
 		{
-			using std::swap;
-
-			swap(_ptr, l_other._ptr);
-			swap(_capacity, l_other._capacity);
-			swap(_used, l_other._used);
-			swap(_ownMem, l_other._ownMem);
+			if (this != &l_other)
+			{
+				Buffer tmp(std::move(l_other));
+				l_other = std::move(*this);
+				*this = std::move(tmp);
+			}
 		}
-
 		/**
 		 * Compare operator.
 		 *
@@ -442,7 +452,7 @@ namespace giggle::common::memory
 
 		T& operator [] (std::size_t l_index)
 		{
-			if (l_index < _used)
+			if (l_index >= _used)
 				throw exception::IndexOutOfBoundsException("Index was out of bounds.");
 
 			return _ptr[l_index];
@@ -450,7 +460,7 @@ namespace giggle::common::memory
 
 		const T& operator [] (std::size_t l_index) const
 		{
-			if (l_index < _used)
+			if (l_index >= _used)
 				throw exception::IndexOutOfBoundsException("Index was out of bounds.");
 
 			return _ptr[l_index];
@@ -459,10 +469,92 @@ namespace giggle::common::memory
 	private:
 		Buffer() = default;
 
+		T* Inline()
+		{
+			return reinterpret_cast<T*>(_inline);
+		}
+
+		bool IsInline() const
+		{
+			return _ptr == reinterpret_cast<const T*>(_inline);
+		}
+
+		/**
+		 * Grows the capacity to at least l_minCapacity, by half again at a time.
+		 */
+		void Grow(std::size_t l_minCapacity)
+		{
+			if (!_ownMem)
+				throw exception::InvalidAccessException("Cannot resize buffer which does not own its storage.");
+
+			auto capacity = _capacity + _capacity / 2;
+			Reallocate(capacity > l_minCapacity ? capacity : l_minCapacity, true);
+		}
+
+		/**
+		 * Moves the content to storage for l_capacity elements, inline when it fits.
+		 */
+		void Reallocate(std::size_t l_capacity, bool l_preserveContent)
+		{
+			if (l_capacity <= INLINE_CAPACITY)
+			{
+				if (IsInline())
+				{
+					return;
+				}
+
+				l_capacity = INLINE_CAPACITY;
+			}
+
+			T* ptr = l_capacity == INLINE_CAPACITY ? Inline() : new T[l_capacity];
+
+			if (l_preserveContent && _used > 0)
+			{
+				std::memcpy(ptr, _ptr, (_used < l_capacity ? _used : l_capacity) * sizeof(T));
+			}
+
+			Deallocate();
+			_ptr = ptr;
+			_capacity = l_capacity;
+			_ownMem = true;
+		}
+
+		void Deallocate()
+		{
+			if (_ownMem && !IsInline()) delete [] _ptr;
+		}
+
+		/**
+		 * Takes over the content of l_other, leaving it empty and inline.
+		 */
+		void Take(Buffer& l_other)
+		{
+			_used = l_other._used;
+			_ownMem = l_other._ownMem;
+
+			if (l_other.IsInline())
+			{
+				std::memcpy(_inline, l_other._inline, sizeof(_inline));
+				_ptr = Inline();
+				_capacity = INLINE_CAPACITY;
+			}
+			else
+			{
+				_ptr = l_other._ptr;
+				_capacity = l_other._capacity;
+			}
+
+			l_other._capacity = INLINE_CAPACITY;
+			l_other._used = 0;
+			l_other._ptr = l_other.Inline();
+			l_other._ownMem = true;
+		}
+
 		std::size_t _capacity{};
 		std::size_t _used{};
 		T*			_ptr;
 		bool 		_ownMem{};
+		alignas(T) char _inline[INLINE_BYTES];
 	};
 
 } // namespace memory
@@ -0,0 +1,430 @@
+/*
+* export-giggle
+* BufferChain.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "BufferChain.hpp"
+#include <exceptions/IndexOutOfBoundsException.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+
+using namespace giggle::common;
+using namespace giggle::common::memory;
+
+char* BufferChain::Storage::Begin()
+{
+	return reinterpret_cast<char*>(this + 1);
+}
+
+char* BufferChain::Storage::End()
+{
+	return Begin() + Capacity;
+}
+
+BufferChain::Segment::Segment(Storage* l_storage, char* l_data, std::size_t l_size):
+	_storage(l_storage),
+	_data(l_data),
+	_size(l_size)
+{
+
+}
+
+BufferChain::Segment::Segment():
+	_storage(nullptr),
+	_data(nullptr),
+	_size(0)
+{
+
+}
+
+BufferChain::Segment::Segment(const Segment& l_other):
+	_storage(l_other._storage),
+	_data(l_other._data),
+	_size(l_other._size)
+{
+	if (_storage != nullptr)
+	{
+		_storage->References.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+BufferChain::Segment::Segment(Segment&& l_other) noexcept:
+	_storage(l_other._storage),
+	_data(l_other._data),
+	_size(l_other._size)
+{
+	l_other._storage = nullptr;
+	l_other._data = nullptr;
+	l_other._size = 0;
+}
+
+BufferChain::Segment& BufferChain::Segment::operator = (Segment l_other) noexcept
+{
+	std::swap(_storage, l_other._storage);
+	std::swap(_data, l_other._data);
+	std::swap(_size, l_other._size);
+	return *this;
+}
+
+BufferChain::Segment::~Segment()
+{
+	if (_storage != nullptr)
+	{
+		BufferChain::Release(_storage);
+	}
+}
+
+const char* BufferChain::Segment::Data() const
+{
+	return _data;
+}
+
+std::size_t BufferChain::Segment::Size() const
+{
+	return _size;
+}
+
+std::size_t BufferChain::Segment::Headroom() const
+{
+	return static_cast<std::size_t>(_data - _storage->Begin());
+}
+
+std::size_t BufferChain::Segment::Tailroom() const
+{
+	return static_cast<std::size_t>(_storage->End() - (_data + _size));
+}
+
+bool BufferChain::Segment::Unique() const
+{
+	return _storage->References.load(std::memory_order_acquire) == 1;
+}
+
+BufferChain::BufferChain(MemoryPool& l_pool, std::size_t l_headroom):
+	_pool(&l_pool),
+	_headroom(l_headroom),
+	_segments(),
+	_size(0)
+{
+	assert(l_pool.BlockSize() > sizeof(Storage));
+}
+
+BufferChain::BufferChain(MemoryPool& l_pool, const char* l_data, std::size_t l_length, std::size_t l_headroom):
+	BufferChain(l_pool, l_headroom)
+{
+	Append(l_data, l_length);
+}
+
+BufferChain::BufferChain(BufferChain&& l_other) noexcept:
+	_pool(l_other._pool),
+	_headroom(l_other._headroom),
+	_segments(std::move(l_other._segments)),
+	_size(l_other._size)
+{
+	l_other._segments.clear();
+	l_other._size = 0;
+}
+
+BufferChain& BufferChain::operator = (BufferChain&& l_other) noexcept
+{
+	if (this != &l_other)
+	{
+		_pool = l_other._pool;
+		_headroom = l_other._headroom;
+		_segments = std::move(l_other._segments);
+		_size = l_other._size;
+
+		l_other._segments.clear();
+		l_other._size = 0;
+	}
+
+	return *this;
+}
+
+void BufferChain::Append(const char* l_data, std::size_t l_length)
+{
+	while (l_length > 0)
+	{
+		auto last = _segments.empty() ? nullptr : &_segments.back();
+		if (last == nullptr || !last->Unique() || last->Tailroom() == 0)
+		{
+			last = &AppendSegment(0);
+		}
+
+		auto take = std::min(l_length, last->Tailroom());
+		std::memcpy(last->_data + last->_size, l_data, take);
+		last->_size += take;
+		_size += take;
+
+		l_data += take;
+		l_length -= take;
+	}
+}
+
+void BufferChain::Append(const BufferChain& l_other)
+{
+	if (this == &l_other)
+	{
+		BufferChain copy(l_other);
+		Append(copy);
+		return;
+	}
+
+	for (auto& segment : l_other._segments)
+	{
+		if (segment._size > 0)
+		{
+			_segments.push_back(segment);
+			_size += segment._size;
+		}
+	}
+}
+
+void BufferChain::Prepend(const char* l_data, std::size_t l_length)
+{
+	// Filled back to front, so the bytes keep their order across blocks.
+	while (l_length > 0)
+	{
+		auto first = _segments.empty() ? nullptr : &_segments.front();
+		if (first == nullptr || !first->Unique() || first->Headroom() == 0)
+		{
+			auto storage = Allocate(0);
+			_segments.emplace_front(Segment(storage, storage->End(), 0));
+			first = &_segments.front();
+		}
+
+		auto take = std::min(l_length, first->Headroom());
+		first->_data -= take;
+		first->_size += take;
+		std::memcpy(first->_data, l_data + l_length - take, take);
+		_size += take;
+
+		l_length -= take;
+	}
+}
+
+char* BufferChain::Reserve(std::size_t l_length)
+{
+	if (_segments.empty() || !_segments.back().Unique() || _segments.back().Tailroom() < l_length)
+	{
+		AppendSegment(l_length);
+	}
+
+	auto& last = _segments.back();
+	return last._data + last._size;
+}
+
+void BufferChain::Commit(std::size_t l_length)
+{
+	if (l_length == 0)
+		return;
+
+	if (_segments.empty() || _segments.back().Tailroom() < l_length)
+		throw exception::IndexOutOfBoundsException("Commit exceeds the reserved space.");
+
+	_segments.back()._size += l_length;
+	_size += l_length;
+}
+
+BufferChain BufferChain::Slice(std::size_t l_offset, std::size_t l_length) const
+{
+	if (l_offset > _size || l_length > _size - l_offset)
+		throw exception::IndexOutOfBoundsException("Slice exceeds the chain.");
+
+	BufferChain slice(*_pool, _headroom);
+
+	for (auto it = _segments.begin(); it != _segments.end() && l_length > 0; ++it)
+	{
+		if (l_offset >= it->_size)
+		{
+			l_offset -= it->_size;
+			continue;
+		}
+
+		auto take = std::min(l_length, it->_size - l_offset);
+		slice._segments.push_back(*it);
+		slice._segments.back()._data += l_offset;
+		slice._segments.back()._size = take;
+		slice._size += take;
+
+		l_offset = 0;
+		l_length -= take;
+	}
+
+	return slice;
+}
+
+void BufferChain::TrimFront(std::size_t l_length)
+{
+	l_length = std::min(l_length, _size);
+	_size -= l_length;
+
+	while (l_length > 0)
+	{
+		auto& first = _segments.front();
+		if (l_length < first._size)
+		{
+			first._data += l_length;
+			first._size -= l_length;
+			return;
+		}
+
+		l_length -= first._size;
+		_segments.pop_front();
+	}
+}
+
+void BufferChain::TrimBack(std::size_t l_length)
+{
+	l_length = std::min(l_length, _size);
+	_size -= l_length;
+
+	while (l_length > 0)
+	{
+		auto& last = _segments.back();
+		if (l_length < last._size)
+		{
+			last._size -= l_length;
+			return;
+		}
+
+		l_length -= last._size;
+		_segments.pop_back();
+	}
+}
+
+const char* BufferChain::Coalesce()
+{
+	if (_size == 0)
+		return nullptr;
+
+	if (_segments.size() > 1 || _segments.front()._size != _size)
+	{
+		auto storage = Allocate(_headroom + _size);
+		Segment joined(storage, storage->Begin() + _headroom, 0);
+
+		for (auto& segment : _segments)
+		{
+			std::memcpy(joined._data + joined._size, segment._data, segment._size);
+			joined._size += segment._size;
+		}
+
+		_segments.clear();
+		_segments.push_back(std::move(joined));
+	}
+
+	return _segments.front()._data;
+}
+
+std::size_t BufferChain::Gather(iovec* l_vectors, std::size_t l_max) const
+{
+	std::size_t count = 0;
+
+	for (auto it = _segments.begin(); it != _segments.end() && count < l_max; ++it)
+	{
+		if (it->_size == 0)
+			continue;
+
+		l_vectors[count].iov_base = it->_data;
+		l_vectors[count].iov_len = it->_size;
+		++count;
+	}
+
+	return count;
+}
+
+void BufferChain::CopyTo(char* l_destination) const
+{
+	for (auto& segment : _segments)
+	{
+		std::memcpy(l_destination, segment._data, segment._size);
+		l_destination += segment._size;
+	}
+}
+
+void BufferChain::Clear()
+{
+	_segments.clear();
+	_size = 0;
+}
+
+std::size_t BufferChain::Size() const
+{
+	return _size;
+}
+
+std::size_t BufferChain::Segments() const
+{
+	return _segments.size();
+}
+
+bool BufferChain::Empty() const
+{
+	return _size == 0;
+}
+
+BufferChain::ConstIterator BufferChain::begin() const
+{
+	return _segments.begin();
+}
+
+BufferChain::ConstIterator BufferChain::end() const
+{
+	return _segments.end();
+}
+
+BufferChain::Storage* BufferChain::Allocate(std::size_t l_capacity)
+{
+	void* memory;
+	MemoryPool* pool = nullptr;
+	auto capacity = _pool->BlockSize() - sizeof(Storage);
+
+	if (l_capacity <= capacity)
+	{
+		memory = _pool->GetMemory();
+		pool = _pool;
+	}
+	else
+	{
+		capacity = l_capacity;
+		memory = ::operator new(sizeof(Storage) + capacity);
+	}
+
+	return new (memory) Storage{{1}, pool, capacity};
+}
+
+void BufferChain::Release(Storage* l_storage)
+{
+	if (l_storage->References.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	if (l_storage->Pool != nullptr)
+		l_storage->Pool->Release(l_storage);
+	else
+		::operator delete(l_storage);
+}
+
+BufferChain::Segment& BufferChain::AppendSegment(std::size_t l_capacity)
+{
+	auto headroom = _segments.empty() ? _headroom : 0;
+	auto storage = Allocate(headroom + l_capacity);
+
+	// The temporary owns the block until it is in the chain.
+	_segments.emplace_back(Segment(storage, storage->Begin() + std::min(headroom, storage->Capacity), 0));
+	return _segments.back();
+}
@@ -0,0 +1,244 @@
+/*
+* export-giggle
+* BufferChain.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_BUFFERCHAIN_HPP
+#define EXPORT_GIGGLE_BUFFERCHAIN_HPP
+
+#include "MemoryPool.hpp"
+
+#include <Types.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+
+#include <sys/uio.h>
+
+namespace giggle::common::memory
+{
+
+	/**
+	 * @brief A sequence of bytes held in reference counted blocks,
+	 * for passing data between layers without copying it.
+	 *
+	 * The bytes are a chain of segments, each a range of a shared
+	 * block taken from a MemoryPool. Copying a chain, appending one
+	 * chain to another or taking a Slice() only shares blocks and bumps
+	 * their reference counts; the bytes themselves stay where they are,
+	 * so one payload can be queued on many connections or a frame can
+	 * be handed on without its header. Writes go to the free space
+	 * around a segment only while no one else shares its block, so
+	 * shared bytes never change.
+	 *
+	 * A chain may reserve headroom in its first block, so a header can
+	 * be prepended to a payload that was written first without another
+	 * segment. Gather() describes the segments as an iovec array, and
+	 * Coalesce() joins them when a contiguous view is needed.
+	 *
+	 * A chain is not thread safe, but the blocks are: copies of a chain
+	 * may be used and destroyed on any thread. The pool must outlive
+	 * every chain using it.
+	 */
+	class BufferChain
+	{
+	private:
+
+		/**
+		 * The header of a block, followed by Capacity bytes of data.
+		 * Blocks too large for the pool come from operator new, with no Pool.
+		 */
+		struct Storage
+		{
+			std::atomic<UInt32>	References;
+			MemoryPool*			Pool;
+			std::size_t			Capacity;
+
+			char* Begin();
+			char* End();
+		};
+
+	public:
+
+		/**
+		 * @brief A range of a shared block; holds a reference to it.
+		 */
+		class Segment
+		{
+		public:
+
+			/**
+			 * @brief Creates an empty segment referencing no block.
+			 */
+			Segment();
+			Segment(const Segment& l_other);
+			Segment(Segment&& l_other) noexcept;
+			Segment& operator = (Segment l_other) noexcept;
+			~Segment();
+
+			const char* Data() const;
+			std::size_t Size() const;
+
+		private:
+
+			friend class BufferChain;
+
+			Segment(Storage* l_storage, char* l_data, std::size_t l_size);
+
+			std::size_t Headroom() const;
+			std::size_t Tailroom() const;
+
+			/// True if no one else references the block, so its free space may be written.
+			bool Unique() const;
+
+			Storage*	_storage;
+			char*		_data;
+			std::size_t	_size;
+		};
+
+		typedef std::deque<Segment>::const_iterator ConstIterator;
+
+		/**
+		 * @brief Creates an empty chain; no block is taken until data is added.
+		 * @param l_pool The pool blocks are taken from.
+		 * @param l_headroom The bytes kept free in front of the first block for Prepend().
+		 */
+		explicit BufferChain(MemoryPool& l_pool, std::size_t l_headroom = 0);
+
+		/**
+		 * @brief Creates a chain holding a copy of the given bytes.
+		 */
+		BufferChain(MemoryPool& l_pool, const char* l_data, std::size_t l_length, std::size_t l_headroom = 0);
+
+		/**
+		 * @brief Shares the blocks of l_other; no bytes are copied.
+		 */
+		BufferChain(const BufferChain& l_other) = default;
+		BufferChain(BufferChain&& l_other) noexcept;
+		BufferChain& operator = (const BufferChain& l_other) = default;
+		BufferChain& operator = (BufferChain&& l_other) noexcept;
+
+		/**
+		 * @brief Copies the bytes to the end of the chain, filling the free
+		 * space of the last block first.
+		 * @throws OutOfMemoryException if the pool is exhausted.
+		 */
+		void Append(const char* l_data, std::size_t l_length);
+
+		/**
+		 * @brief Appends the bytes of l_other by sharing its blocks.
+		 */
+		void Append(const BufferChain& l_other);
+
+		/**
+		 * @brief Copies the bytes to the front of the chain, using the headroom
+		 * of the first block if it can.
+		 * @throws OutOfMemoryException if the pool is exhausted.
+		 */
+		void Prepend(const char* l_data, std::size_t l_length);
+
+		/**
+		 * @brief Returns room for at least l_length contiguous bytes at the end of
+		 * the chain, to be written in place and published with Commit().
+		 * Requests larger than a pool block are served by operator new.
+		 * @throws OutOfMemoryException if the pool is exhausted.
+		 */
+		char* Reserve(std::size_t l_length);
+
+		/**
+		 * @brief Adds l_length bytes written at Reserve() to the chain.
+		 * @throws IndexOutOfBoundsException if they exceed the reserved space.
+		 */
+		void Commit(std::size_t l_length);
+
+		/**
+		 * @brief Returns a chain sharing l_length bytes starting at l_offset.
+		 * @throws IndexOutOfBoundsException if the range exceeds the chain.
+		 */
+		BufferChain Slice(std::size_t l_offset, std::size_t l_length) const;
+
+		/**
+		 * @brief Drops l_length bytes from the front of the chain.
+		 */
+		void TrimFront(std::size_t l_length);
+
+		/**
+		 * @brief Drops l_length bytes from the back of the chain.
+		 */
+		void TrimBack(std::size_t l_length);
+
+		/**
+		 * @brief Makes the bytes contiguous, copying them into a single block
+		 * if they span several segments.
+		 * @return The bytes, or nullptr if the chain is empty.
+		 */
+		const char* Coalesce();
+
+		/**
+		 * @brief Describes up to l_max leading segments in l_vectors.
+		 * @return The number of iovecs filled in.
+		 */
+		std::size_t Gather(iovec* l_vectors, std::size_t l_max) const;
+
+		/**
+		 * @brief Copies every byte to l_destination, which must hold Size() bytes.
+		 */
+		void CopyTo(char* l_destination) const;
+
+		/**
+		 * @brief Drops every segment.
+		 */
+		void Clear();
+
+		/**
+		 * @brief Returns the number of bytes in the chain.
+		 */
+		std::size_t Size() const;
+
+		/**
+		 * @brief Returns the number of segments in the chain.
+		 */
+		std::size_t Segments() const;
+
+		bool Empty() const;
+
+		ConstIterator begin() const;
+		ConstIterator end() const;
+
+	private:
+
+		/**
+		 * Takes a block with room for at least l_capacity bytes, from the pool if it fits.
+		 */
+		Storage* Allocate(std::size_t l_capacity);
+
+		static void Release(Storage* l_storage);
+
+		/**
+		 * Appends a new, empty segment with at least l_capacity bytes of room.
+		 */
+		Segment& AppendSegment(std::size_t l_capacity);
+
+		MemoryPool*			_pool;
+		std::size_t			_headroom;
+		std::deque<Segment>	_segments;
+		std::size_t			_size;
+	};
+
+} // namespace memory
+
+#endif //EXPORT_GIGGLE_BUFFERCHAIN_HPP
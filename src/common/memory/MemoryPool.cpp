@@ -20,12 +20,66 @@
 #include "MemoryPool.hpp"
 #include <exceptions/OutOfMemoryException.hpp>
 
+#include <algorithm>
+#include <atomic>
+
+using namespace giggle::common;
 using namespace giggle::common::memory;
 
-MemoryPool::MemoryPool(std::size_t l_block_size, int l_pre_alloc, int l_max_alloc):
+namespace
+{
+	/// Tells pools apart in thread caches; never reused, unlike addresses.
+	std::atomic<UInt64> s_nextPoolId{1};
+
+	/// Guards the link between magazines and their pool, which either side may end first.
+	std::mutex s_registryMutex;
+
+	/// Set once the calling thread's cache is gone; trivially destructible, so it outlives it.
+	thread_local bool t_cacheDestroyed = false;
+}
+
+/**
+ * The magazines of the calling thread, one per pool it used.
+ * Pools are few per thread, so a linear scan with a one-entry
+ * front cache is all the lookup needed.
+ */
+struct MemoryPool::ThreadCache
+{
+	std::vector<std::pair<UInt64, Magazine*>> Entries;
+	std::pair<UInt64, Magazine*> Last{0, nullptr};
+
+	~ThreadCache()
+	{
+		t_cacheDestroyed = true;
+
+		std::lock_guard<std::mutex> registry{s_registryMutex};
+
+		for (auto& entry : Entries)
+		{
+			auto magazine = entry.second;
+			auto pool = magazine->Pool;
+
+			if (pool != nullptr)
+			{
+				std::lock_guard<std::mutex> lock{pool->_mutex};
+				pool->_blocks.insert(pool->_blocks.end(), magazine->Blocks.begin(), magazine->Blocks.end());
+				pool->_magazines.erase(std::find(pool->_magazines.begin(), pool->_magazines.end(), magazine));
+			}
+
+			delete magazine;
+		}
+	}
+};
+
+MemoryPool::MemoryPool(std::size_t l_block_size, int l_pre_alloc, int l_max_alloc, std::size_t l_magazine_size,
+					   BlockSource* l_source):
 	_block_size(l_block_size),
+	_source(l_source != nullptr ? l_source : &HeapBlockSource::Instance()),
 	_max_alloc(l_max_alloc),
-	_allocated(l_pre_alloc)
+	_allocated(l_pre_alloc),
+	_magazine_size(l_max_alloc > 0 ? 0 : l_magazine_size),
+	_id(s_nextPoolId++),
+	_magazines()
 {
 	assert(l_max_alloc == 0 || l_max_alloc >= l_pre_alloc);
 	assert(l_pre_alloc >= 0 && l_max_alloc >= 0);
@@ -43,7 +97,7 @@ MemoryPool::MemoryPool(std::size_t l_block_size, int l_pre_alloc, int l_max_allo
 	try
 	{
 		for (int i = 0; i < l_pre_alloc; ++i) {
-			_blocks.push_back(new char[_block_size]);
+			_blocks.push_back(_source->Allocate(_block_size));
 		}
 	}
 	catch (...)
@@ -56,10 +110,72 @@ MemoryPool::MemoryPool(std::size_t l_block_size, int l_pre_alloc, int l_max_allo
 
 MemoryPool::~MemoryPool()
 {
+	{
+		// Threads still holding a magazine of this pool find it orphaned when they exit.
+		std::lock_guard<std::mutex> registry{s_registryMutex};
+
+		for (auto magazine : _magazines)
+		{
+			for (auto block : magazine->Blocks)
+			{
+				_source->Free(block, _block_size);
+			}
+
+			magazine->Blocks.clear();
+			magazine->Pool = nullptr;
+		}
+		_magazines.clear();
+	}
+
 	Clear();
 }
 
 void *MemoryPool::GetMemory()
+{
+	auto magazine = LocalMagazine();
+	if (magazine == nullptr)
+	{
+		return Allocate();
+	}
+
+	if (magazine->Blocks.empty())
+	{
+		return Refill(*magazine);
+	}
+
+	auto ptr = magazine->Blocks.back();
+	magazine->Blocks.pop_back();
+	return ptr;
+}
+
+void MemoryPool::Release(void *l_ptr)
+{
+	auto magazine = LocalMagazine();
+	if (magazine == nullptr)
+	{
+		std::lock_guard<std::mutex> lock{_mutex};
+
+		try
+		{
+			_blocks.push_back(reinterpret_cast<char*>(l_ptr));
+		}
+		catch (...)
+		{
+			_source->Free(reinterpret_cast<char*>(l_ptr), _block_size);
+		}
+		return;
+	}
+
+	if (magazine->Blocks.size() >= _magazine_size)
+	{
+		Spill(*magazine);
+	}
+
+	// The magazine reserved its full size up front, so this never allocates.
+	magazine->Blocks.push_back(reinterpret_cast<char*>(l_ptr));
+}
+
+void* MemoryPool::Allocate()
 {
 	std::lock_guard<std::mutex> lock{_mutex};
 
@@ -67,8 +183,9 @@ void *MemoryPool::GetMemory()
 	{
 		if (_max_alloc == 0 || _allocated < _max_alloc)
 		{
+			auto ptr = _source->Allocate(_block_size);
 			++_allocated;
-			return new char[_block_size];
+			return ptr;
 		}
 		else
 			throw exception::OutOfMemoryException("MemoryPool exhausted.");
@@ -81,18 +198,81 @@ void *MemoryPool::GetMemory()
 	}
 }
 
-void MemoryPool::Release(void *l_ptr)
+MemoryPool::Magazine* MemoryPool::LocalMagazine()
 {
-	std::lock_guard<std::mutex> lock{_mutex};
+	// Late calls, e.g. from static destructors, go through the shared list.
+	if (_magazine_size == 0 || t_cacheDestroyed)
+		return nullptr;
 
-	try
+	static thread_local ThreadCache cache;
+
+	if (cache.Last.first == _id)
+		return cache.Last.second;
+
+	for (auto& entry : cache.Entries)
 	{
-		_blocks.push_back(reinterpret_cast<char*>(l_ptr));
+		if (entry.first == _id)
+		{
+			cache.Last = entry;
+			return entry.second;
+		}
 	}
-	catch (...)
+
+	std::lock_guard<std::mutex> registry{s_registryMutex};
+
+	// Drop the magazines of pools destroyed since, so the cache stays short.
+	cache.Entries.erase(std::remove_if(cache.Entries.begin(), cache.Entries.end(),
+									   [](const std::pair<UInt64, Magazine*>& l_entry)
+									   {
+										   if (l_entry.second->Pool != nullptr)
+											   return false;
+
+										   delete l_entry.second;
+										   return true;
+									   }),
+						cache.Entries.end());
+
+	auto magazine = new Magazine{this, {}};
+	magazine->Blocks.reserve(_magazine_size);
+
 	{
-		delete [] reinterpret_cast<char*>(l_ptr);
+		std::lock_guard<std::mutex> lock{_mutex};
+		_magazines.push_back(magazine);
 	}
+
+	cache.Entries.emplace_back(_id, magazine);
+	cache.Last = cache.Entries.back();
+	return magazine;
+}
+
+void* MemoryPool::Refill(Magazine& l_magazine)
+{
+	{
+		std::lock_guard<std::mutex> lock{_mutex};
+
+		// Half a magazine, so the next few releases do not spill right away.
+		auto count = std::min(_blocks.size(), std::max<std::size_t>(1, _magazine_size / 2));
+		if (count > 0)
+		{
+			l_magazine.Blocks.insert(l_magazine.Blocks.end(), _blocks.end() - count, _blocks.end());
+			_blocks.resize(_blocks.size() - count);
+
+			auto ptr = l_magazine.Blocks.back();
+			l_magazine.Blocks.pop_back();
+			return ptr;
+		}
+	}
+
+	return Allocate();
+}
+
+void MemoryPool::Spill(Magazine& l_magazine)
+{
+	std::lock_guard<std::mutex> lock{_mutex};
+
+	auto count = std::max<std::size_t>(1, _magazine_size / 2);
+	_blocks.insert(_blocks.end(), l_magazine.Blocks.end() - count, l_magazine.Blocks.end());
+	l_magazine.Blocks.resize(l_magazine.Blocks.size() - count);
 }
 
 std::size_t MemoryPool::BlockSize() const
@@ -102,18 +282,25 @@ std::size_t MemoryPool::BlockSize() const
 
 int MemoryPool::Allocated() const
 {
+	std::lock_guard<std::mutex> lock{_mutex};
 	return _allocated;
 }
 
 int MemoryPool::Available() const
 {
+	std::lock_guard<std::mutex> lock{_mutex};
 	return static_cast<int>(_blocks.size());
 }
 
+std::size_t MemoryPool::MagazineSize() const
+{
+	return _magazine_size;
+}
+
 void MemoryPool::Clear()
 {
 	for (auto &_block : _blocks) {
-		delete [] _block;
+		_source->Free(_block, _block_size);
 	}
 	_blocks.clear();
 }
@@ -19,6 +19,10 @@
 #ifndef EXPORT_GIGGLE_MEMORYPOOL_HPP
 #define EXPORT_GIGGLE_MEMORYPOOL_HPP
 
+#include "BlockSource.hpp"
+
+#include <Types.hpp>
+
 #include <cstdio>
 #include <vector>
 #include <mutex>
@@ -37,19 +41,42 @@ namespace giggle::common::memory
 	 * All allocated blocks are retained for future use.
 	 * A limit on the number of blocks can be specified.
 	 * Blocks can be preallocated.
+	 *
+	 * Every thread using the pool gets its own magazine, a small
+	 * free list only that thread touches, so GetMemory() and Release()
+	 * usually take no lock at all. An empty magazine is refilled from
+	 * the shared free list and a full one spills to it, half a magazine
+	 * at a time under the pool mutex. Blocks sitting in a magazine count
+	 * as allocated, not as available; they go back to the pool when
+	 * their thread exits. A pool with a block limit keeps no magazines:
+	 * blocks cached by other threads could not be handed out, and the
+	 * limit would be reached with fewer blocks in use.
+	 *
+	 * Blocks come from a BlockSource, one heap allocation each by default;
+	 * a MappedBlockSource keeps them in one contiguous, optionally huge
+	 * page backed region instead.
 	 */
 	class MemoryPool {
 
 	public:
 
+		enum
+		{
+			DEFAULT_MAGAZINE_SIZE = 16
+		};
+
 		/**
 		 * @brief Creates a MemoryPool for blocks with given l_block_size.
 		 * The number of blocks given in l_pre_alloc are preallocated.
 		 * @param l_block_size The size of a block.
 		 * @param l_pre_alloc  The number of blocks to preallocate.
 		 * @param l_max_alloc  The max number of blocks that can be preallocated.
+		 * @param l_magazine_size The number of blocks each thread caches; 0 disables the caches,
+		 * as does a limit in l_max_alloc.
+		 * @param l_source Where blocks come from, which must outlive the pool; nullptr for the heap.
 		 */
-		explicit MemoryPool(std::size_t l_block_size, int l_pre_alloc = 0, int l_max_alloc = 0);
+		explicit MemoryPool(std::size_t l_block_size, int l_pre_alloc = 0, int l_max_alloc = 0,
+							std::size_t l_magazine_size = DEFAULT_MAGAZINE_SIZE, BlockSource* l_source = nullptr);
 		MemoryPool() = delete;
 
 		~MemoryPool();
@@ -83,18 +110,47 @@ namespace giggle::common::memory
 		int Allocated() const;
 
 		/**
-		 * @brief Returns the number of available blocks in the pool.
+		 * @brief Returns the number of available blocks in the pool,
+		 * not counting those cached by threads.
 		 *
 		 */
 		int Available() const;
 
+		/**
+		 * @brief Returns the number of blocks each thread caches.
+		 *
+		 */
+		std::size_t MagazineSize() const;
+
 	private:
 
+		/**
+		 * The blocks one thread cached from one pool. Only the owning thread
+		 * touches Blocks, except when the pool is destroyed before the thread
+		 * exits; Pool is reset to nullptr then, under the registry lock.
+		 */
+		struct Magazine
+		{
+			MemoryPool*			Pool;
+			std::vector<char*>	Blocks;
+		};
+
+		struct ThreadCache;
+
 		MemoryPool(const MemoryPool&);
 		MemoryPool& operator= (const MemoryPool&);
 
 		void Clear();
 
+		/**
+		 * @brief Returns the calling thread's magazine, or nullptr when the
+		 * pool keeps none or the thread's cache was already destroyed.
+		 */
+		Magazine* LocalMagazine();
+		void* Refill(Magazine& l_magazine);
+		void Spill(Magazine& l_magazine);
+		void* Allocate();
+
 		enum
 		{
 			BLOCK_RESERVE = 128
@@ -103,10 +159,15 @@ namespace giggle::common::memory
 		typedef std::vector<char*> BlockVec;
 
 		std::size_t _block_size;
+		BlockSource* _source;
 		int 		_max_alloc;
 		int 		_allocated;
 		BlockVec	_blocks;
-		std::mutex	_mutex;
+		mutable std::mutex	_mutex;
+
+		const std::size_t		_magazine_size;
+		const UInt64			_id;
+		std::vector<Magazine*>	_magazines;
 
 	};
 
@@ -0,0 +1,227 @@
+/*
+* export-giggle
+* ObjectPool.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_OBJECTPOOL_HPP
+#define EXPORT_GIGGLE_OBJECTPOOL_HPP
+
+#include "MemoryPool.hpp"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace giggle::common::memory
+{
+
+	/**
+	 * @brief A pool of objects of type T, built on a MemoryPool.
+	 *
+	 * Acquire() constructs an object in a pool block and returns a Handle,
+	 * a std::unique_ptr that gives the object back when it goes away.
+	 *
+	 * Without a reset hook an object given back is destroyed and only its
+	 * memory is reused. With one, the hook is run instead and the object
+	 * is kept constructed for the next Acquire(), so members such as
+	 * strings and vectors keep the capacity they grew to; the hook clears
+	 * whatever state must not leak into the next use. The arguments of
+	 * Acquire() are then only used when no recycled object is available.
+	 *
+	 * Thread safe. Every handle must be gone before the pool is destroyed.
+	 */
+	template <class T>
+	class ObjectPool
+	{
+	public:
+
+		typedef std::function<void(T&)> ResetHook;
+
+		/**
+		 * @brief Gives an object back to its pool.
+		 */
+		class Recycler
+		{
+		public:
+
+			Recycler() :
+				_pool(nullptr)
+			{
+
+			}
+
+			explicit Recycler(ObjectPool* l_pool) :
+				_pool(l_pool)
+			{
+
+			}
+
+			void operator()(T* l_object) const
+			{
+				_pool->Recycle(l_object);
+			}
+
+		private:
+
+			ObjectPool* _pool;
+		};
+
+		typedef std::unique_ptr<T, Recycler> Handle;
+
+		/**
+		 * @brief Creates the pool.
+		 * @param l_capacity The most objects alive at once; 0 for no limit.
+		 * @param l_reset Run on objects given back to keep them for reuse; empty to destroy them.
+		 * @param l_source Where the pool's memory comes from; nullptr for the heap.
+		 */
+		explicit ObjectPool(int l_capacity = 0, ResetHook l_reset = ResetHook(), BlockSource* l_source = nullptr);
+
+		/**
+		 * @brief Destroys the recycled objects.
+		 */
+		~ObjectPool();
+
+		ObjectPool(const ObjectPool&) = delete;
+		ObjectPool& operator = (const ObjectPool&) = delete;
+
+		/**
+		 * @brief Returns a recycled object, or one constructed from l_args.
+		 * @throws OutOfMemoryException if l_capacity objects are alive.
+		 */
+		template <class... Args>
+		Handle Acquire(Args&&... l_args);
+
+		/**
+		 * @brief Returns the number of objects kept for reuse.
+		 */
+		std::size_t Recycled() const;
+
+		/**
+		 * @brief Returns the number of objects the pool has memory for, in use or not.
+		 */
+		int Allocated() const;
+
+	private:
+
+		void Recycle(T* l_object);
+
+		enum
+		{
+			BLOCK_SIZE = (sizeof(T) + alignof(T) - 1) / alignof(T) * alignof(T)
+		};
+
+		static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+					  "ObjectPool blocks are only aligned for operator new.");
+
+		MemoryPool			_pool;
+		ResetHook			_reset;
+
+		mutable std::mutex	_mutex;
+		std::vector<T*>		_recycled;
+	};
+
+	template <class T>
+	ObjectPool<T>::ObjectPool(int l_capacity, ResetHook l_reset, BlockSource* l_source) :
+		_pool(BLOCK_SIZE, 0, l_capacity, MemoryPool::DEFAULT_MAGAZINE_SIZE, l_source),
+		_reset(std::move(l_reset))
+	{
+		if (l_capacity > 0)
+		{
+			_recycled.reserve(static_cast<std::size_t>(l_capacity));
+		}
+	}
+
+	template <class T>
+	ObjectPool<T>::~ObjectPool()
+	{
+		for (auto object : _recycled)
+		{
+			object->~T();
+			_pool.Release(object);
+		}
+	}
+
+	template <class T>
+	template <class... Args>
+	typename ObjectPool<T>::Handle ObjectPool<T>::Acquire(Args&&... l_args)
+	{
+		if (_reset)
+		{
+			std::lock_guard<std::mutex> lock{_mutex};
+
+			if (!_recycled.empty())
+			{
+				auto object = _recycled.back();
+				_recycled.pop_back();
+				return Handle(object, Recycler(this));
+			}
+		}
+
+		auto memory = _pool.GetMemory();
+
+		try
+		{
+			return Handle(new (memory) T(std::forward<Args>(l_args)...), Recycler(this));
+		}
+		catch (...)
+		{
+			_pool.Release(memory);
+			throw;
+		}
+	}
+
+	template <class T>
+	void ObjectPool<T>::Recycle(T* l_object)
+	{
+		if (_reset)
+		{
+			try
+			{
+				_reset(*l_object);
+
+				std::lock_guard<std::mutex> lock{_mutex};
+				_recycled.push_back(l_object);
+				return;
+			}
+			catch (...)
+			{
+				// An object that cannot be reset or kept is destroyed instead.
+			}
+		}
+
+		l_object->~T();
+		_pool.Release(l_object);
+	}
+
+	template <class T>
+	std::size_t ObjectPool<T>::Recycled() const
+	{
+		std::lock_guard<std::mutex> lock{_mutex};
+		return _recycled.size();
+	}
+
+	template <class T>
+	int ObjectPool<T>::Allocated() const
+	{
+		return _pool.Allocated();
+	}
+
+} // namespace memory
+
+#endif //EXPORT_GIGGLE_OBJECTPOOL_HPP
@@ -0,0 +1,130 @@
+/*
+* export-giggle
+* SlabAllocator.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "SlabAllocator.hpp"
+
+#include <algorithm>
+
+using namespace giggle::common;
+using namespace giggle::common::memory;
+
+double SlabAllocator::ClassStatistics::Fragmentation() const
+{
+	auto reserved = static_cast<double>(Live) * BlockSize;
+	return reserved == 0 ? 0.0 : 1.0 - Requested / reserved;
+}
+
+SlabAllocator::SizeClass::SizeClass(std::size_t l_size):
+	Pool(l_size, 0, 0, std::max<std::size_t>(1, std::min<std::size_t>(MemoryPool::DEFAULT_MAGAZINE_SIZE,
+																		MAGAZINE_BYTES / l_size))),
+	Live(0),
+	Requested(0),
+	Allocations(0)
+{
+
+}
+
+SlabAllocator::SlabAllocator(std::size_t l_maxSize):
+	_classes(),
+	_maxSize(ClassSize(ClassOf(std::max<std::size_t>(l_maxSize, MIN_SIZE))))
+{
+	auto classes = ClassOf(_maxSize) + 1;
+	_classes.reserve(classes);
+
+	for (std::size_t i = 0; i < classes; ++i)
+	{
+		_classes.push_back(std::make_unique<SizeClass>(ClassSize(i)));
+	}
+}
+
+SlabAllocator::~SlabAllocator()
+{
+
+}
+
+void* SlabAllocator::Allocate(std::size_t l_size)
+{
+	if (l_size > _maxSize)
+		return ::operator new(l_size);
+
+	auto& sizeClass = *_classes[ClassOf(l_size)];
+	auto ptr = sizeClass.Pool.GetMemory();
+
+	sizeClass.Live.fetch_add(1, std::memory_order_relaxed);
+	sizeClass.Requested.fetch_add(l_size, std::memory_order_relaxed);
+	sizeClass.Allocations.fetch_add(1, std::memory_order_relaxed);
+
+	return ptr;
+}
+
+void SlabAllocator::Deallocate(void* l_ptr, std::size_t l_size)
+{
+	if (l_ptr == nullptr)
+		return;
+
+	if (l_size > _maxSize)
+	{
+		::operator delete(l_ptr);
+		return;
+	}
+
+	auto& sizeClass = *_classes[ClassOf(l_size)];
+
+	sizeClass.Live.fetch_sub(1, std::memory_order_relaxed);
+	sizeClass.Requested.fetch_sub(l_size, std::memory_order_relaxed);
+
+	sizeClass.Pool.Release(l_ptr);
+}
+
+std::size_t SlabAllocator::MaxSize() const
+{
+	return _maxSize;
+}
+
+std::vector<SlabAllocator::ClassStatistics> SlabAllocator::Statistics() const
+{
+	std::vector<ClassStatistics> statistics;
+	statistics.reserve(_classes.size());
+
+	for (auto& sizeClass : _classes)
+	{
+		statistics.push_back(ClassStatistics{
+			sizeClass->Pool.BlockSize(),
+			sizeClass->Live.load(std::memory_order_relaxed),
+			sizeClass->Requested.load(std::memory_order_relaxed),
+			sizeClass->Allocations.load(std::memory_order_relaxed),
+			sizeClass->Pool.Allocated()
+		});
+	}
+
+	return statistics;
+}
+
+double SlabAllocator::Fragmentation() const
+{
+	double reserved = 0;
+	double requested = 0;
+
+	for (auto& sizeClass : _classes)
+	{
+		reserved += static_cast<double>(sizeClass->Live.load(std::memory_order_relaxed)) * sizeClass->Pool.BlockSize();
+		requested += sizeClass->Requested.load(std::memory_order_relaxed);
+	}
+
+	return reserved == 0 ? 0.0 : 1.0 - requested / reserved;
+}
@@ -0,0 +1,187 @@
+/*
+* export-giggle
+* SlabAllocator.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_SLABALLOCATOR_HPP
+#define EXPORT_GIGGLE_SLABALLOCATOR_HPP
+
+#include "MemoryPool.hpp"
+
+#include <Types.hpp>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace giggle::common::memory
+{
+
+	/**
+	 * @brief A general purpose allocator made of one MemoryPool per size class.
+	 *
+	 * Requests are rounded up to the nearest size class and served by
+	 * that class's pool, so a 100 byte message takes a 112 byte block
+	 * rather than a block sized for the largest message. Classes are
+	 * 16 bytes apart up to 128 bytes, then four per power of two (160,
+	 * 192, 224, 256, 320, ...), which bounds the space lost to rounding
+	 * at 20% while keeping the number of pools small. Finding the class
+	 * of a size is a handful of arithmetic instructions, no search.
+	 *
+	 * Requests above the largest class go straight to operator new.
+	 * Blocks carry no header, so Deallocate() must be given the size
+	 * that was requested. Thread safe, like the pools behind it.
+	 */
+	class SlabAllocator
+	{
+	public:
+
+		enum
+		{
+			MIN_SIZE = 16,
+			DEFAULT_MAX_SIZE = 1048576
+		};
+
+		/**
+		 * @brief How much of a size class is in use, and how well it fits.
+		 */
+		struct ClassStatistics
+		{
+			/// The block size of the class.
+			std::size_t BlockSize;
+
+			/// The blocks currently handed out.
+			UInt64 Live;
+
+			/// The bytes requested for the blocks currently handed out.
+			UInt64 Requested;
+
+			/// The allocations served by the class so far.
+			UInt64 Allocations;
+
+			/// The blocks the class's pool allocated, in use or not.
+			int Blocks;
+
+			/**
+			 * @brief Returns the share of the live blocks' bytes lost to rounding up.
+			 */
+			double Fragmentation() const;
+		};
+
+		/**
+		 * @brief Creates the allocator.
+		 * @param l_maxSize The largest size served from a pool; rounded up to a class.
+		 */
+		explicit SlabAllocator(std::size_t l_maxSize = DEFAULT_MAX_SIZE);
+		~SlabAllocator();
+
+		SlabAllocator(const SlabAllocator&) = delete;
+		SlabAllocator& operator = (const SlabAllocator&) = delete;
+
+		/**
+		 * @brief Returns a block of at least l_size bytes, aligned like operator new.
+		 * @throws OutOfMemoryException
+		 */
+		void* Allocate(std::size_t l_size);
+
+		/**
+		 * @brief Returns a block to its class.
+		 * @param l_ptr The block.
+		 * @param l_size The size it was allocated with.
+		 */
+		void Deallocate(void* l_ptr, std::size_t l_size);
+
+		/**
+		 * @brief Returns the size class index for a request of l_size bytes.
+		 */
+		static std::size_t ClassOf(std::size_t l_size);
+
+		/**
+		 * @brief Returns the block size of the given class.
+		 */
+		static std::size_t ClassSize(std::size_t l_class);
+
+		/**
+		 * @brief Returns the largest size served from a pool.
+		 */
+		std::size_t MaxSize() const;
+
+		/**
+		 * @brief Returns a snapshot of every size class.
+		 */
+		std::vector<ClassStatistics> Statistics() const;
+
+		/**
+		 * @brief Returns the share of all live block bytes lost to rounding up.
+		 */
+		double Fragmentation() const;
+
+	private:
+
+		enum
+		{
+			/// Classes below this size are MIN_SIZE apart.
+			LINEAR_LIMIT = 128,
+			LINEAR_CLASSES = LINEAR_LIMIT / MIN_SIZE,
+			/// log2(LINEAR_LIMIT)
+			LINEAR_BITS = 7,
+			/// Classes per power of two above LINEAR_LIMIT, as a power of two.
+			STEP_BITS = 2,
+			/// Bytes a thread may cache per class, see MemoryPool::MagazineSize().
+			MAGAZINE_BYTES = 65536
+		};
+
+		struct alignas(64) SizeClass
+		{
+			explicit SizeClass(std::size_t l_size);
+
+			MemoryPool				Pool;
+			std::atomic<UInt64>		Live;
+			std::atomic<UInt64>		Requested;
+			std::atomic<UInt64>		Allocations;
+		};
+
+		std::vector<std::unique_ptr<SizeClass>>	_classes;
+		const std::size_t						_maxSize;
+	};
+
+	inline std::size_t SlabAllocator::ClassOf(std::size_t l_size)
+	{
+		if (l_size <= LINEAR_LIMIT)
+			return l_size == 0 ? 0 : (l_size - 1) / MIN_SIZE;
+
+		auto last = l_size - 1;
+		auto power = static_cast<std::size_t>(63 - __builtin_clzll(last));
+		auto step = (last >> (power - STEP_BITS)) & ((1u << STEP_BITS) - 1);
+
+		return LINEAR_CLASSES + ((power - LINEAR_BITS) << STEP_BITS) + step;
+	}
+
+	inline std::size_t SlabAllocator::ClassSize(std::size_t l_class)
+	{
+		if (l_class < LINEAR_CLASSES)
+			return (l_class + 1) * MIN_SIZE;
+
+		auto index = l_class - LINEAR_CLASSES;
+		auto power = LINEAR_BITS + (index >> STEP_BITS);
+		auto step = (index & ((1u << STEP_BITS) - 1)) + 1;
+
+		return (std::size_t(1) << power) + step * (std::size_t(1) << (power - STEP_BITS));
+	}
+
+} // namespace memory
+
+#endif //EXPORT_GIGGLE_SLABALLOCATOR_HPP
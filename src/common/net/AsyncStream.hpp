@@ -0,0 +1,500 @@
+/*
+* export-giggle
+* AsyncStream.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_ASYNCSTREAM_HPP
+#define EXPORT_GIGGLE_ASYNCSTREAM_HPP
+
+#include <threading/Coroutine.hpp>
+
+#ifdef GIGGLE_HAVE_COROUTINES
+
+#include "TcpServer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace giggle::common::net
+{
+
+	/**
+	 * @brief Resumes coroutines on the thread of a Reactor.
+	 * Coroutines scheduled here after the reactor stopped are never
+	 * resumed, and their frames leak.
+	 */
+	class ReactorExecutor : public threading::Executor
+	{
+	public:
+
+		explicit ReactorExecutor(Reactor& l_reactor) :
+			_reactor(l_reactor)
+		{
+
+		}
+
+		void Execute(std::coroutine_handle<> l_coroutine) override
+		{
+			_reactor.Post([l_coroutine]() { l_coroutine.resume(); });
+		}
+
+	private:
+
+		Reactor&	_reactor;
+	};
+
+	/**
+	 * @brief A connection seen from a coroutine, see AsyncRead() and AsyncWrite().
+	 *
+	 * Bytes the reactor receives are kept until read, and a coroutine
+	 * waiting to read or to write is resumed from the connection's
+	 * handlers. Like the connection, a stream must only be used on its
+	 * reactor's thread; Executor() gets a coroutine there. The stream
+	 * outlives the connection: once closed, reads return what was left
+	 * and then 0, and writes fail.
+	 *
+	 * Once more than INBOX_LIMIT bytes wait to be read, the reactor stops
+	 * reading the peer, see Connection::PauseReading(), until reads bring
+	 * them down to half of that. Bytes the backend already received still
+	 * arrive, one read with epoll and up to its buffer ring with io_uring.
+	 */
+	class AsyncStream
+	{
+	public:
+
+		enum
+		{
+			INBOX_LIMIT = 256 * 1024
+		};
+
+		explicit AsyncStream(Connection& l_connection) :
+			_connection(&l_connection),
+			_id(l_connection.Id()),
+			_reactor(l_connection.GetReactor()),
+			_executor(_reactor),
+			_consumed(0)
+		{
+
+		}
+
+		AsyncStream(const AsyncStream&) = delete;
+		AsyncStream& operator = (const AsyncStream&) = delete;
+
+		/**
+		 * @brief Returns the connection, or nullptr once it closed.
+		 */
+		Connection* GetConnection() const
+		{
+			return _connection;
+		}
+
+		ConnectionId Id() const
+		{
+			return _id;
+		}
+
+		bool Open() const
+		{
+			return _connection != nullptr;
+		}
+
+		Reactor& GetReactor() const
+		{
+			return _reactor;
+		}
+
+		/**
+		 * @brief Returns an executor running coroutines on the stream's reactor thread.
+		 */
+		threading::Executor& Executor()
+		{
+			return _executor;
+		}
+
+		/**
+		 * @brief Returns the number of received bytes not read yet.
+		 */
+		std::size_t Available() const
+		{
+			return _inbox.size() - _consumed;
+		}
+
+		/**
+		 * @brief Closes the connection; waiting coroutines are resumed.
+		 */
+		void Close()
+		{
+			if (_connection != nullptr)
+				_connection->Close();
+		}
+
+	private:
+
+		friend class AsyncListener;
+		friend struct ReadAwaiter;
+		friend struct WriteAwaiter;
+
+		std::size_t Take(char* l_buffer, std::size_t l_size)
+		{
+			auto count = std::min(l_size, Available());
+			std::memcpy(l_buffer, _inbox.data() + _consumed, count);
+			_consumed += count;
+
+			// Drop what was read once it outweighs the rest, so a reader that
+			// never catches up does not keep the whole history.
+			if (_consumed >= Available())
+			{
+				_inbox.erase(_inbox.begin(), _inbox.begin() + static_cast<std::ptrdiff_t>(_consumed));
+				_consumed = 0;
+			}
+
+			// Last, as the reactor may hand over data or close the connection right away.
+			if (_connection != nullptr && Available() <= INBOX_LIMIT / 2)
+				_connection->ResumeReading();
+
+			return count;
+		}
+
+		void Received(const char* l_data, std::size_t l_length)
+		{
+			_inbox.insert(_inbox.end(), l_data, l_data + l_length);
+
+			if (Available() > INBOX_LIMIT)
+				_connection->PauseReading();
+
+			Wake(_reader);
+		}
+
+		void Writable()
+		{
+			Wake(_writer);
+		}
+
+		void Closed()
+		{
+			_connection = nullptr;
+			Wake(_reader);
+			Wake(_writer);
+		}
+
+		static void Wake(std::coroutine_handle<>& l_waiting)
+		{
+			if (l_waiting)
+				std::exchange(l_waiting, nullptr).resume();
+		}
+
+		Connection*					_connection;
+		const ConnectionId			_id;
+		Reactor&					_reactor;
+		ReactorExecutor				_executor;
+
+		std::vector<char>			_inbox;
+		std::size_t					_consumed;
+
+		std::coroutine_handle<>		_reader;
+		std::coroutine_handle<>		_writer;
+
+		/// Keeps the stream alive while its connection is open.
+		std::shared_ptr<AsyncStream> _self;
+	};
+
+	/**
+	 * @brief Hands the clients of a TcpServer to coroutines as AsyncStreams.
+	 *
+	 * Takes over the server's receive, writable, open and close handlers,
+	 * so it must be created before Listen() and the server must not
+	 * decode frames, and it must outlive the server's Listen(). Every
+	 * accepted client is queued until a coroutine takes it with
+	 * AsyncAccept(), which is thread safe.
+	 */
+	class AsyncListener
+	{
+	public:
+
+		explicit AsyncListener(TcpServer& l_server) :
+			_closed(false)
+		{
+			l_server.SetOpenHandler([this](Connection& l_connection) { Opened(l_connection); });
+
+			l_server.SetReceiveHandler([](Connection& l_connection, const char* l_data, std::size_t l_length)
+									   {
+										   if (auto stream = Find(l_connection))
+											   stream->Received(l_data, l_length);
+									   });
+
+			l_server.SetWritableHandler([](Connection& l_connection)
+										{
+											if (auto stream = Find(l_connection))
+												stream->Writable();
+										});
+
+			l_server.SetCloseHandler([](Connection& l_connection)
+									 {
+										 auto stream = Find(l_connection);
+										 if (stream == nullptr)
+											 return;
+
+										 l_connection.SetUserData(nullptr);
+
+										 // The last reference may be a waiting reader's, so hold one until it returned.
+										 auto self = std::move(stream->_self);
+										 stream->Closed();
+									 });
+		}
+
+		AsyncListener(const AsyncListener&) = delete;
+		AsyncListener& operator = (const AsyncListener&) = delete;
+
+		/**
+		 * @brief Stops handing out clients: pending and future AsyncAccept()s
+		 * return nullptr, and clients nobody accepted yet are closed. Thread safe.
+		 */
+		void Close()
+		{
+			std::deque<std::shared_ptr<AsyncStream>> pending;
+			std::deque<Accepting*> waiting;
+			{
+				std::lock_guard<std::mutex> lock{_mutex};
+				_closed = true;
+				std::swap(pending, _pending);
+				std::swap(waiting, _waiting);
+			}
+
+			for (auto& stream : pending)
+			{
+				stream->GetReactor().Post([stream]() { stream->Close(); });
+			}
+
+			for (auto accepting : waiting)
+			{
+				accepting->Coroutine.resume();
+			}
+		}
+
+	private:
+
+		friend struct AcceptAwaiter;
+
+		/// A coroutine waiting in AsyncAccept(), and where its stream goes.
+		struct Accepting
+		{
+			std::coroutine_handle<>			Coroutine;
+			std::shared_ptr<AsyncStream>	Stream;
+		};
+
+		static AsyncStream* Find(Connection& l_connection)
+		{
+			return static_cast<AsyncStream*>(l_connection.UserData());
+		}
+
+		void Opened(Connection& l_connection)
+		{
+			auto stream = std::make_shared<AsyncStream>(l_connection);
+			stream->_self = stream;
+			l_connection.SetUserData(stream.get());
+
+			Accepting* accepting = nullptr;
+			{
+				std::unique_lock<std::mutex> lock{_mutex};
+				if (_closed)
+				{
+					lock.unlock();
+					l_connection.Close();
+					return;
+				}
+
+				if (_waiting.empty())
+				{
+					_pending.push_back(std::move(stream));
+					return;
+				}
+
+				accepting = _waiting.front();
+				_waiting.pop_front();
+			}
+
+			// Resumed right here, on the thread of the reactor that accepted the client.
+			accepting->Stream = std::move(stream);
+			accepting->Coroutine.resume();
+		}
+
+		std::mutex									_mutex;
+		bool										_closed;
+		std::deque<std::shared_ptr<AsyncStream>>	_pending;
+		std::deque<Accepting*>						_waiting;
+	};
+
+	struct ReadAwaiter
+	{
+		AsyncStream&	Stream;
+		char*			Buffer;
+		std::size_t		Size;
+
+		bool await_ready() const noexcept
+		{
+			return Size == 0 || Stream.Available() > 0 || !Stream.Open();
+		}
+
+		void await_suspend(std::coroutine_handle<> l_coroutine) noexcept
+		{
+			Stream._reader = l_coroutine;
+		}
+
+		std::size_t await_resume()
+		{
+			return Stream.Take(Buffer, Size);
+		}
+	};
+
+	struct WriteAwaiter
+	{
+		AsyncStream&	Stream;
+		bool			Queued;
+
+		bool await_ready() const noexcept
+		{
+			return !Queued || !Stream.Open() || Stream.GetConnection()->Writable();
+		}
+
+		void await_suspend(std::coroutine_handle<> l_coroutine) noexcept
+		{
+			Stream._writer = l_coroutine;
+		}
+
+		bool await_resume() const noexcept
+		{
+			return Queued && Stream.Open();
+		}
+	};
+
+	struct AcceptAwaiter
+	{
+		AsyncListener&					Listener;
+		AsyncListener::Accepting		State;
+
+		bool await_ready()
+		{
+			std::lock_guard<std::mutex> lock{Listener._mutex};
+			if (Listener._closed || Listener._pending.empty())
+				return Listener._closed;
+
+			State.Stream = std::move(Listener._pending.front());
+			Listener._pending.pop_front();
+			return true;
+		}
+
+		bool await_suspend(std::coroutine_handle<> l_coroutine)
+		{
+			std::lock_guard<std::mutex> lock{Listener._mutex};
+
+			// A client may have arrived, or the listener closed, since await_ready().
+			if (Listener._closed)
+				return false;
+
+			if (!Listener._pending.empty())
+			{
+				State.Stream = std::move(Listener._pending.front());
+				Listener._pending.pop_front();
+				return false;
+			}
+
+			State.Coroutine = l_coroutine;
+			Listener._waiting.push_back(&State);
+			return true;
+		}
+
+		std::shared_ptr<AsyncStream> await_resume()
+		{
+			return std::move(State.Stream);
+		}
+	};
+
+	/**
+	 * @brief Reads up to l_size received bytes into l_buffer, waiting for some if there are none.
+	 * Awaiting it yields the number of bytes read, 0 once the stream closed and was read to the end.
+	 */
+	inline ReadAwaiter AsyncRead(AsyncStream& l_stream, char* l_buffer, std::size_t l_size)
+	{
+		return ReadAwaiter{l_stream, l_buffer, l_size};
+	}
+
+	/**
+	 * @brief Queues l_length bytes for the client, then waits while its
+	 * output is over the high watermark, see Connection::Writable().
+	 * Awaiting it yields false if the stream closed first.
+	 */
+	inline WriteAwaiter AsyncWrite(AsyncStream& l_stream, const char* l_data, std::size_t l_length)
+	{
+		auto connection = l_stream.GetConnection();
+		auto queued = connection != nullptr;
+
+		if (queued)
+			connection->Send(l_data, l_length);
+
+		return WriteAwaiter{l_stream, queued};
+	}
+
+	/**
+	 * @brief Waits for the next client of l_listener.
+	 * Awaiting it yields the client's stream, or nullptr once the listener
+	 * closed. The coroutine resumes on the thread of whichever reactor
+	 * accepted the client, unless one was already queued.
+	 */
+	inline AcceptAwaiter AsyncAccept(AsyncListener& l_listener)
+	{
+		return AcceptAwaiter{l_listener, {}};
+	}
+
+	/**
+	 * @brief Suspends the coroutine for l_milliseconds on l_reactor's timer wheel.
+	 * Must be awaited on the reactor thread. A coroutine still sleeping when
+	 * the reactor stops is never resumed, and its frame leaks.
+	 */
+	inline auto SleepFor(Reactor& l_reactor, UInt64 l_milliseconds)
+	{
+		struct Awaiter
+		{
+			Reactor&	Target;
+			UInt64		Delay;
+
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> l_coroutine) const
+			{
+				Target.Schedule(Delay, [l_coroutine]() { l_coroutine.resume(); });
+			}
+
+			void await_resume() const noexcept
+			{
+
+			}
+		};
+
+		return Awaiter{l_reactor, l_milliseconds};
+	}
+
+} // namespace net
+
+#endif // GIGGLE_HAVE_COROUTINES
+
+#endif //EXPORT_GIGGLE_ASYNCSTREAM_HPP
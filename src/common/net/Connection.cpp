@@ -0,0 +1,422 @@
+/*
+* export-giggle
+* Connection.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "Connection.hpp"
+#include "Reactor.hpp"
+
+#include <arpa/inet.h>
+#include <iostream>
+#include <new>
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+
+Connection::Connection(Reactor& l_reactor, SocketFileDescriptor l_descriptor, const SocketAddress& l_address,
+					   const Handlers& l_handlers):
+	_reactor(l_reactor),
+	_id(INVALID_CONNECTION),
+	_descriptor(l_descriptor),
+	_ipAddress(),
+	_port(ntohs(l_address.sin_port)),
+	_state(State::Open),
+	_authenticated(false),
+	_userData(nullptr),
+	_handlers(l_handlers),
+	_decoder(),
+	_output(),
+	_lowWatermark(DEFAULT_LOW_WATERMARK),
+	_highWatermark(DEFAULT_HIGH_WATERMARK),
+	_congested(false),
+	_readPaused(false),
+	_flushScheduled(false),
+	_timer([this]() { OnTimeout(); }),
+	_lastActivity(l_reactor._timers->Now()),
+	_idleTimeout(0),
+	_readDeadline(0),
+	_writeDeadline(0)
+{
+	char address[INET_ADDRSTRLEN];
+	if (inet_ntop(AF_INET, &l_address.sin_addr, address, sizeof(address)) != nullptr)
+	{
+		_ipAddress = address;
+	}
+}
+
+Connection::~Connection()
+{
+	if (_descriptor >= 0)
+	{
+		close(_descriptor);
+	}
+}
+
+void Connection::Close()
+{
+	if (_state == State::Closed)
+		return;
+
+	_state = State::Closed;
+
+	if (_handlers.OnClose)
+		_handlers.OnClose(*this);
+
+	_reactor._timers->Cancel(_timer);
+	_reactor.Unwatch(*this);
+	_reactor.RemoveClient(*this);
+}
+
+bool Connection::Send(memory::Buffer<char> l_segment)
+{
+	if (_state != State::Open)
+		return false;
+
+	_output.Push(std::move(l_segment));
+	return Queue();
+}
+
+bool Connection::Send(std::vector<memory::Buffer<char>> l_segments)
+{
+	if (_state != State::Open)
+		return false;
+
+	for (auto& segment : l_segments)
+	{
+		_output.Push(std::move(segment));
+	}
+	return Queue();
+}
+
+bool Connection::Send(const char* l_data, std::size_t l_length)
+{
+	if (_state != State::Open)
+		return false;
+
+	_output.Push(memory::Buffer<char>(l_data, l_length));
+	return Queue();
+}
+
+bool Connection::Send(const memory::BufferChain& l_chain)
+{
+	if (_state != State::Open)
+		return false;
+
+	_output.Push(l_chain);
+	return Queue();
+}
+
+bool Connection::SendFrame(memory::Buffer<char> l_payload)
+{
+	// Larger payloads would not fit the header, or the limit of a decoding peer.
+	if (_state != State::Open || l_payload.Size() > DEFAULT_MAX_FRAME_SIZE)
+		return false;
+
+	memory::Buffer<char> header(FrameDecoder::HEADER_SIZE);
+	FrameDecoder::EncodeHeader(header.Begin(), static_cast<UInt32>(l_payload.Size()));
+
+	_output.Push(std::move(header));
+	_output.Push(std::move(l_payload));
+	return Queue();
+}
+
+bool Connection::SendFile(const std::string& l_path, UInt64 l_offset, std::size_t l_length)
+{
+	if (_state != State::Open)
+		return false;
+
+	return SendFile(_reactor._files->Open(l_path), l_offset, l_length);
+}
+
+bool Connection::SendFile(std::shared_ptr<const File> l_file, UInt64 l_offset, std::size_t l_length)
+{
+	if (_state != State::Open || l_file == nullptr)
+		return false;
+
+	auto available = l_offset < l_file->Size() ? l_file->Size() - l_offset : 0;
+	if (l_length == 0 || l_length > available)
+		l_length = static_cast<std::size_t>(available);
+
+	_output.Push(FileRegion{std::move(l_file), l_offset, l_length});
+	return Queue();
+}
+
+bool Connection::Writable() const
+{
+	return !_congested;
+}
+
+void Connection::PauseReading()
+{
+	_readPaused = true;
+}
+
+void Connection::ResumeReading()
+{
+	if (!_readPaused)
+		return;
+
+	_readPaused = false;
+
+	if (_state == State::Open && Readable())
+		_reactor.Resume(*this);
+}
+
+bool Connection::Readable() const
+{
+	return !_congested && !_readPaused;
+}
+
+std::size_t Connection::Queued() const
+{
+	return _output.Bytes();
+}
+
+bool Connection::Idle() const
+{
+	return _output.Empty() && _decoder.Pending() == 0;
+}
+
+void Connection::SetWatermarks(std::size_t l_low, std::size_t l_high)
+{
+	_lowWatermark = l_low;
+	_highWatermark = l_high;
+}
+
+bool Connection::Queue()
+{
+	if (_output.Bytes() > _highWatermark)
+		_congested = true;
+
+	if (!_flushScheduled)
+	{
+		_flushScheduled = true;
+		_reactor.ScheduleFlush(*this);
+	}
+
+	return !_congested;
+}
+
+void Connection::Receive(const char* l_data, std::size_t l_length)
+{
+	OnActivity();
+	_readDeadline = 0;
+
+	if (_handlers.OnReceive)
+		_handlers.OnReceive(*this, l_data, l_length);
+
+	if (!_handlers.OnFrame || _state != State::Open)
+		return;
+
+	bool valid;
+	try
+	{
+		valid = _decoder.Feed(l_data, l_length, [this](const Frame& l_frame)
+		{
+			_handlers.OnFrame(*this, l_frame);
+			return _state == State::Open;
+		});
+	}
+	catch (std::bad_alloc&)
+	{
+		std::cerr << "Out of memory reassembling a frame from " << _ipAddress << ":" << _port << "." << std::endl;
+		Close();
+		return;
+	}
+
+	if (!valid)
+	{
+		std::cerr << "Frame from " << _ipAddress << ":" << _port << " exceeds the maximum frame size." << std::endl;
+		Close();
+	}
+}
+
+char* Connection::ReceiveSpace(std::size_t& l_size)
+{
+	if (!_handlers.OnFrame)
+		return nullptr;
+
+	try
+	{
+		return _decoder.PendingSpace(l_size);
+	}
+	catch (std::bad_alloc&)
+	{
+		std::cerr << "Out of memory reassembling a frame from " << _ipAddress << ":" << _port << "." << std::endl;
+		Close();
+		return nullptr;
+	}
+}
+
+void Connection::ReceivedInPlace(const char* l_data, std::size_t l_length)
+{
+	OnActivity();
+	_readDeadline = 0;
+
+	if (_handlers.OnReceive)
+		_handlers.OnReceive(*this, l_data, l_length);
+
+	_decoder.Commit(l_length, [this](const Frame& l_frame)
+	{
+		if (_state == State::Open)
+			_handlers.OnFrame(*this, l_frame);
+	});
+}
+
+void Connection::OnEvents(UInt32 l_events)
+{
+	_reactor.OnReady(*this, l_events);
+}
+
+std::size_t Connection::Gather(iovec* l_vectors, std::size_t l_max) const
+{
+	return _output.Gather(l_vectors, l_max);
+}
+
+const File* Connection::GatherFile(UInt64& l_offset, std::size_t& l_length) const
+{
+	return _output.GatherFile(l_offset, l_length);
+}
+
+void Connection::Sent(std::size_t l_length)
+{
+	_output.Consume(l_length);
+	OnActivity();
+
+	if (_output.Empty())
+		_writeDeadline = 0;
+
+	if (_congested && _output.Bytes() <= _lowWatermark && _state == State::Open)
+	{
+		_congested = false;
+
+		if (_handlers.OnWritable)
+			_handlers.OnWritable(*this);
+
+		if (_state == State::Open && Readable())
+			_reactor.Resume(*this);
+	}
+}
+
+void Connection::SetIdleTimeout(UInt32 l_milliseconds)
+{
+	_idleTimeout = l_milliseconds;
+	UpdateTimer();
+}
+
+void Connection::SetReadDeadline(UInt32 l_milliseconds)
+{
+	_readDeadline = l_milliseconds > 0 ? _reactor._timers->Now() + l_milliseconds : 0;
+	UpdateTimer();
+}
+
+void Connection::SetWriteDeadline(UInt32 l_milliseconds)
+{
+	// Armed even with nothing queued yet, so it covers the sends that follow.
+	_writeDeadline = l_milliseconds > 0 ? _reactor._timers->Now() + l_milliseconds : 0;
+	UpdateTimer();
+}
+
+void Connection::OnActivity()
+{
+	_lastActivity = _reactor._timers->Now();
+}
+
+void Connection::OnTimeout()
+{
+	auto now = _reactor._timers->Now();
+
+	auto expired = (_readDeadline > 0 && now >= _readDeadline) ||
+				   (_writeDeadline > 0 && now >= _writeDeadline && !_output.Empty()) ||
+				   (_idleTimeout > 0 && now >= _lastActivity + _idleTimeout);
+
+	// A write deadline passing with nothing left to write was met.
+	if (_writeDeadline > 0 && now >= _writeDeadline)
+		_writeDeadline = 0;
+
+	if (expired)
+		Close();
+	else
+		UpdateTimer();
+}
+
+void Connection::UpdateTimer()
+{
+	if (_state != State::Open)
+		return;
+
+	UInt64 next = 0;
+	for (auto deadline : {_idleTimeout > 0 ? _lastActivity + _idleTimeout : 0, _readDeadline, _writeDeadline})
+	{
+		if (deadline > 0 && (next == 0 || deadline < next))
+			next = deadline;
+	}
+
+	if (next == 0)
+		_reactor._timers->Cancel(_timer);
+	else if (!_timer.Armed() || next < _timer.Expiry())
+		_reactor._timers->ArmAt(_timer, next);
+}
+
+ConnectionId Connection::Id() const
+{
+	return _id;
+}
+
+SocketFileDescriptor Connection::Descriptor() const
+{
+	return _descriptor;
+}
+
+const std::string& Connection::IPAddress() const
+{
+	return _ipAddress;
+}
+
+UInt16 Connection::Port() const
+{
+	return _port;
+}
+
+Connection::State Connection::GetState() const
+{
+	return _state;
+}
+
+bool Connection::Authenticated() const
+{
+	return _authenticated;
+}
+
+void Connection::SetAuthenticated(bool l_authenticated)
+{
+	_authenticated = l_authenticated;
+}
+
+Reactor& Connection::GetReactor() const
+{
+	return _reactor;
+}
+
+void* Connection::UserData() const
+{
+	return _userData;
+}
+
+void Connection::SetUserData(void* l_data)
+{
+	_userData = l_data;
+}
@@ -0,0 +1,357 @@
+/*
+* export-giggle
+* Connection.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_CONNECTION_HPP
+#define EXPORT_GIGGLE_CONNECTION_HPP
+
+#include "Net.hpp"
+#include "EventLoop.hpp"
+#include "FrameDecoder.hpp"
+#include "OutputQueue.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace giggle::common::net
+{
+
+	class Reactor;
+
+	/**
+	 * @brief The state of a single client connection served by a Reactor.
+	 *
+	 * A connection only holds its descriptor, its peer address and a few
+	 * flags while idle. The I/O itself is performed by the owning reactor,
+	 * which hands received bytes over through Receive() and writes out the
+	 * OutputQueue filled by Send(); that keeps the connection independent
+	 * of the backend used to wait for them.
+	 *
+	 * Sends are queued and written once per reactor iteration, gathering
+	 * every queued segment into as few writev calls as possible. Once the
+	 * queue holds more than the high watermark the connection stops being
+	 * Writable(): Send() returns false to tell producers to hold off and
+	 * the reactor stops reading from the peer, so a client that does not
+	 * read its responses cannot make the server buffer without bound.
+	 * When the peer has read enough for the queue to drop below the low
+	 * watermark, reading resumes and the writable handler is invoked.
+	 * Consumers that buffer received bytes themselves can likewise hold
+	 * reading off with PauseReading().
+	 *
+	 * All methods must be called from the reactor thread.
+	 */
+	class Connection : public EventHandler
+	{
+	public:
+
+		enum class State
+		{
+			Open,		/// Watched by the reactor and reading.
+			Closed		/// No longer watched; the descriptor is shut down.
+		};
+
+		/**
+		 * Invoked with every chunk of bytes read from the socket.
+		 * The data points into a buffer owned by the reactor and is
+		 * only valid for the duration of the call.
+		 */
+		typedef std::function<void(Connection&, const char*, std::size_t)> ReceiveHandler;
+
+		/**
+		 * Invoked with every complete length-prefixed frame. The frame
+		 * is a view into reactor or connection owned memory and is only
+		 * valid for the duration of the call.
+		 */
+		typedef std::function<void(Connection&, const Frame&)> FrameHandler;
+
+		/**
+		 * Invoked once a connection whose output queue went over the
+		 * high watermark has drained below the low watermark.
+		 */
+		typedef std::function<void(Connection&)> WritableHandler;
+
+		/**
+		 * Invoked once a connection was accepted and is being read from,
+		 * and once it closed, whatever the reason; it can no longer send
+		 * by then.
+		 */
+		typedef std::function<void(Connection&)> OpenHandler;
+		typedef std::function<void(Connection&)> CloseHandler;
+
+		/**
+		 * The handlers shared by every connection of a server.
+		 * Frames are only decoded when OnFrame is set.
+		 */
+		struct Handlers
+		{
+			ReceiveHandler OnReceive;
+			FrameHandler OnFrame;
+			WritableHandler OnWritable;
+			OpenHandler OnOpen;
+			CloseHandler OnClose;
+		};
+
+		/**
+		 * @brief Creates the connection for an accepted, non-blocking descriptor.
+		 * The connection takes ownership of the descriptor.
+		 * @param l_reactor The reactor serving this connection.
+		 * @param l_descriptor The accepted descriptor.
+		 * @param l_address The peer address returned by accept.
+		 * @param l_handlers The handlers for received data, owned by the server.
+		 */
+		Connection(Reactor& l_reactor, SocketFileDescriptor l_descriptor, const SocketAddress& l_address,
+				   const Handlers& l_handlers);
+
+		/**
+		 * @brief Destroys the connection, closing the descriptor.
+		 */
+		~Connection() override;
+
+		Connection(const Connection&) = delete;
+		Connection& operator = (const Connection&) = delete;
+
+		/**
+		 * @brief Stops I/O, shuts the descriptor down and hands the
+		 * connection back to the reactor for destruction. Data still
+		 * queued for writing is discarded.
+		 * Calling Close on an already closed connection does nothing.
+		 */
+		void Close();
+
+		/**
+		 * @brief Queues a segment for writing, without copying it.
+		 * @return false if the connection is closed, in which case nothing
+		 * is queued, or if the output queue is now over the high watermark
+		 * and the caller should wait for the writable handler.
+		 */
+		bool Send(memory::Buffer<char> l_segment);
+
+		/**
+		 * @brief Queues several segments, e.g. a header and a body, to be
+		 * written together.
+		 * @return See Send(Buffer).
+		 */
+		bool Send(std::vector<memory::Buffer<char>> l_segments);
+
+		/**
+		 * @brief Queues a copy of the given bytes.
+		 * @return See Send(Buffer).
+		 */
+		bool Send(const char* l_data, std::size_t l_length);
+
+		/**
+		 * @brief Queues the bytes of a chain, sharing its blocks; the chain
+		 * may be sent to other connections too.
+		 * @return See Send(Buffer).
+		 */
+		bool Send(const memory::BufferChain& l_chain);
+
+		/**
+		 * @brief Queues a length-prefixed frame; the header goes in its own
+		 * segment so the payload is not copied.
+		 * @return See Send(Buffer); also false, with nothing queued, for
+		 * payloads over DEFAULT_MAX_FRAME_SIZE, which peers would reject.
+		 */
+		bool SendFrame(memory::Buffer<char> l_payload);
+
+		/**
+		 * @brief Queues a region of a file, which the kernel copies to the
+		 * socket with sendfile() without it ever passing through user space.
+		 * The file is opened through the reactor's FileCache. The region is
+		 * subject to the same ordering and watermarks as queued buffers.
+		 * @throws SystemException if the file cannot be opened.
+		 * @param l_path The path of the file.
+		 * @param l_offset Where the region starts.
+		 * @param l_length The length of the region, or 0 for the rest of the file.
+		 * The region is clamped to the size of the file.
+		 * @return See Send(Buffer).
+		 */
+		bool SendFile(const std::string& l_path, UInt64 l_offset = 0, std::size_t l_length = 0);
+
+		/**
+		 * @brief Queues a region of an already open file, see SendFile(path).
+		 * @return See Send(Buffer).
+		 */
+		bool SendFile(std::shared_ptr<const File> l_file, UInt64 l_offset = 0, std::size_t l_length = 0);
+
+		/**
+		 * @brief Returns false from the moment the output queue goes over the
+		 * high watermark until it drains below the low watermark.
+		 */
+		bool Writable() const;
+
+		/**
+		 * @brief Stops the reactor from reading the peer until ResumeReading(),
+		 * for consumers that fall behind the bytes handed to them.
+		 */
+		void PauseReading();
+
+		/**
+		 * @brief Lets the reactor read again; data that arrived meanwhile is handed over.
+		 */
+		void ResumeReading();
+
+		/**
+		 * @brief Returns true while the reactor may read the peer: the
+		 * connection is Writable() and reading is not paused.
+		 */
+		bool Readable() const;
+
+		/**
+		 * @brief Returns the number of bytes waiting to be written.
+		 */
+		std::size_t Queued() const;
+
+		/**
+		 * @brief Returns true if nothing is waiting to be written and no frame
+		 * is partially received, i.e. closing now loses no request or response.
+		 */
+		bool Idle() const;
+
+		/**
+		 * @brief Sets the output queue watermarks, in bytes.
+		 */
+		void SetWatermarks(std::size_t l_low, std::size_t l_high);
+
+		/**
+		 * @brief Closes the connection once nothing was received or written
+		 * for the given time. Activity only stamps a time; the timer is
+		 * re-armed lazily when it fires.
+		 * @param l_milliseconds The timeout, or 0 to disable it.
+		 */
+		void SetIdleTimeout(UInt32 l_milliseconds);
+
+		/**
+		 * @brief Closes the connection unless data is received within the given time.
+		 * @param l_milliseconds The deadline from now, or 0 to clear it.
+		 */
+		void SetReadDeadline(UInt32 l_milliseconds);
+
+		/**
+		 * @brief Closes the connection unless everything queued so far, and
+		 * queued until then, is written within the given time. Nothing queued
+		 * when it passes meets it, and draining the output clears it.
+		 * @param l_milliseconds The deadline from now, or 0 to clear it.
+		 */
+		void SetWriteDeadline(UInt32 l_milliseconds);
+
+		/**
+		 * @brief Called by the reactor with bytes read from the socket.
+		 */
+		void Receive(const char* l_data, std::size_t l_length);
+
+		/**
+		 * @brief Returns where the reactor may read the rest of a large,
+		 * partially received frame directly, skipping the receive buffer.
+		 * Closes the connection if the space cannot be allocated.
+		 * @param l_size Receives the number of bytes that may be read there.
+		 * @return The write position, or nullptr to read into the receive buffer.
+		 */
+		char* ReceiveSpace(std::size_t& l_size);
+
+		/**
+		 * @brief Called by the reactor after reading l_length bytes at ReceiveSpace().
+		 */
+		void ReceivedInPlace(const char* l_data, std::size_t l_length);
+
+		/**
+		 * @brief Called by the reactor to describe the queued output as iovecs.
+		 * @return The number of iovecs filled in.
+		 */
+		std::size_t Gather(iovec* l_vectors, std::size_t l_max) const;
+
+		/**
+		 * @brief Called by the reactor to describe a file region at the head of the output queue.
+		 * @return The file, or nullptr if the queue starts with buffers.
+		 */
+		const File* GatherFile(UInt64& l_offset, std::size_t& l_length) const;
+
+		/**
+		 * @brief Called by the reactor after l_length queued bytes were written.
+		 */
+		void Sent(std::size_t l_length);
+
+		/**
+		 * @brief Forwards readiness events to the reactor.
+		 */
+		void OnEvents(UInt32 l_events) override;
+
+		/**
+		 * @brief Returns the id the server knows this connection by, which
+		 * unlike the descriptor is never reused while the server runs.
+		 */
+		ConnectionId Id() const;
+
+		SocketFileDescriptor Descriptor() const;
+		const std::string& IPAddress() const;
+		UInt16 Port() const;
+		State GetState() const;
+
+		bool Authenticated() const;
+		void SetAuthenticated(bool l_authenticated);
+
+		/**
+		 * @brief Returns the reactor serving this connection.
+		 */
+		Reactor& GetReactor() const;
+
+		/**
+		 * @brief Returns the pointer the handlers attached to this connection, nullptr by default.
+		 */
+		void* UserData() const;
+		void SetUserData(void* l_data);
+
+	private:
+
+		friend class Reactor;
+
+		bool Queue();
+		void OnActivity();
+		void OnTimeout();
+		void UpdateTimer();
+
+		Reactor&				_reactor;
+		ConnectionId			_id;
+		SocketFileDescriptor	_descriptor;
+		std::string				_ipAddress;
+		UInt16					_port;
+		State					_state;
+		bool					_authenticated;
+		void*					_userData;
+
+		const Handlers&			_handlers;
+		FrameDecoder			_decoder;
+
+		OutputQueue				_output;
+		std::size_t				_lowWatermark;
+		std::size_t				_highWatermark;
+		bool					_congested;
+		bool					_readPaused;
+		bool					_flushScheduled;
+
+		Timer					_timer;
+		UInt64					_lastActivity;
+		UInt32					_idleTimeout;
+		UInt64					_readDeadline;
+		UInt64					_writeDeadline;
+	};
+
+} // namespace net
+
+#endif //EXPORT_GIGGLE_CONNECTION_HPP
@@ -0,0 +1,167 @@
+/*
+* export-giggle
+* ConnectionTable.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "ConnectionTable.hpp"
+#include "Connection.hpp"
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+
+/*
+ * Id layout, from the most significant bits down: 32 bits of slot
+ * generation, 24 bits of slot index and 8 bits of reactor index.
+ * Occupied generations are odd, so a valid id is never 0.
+ */
+
+ConnectionTable::ConnectionTable(UInt32 l_capacity, UInt32 l_reactor):
+	_capacity(std::min<UInt32>(l_capacity, UInt32(1) << SLOT_BITS)),
+	_reactor(l_reactor & ((1 << REACTOR_BITS) - 1)),
+	_chunks(),
+	_chunkCount((_capacity + CHUNK_SIZE - 1) / CHUNK_SIZE),
+	_used(0),
+	_freeHead(NO_SLOT),
+	_size(0)
+{
+	_chunks.reset(new std::atomic<Slot*>[_chunkCount]);
+
+	for (UInt32 i = 0; i < _chunkCount; ++i)
+	{
+		_chunks[i].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+ConnectionTable::~ConnectionTable()
+{
+	ForEach([](Connection& l_connection)
+			{
+				delete &l_connection;
+			});
+
+	for (UInt32 i = 0; i < _chunkCount; ++i)
+	{
+		delete [] _chunks[i].load(std::memory_order_relaxed);
+	}
+}
+
+UInt32 ConnectionTable::ReactorOf(ConnectionId l_id)
+{
+	return static_cast<UInt32>(l_id & ((1 << REACTOR_BITS) - 1));
+}
+
+ConnectionId ConnectionTable::Insert(std::unique_ptr<Connection> l_connection)
+{
+	UInt32 index;
+
+	if (_freeHead != NO_SLOT)
+	{
+		index = _freeHead;
+		_freeHead = At(index)->NextFree;
+	}
+	else if (_used < _capacity)
+	{
+		index = _used;
+
+		auto chunk = index >> CHUNK_BITS;
+		if (_chunks[chunk].load(std::memory_order_relaxed) == nullptr)
+		{
+			_chunks[chunk].store(new Slot[CHUNK_SIZE], std::memory_order_release);
+		}
+
+		++_used;
+	}
+	else
+	{
+		return INVALID_CONNECTION;
+	}
+
+	auto slot = At(index);
+	slot->Pointer = l_connection.release();
+	slot->NextFree = NO_SLOT;
+
+	auto generation = slot->Generation.load(std::memory_order_relaxed) + 1;
+	slot->Generation.store(generation, std::memory_order_release);
+	_size.fetch_add(1, std::memory_order_relaxed);
+
+	return (static_cast<UInt64>(generation) << 32) |
+		   (static_cast<UInt64>(index) << REACTOR_BITS) |
+		   _reactor;
+}
+
+std::unique_ptr<Connection> ConnectionTable::Remove(ConnectionId l_id)
+{
+	auto slot = Locate(l_id);
+	if (slot == nullptr)
+		return nullptr;
+
+	std::unique_ptr<Connection> connection(slot->Pointer);
+	slot->Pointer = nullptr;
+	slot->Generation.store(slot->Generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+	auto index = static_cast<UInt32>((l_id >> REACTOR_BITS) & ((1 << SLOT_BITS) - 1));
+	slot->NextFree = _freeHead;
+	_freeHead = index;
+
+	_size.fetch_sub(1, std::memory_order_relaxed);
+	return connection;
+}
+
+Connection* ConnectionTable::Find(ConnectionId l_id) const
+{
+	auto slot = Locate(l_id);
+	return slot == nullptr ? nullptr : slot->Pointer;
+}
+
+bool ConnectionTable::Contains(ConnectionId l_id) const
+{
+	return Locate(l_id) != nullptr;
+}
+
+UInt32 ConnectionTable::Size() const
+{
+	return _size.load(std::memory_order_relaxed);
+}
+
+UInt32 ConnectionTable::Capacity() const
+{
+	return _capacity;
+}
+
+ConnectionTable::Slot* ConnectionTable::At(UInt32 l_slot) const
+{
+	return &_chunks[l_slot >> CHUNK_BITS].load(std::memory_order_relaxed)[l_slot & CHUNK_MASK];
+}
+
+ConnectionTable::Slot* ConnectionTable::Locate(ConnectionId l_id) const
+{
+	if (ReactorOf(l_id) != _reactor)
+		return nullptr;
+
+	auto index = static_cast<UInt32>((l_id >> REACTOR_BITS) & ((1 << SLOT_BITS) - 1));
+	if (index >= _capacity)
+		return nullptr;
+
+	auto chunk = _chunks[index >> CHUNK_BITS].load(std::memory_order_acquire);
+	if (chunk == nullptr)
+		return nullptr;
+
+	auto& slot = chunk[index & CHUNK_MASK];
+	if (slot.Generation.load(std::memory_order_acquire) != static_cast<UInt32>(l_id >> 32))
+		return nullptr;
+
+	return &slot;
+}
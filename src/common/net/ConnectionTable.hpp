@@ -0,0 +1,160 @@
+/*
+* export-giggle
+* ConnectionTable.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_CONNECTIONTABLE_HPP
+#define EXPORT_GIGGLE_CONNECTIONTABLE_HPP
+
+#include "Net.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace giggle::common::net
+{
+
+	class Connection;
+
+	/**
+	 * @brief The connections of a reactor, stored in a slot array.
+	 *
+	 * Every connection is identified by a ConnectionId made of its slot,
+	 * the generation of that slot and the index of the owning reactor.
+	 * A slot's generation is odd while occupied and bumped on every
+	 * insert and remove, so an id stops matching the moment its
+	 * connection is removed and is never mistaken for a later
+	 * connection reusing the slot.
+	 *
+	 * Slots are allocated in fixed size chunks that are never moved or
+	 * freed while the table lives, and freed slots are reused first, so
+	 * insert and remove are O(1) and iteration walks a few dense arrays.
+	 *
+	 * Insert, Remove, Find and ForEach must be called from the owning
+	 * reactor thread. Contains only reads atomics and can be called from
+	 * any thread without locking; its answer is of course only a hint
+	 * by the time the caller acts on it.
+	 */
+	class ConnectionTable
+	{
+	public:
+
+		/**
+		 * @brief Creates the table.
+		 * @param l_capacity The maximum number of connections.
+		 * @param l_reactor The index of the owning reactor, encoded in every id.
+		 */
+		ConnectionTable(UInt32 l_capacity, UInt32 l_reactor);
+		~ConnectionTable();
+
+		ConnectionTable(const ConnectionTable&) = delete;
+		ConnectionTable& operator = (const ConnectionTable&) = delete;
+
+		/**
+		 * @brief Returns the reactor index encoded in an id.
+		 */
+		static UInt32 ReactorOf(ConnectionId l_id);
+
+		/**
+		 * @brief Takes ownership of a connection.
+		 * @return Its id, or INVALID_CONNECTION if the table is full.
+		 */
+		ConnectionId Insert(std::unique_ptr<Connection> l_connection);
+
+		/**
+		 * @brief Gives up ownership of a connection.
+		 * @return The connection, or nullptr if the id does not match.
+		 */
+		std::unique_ptr<Connection> Remove(ConnectionId l_id);
+
+		/**
+		 * @brief Returns the connection with the given id, or nullptr.
+		 */
+		Connection* Find(ConnectionId l_id) const;
+
+		/**
+		 * @brief Returns true if the id belongs to a connection in the table. Thread safe.
+		 */
+		bool Contains(ConnectionId l_id) const;
+
+		/**
+		 * @brief Invokes l_callback(Connection&) for every connection. The
+		 * callback must not insert or remove connections.
+		 */
+		template <class F>
+		void ForEach(F&& l_callback) const;
+
+		/**
+		 * @brief Returns the number of connections. Thread safe.
+		 */
+		UInt32 Size() const;
+
+		UInt32 Capacity() const;
+
+	private:
+
+		enum
+		{
+			CHUNK_BITS = 10,
+			CHUNK_SIZE = 1 << CHUNK_BITS,
+			CHUNK_MASK = CHUNK_SIZE - 1,
+			SLOT_BITS = 24,
+			REACTOR_BITS = 8
+		};
+
+		static const UInt32 NO_SLOT = 0xFFFFFFFF;
+
+		struct Slot
+		{
+			std::atomic<UInt32> Generation{0};
+			UInt32 NextFree = NO_SLOT;
+			Connection* Pointer = nullptr;
+		};
+
+		Slot* At(UInt32 l_slot) const;
+		Slot* Locate(ConnectionId l_id) const;
+
+		const UInt32						_capacity;
+		const UInt32						_reactor;
+
+		std::unique_ptr<std::atomic<Slot*>[]>	_chunks;
+		UInt32								_chunkCount;
+
+		UInt32								_used;
+		UInt32								_freeHead;
+		std::atomic<UInt32>					_size;
+	};
+
+	template <class F>
+	void ConnectionTable::ForEach(F&& l_callback) const
+	{
+		for (UInt32 chunk = 0; chunk * CHUNK_SIZE < _used; ++chunk)
+		{
+			auto slots = _chunks[chunk].load(std::memory_order_relaxed);
+			auto end = std::min<UInt32>(CHUNK_SIZE, _used - chunk * CHUNK_SIZE);
+
+			for (UInt32 i = 0; i < end; ++i)
+			{
+				if (slots[i].Generation.load(std::memory_order_relaxed) & 1)
+					l_callback(*slots[i].Pointer);
+			}
+		}
+	}
+
+} // namespace net
+
+#endif //EXPORT_GIGGLE_CONNECTIONTABLE_HPP
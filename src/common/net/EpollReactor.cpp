@@ -0,0 +1,258 @@
+/*
+* export-giggle
+* EpollReactor.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "EpollReactor.hpp"
+
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <climits>
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+
+EpollReactor::EpollReactor(UInt32 l_index, UInt32 l_port, UInt32 l_maxConnections, bool l_reusePort,
+						   const Connection::Handlers& l_handlers):
+	Reactor(l_index, l_port, l_maxConnections, l_reusePort, l_handlers),
+	_eventLoop(new EventLoop(DEFAULT_MAX_EVENTS, _timers)),
+	_receiveBuffer(nullptr),
+	_vectors(IOV_MAX)
+{
+	_receiveBuffer = static_cast<char *>(_memoryPool->GetMemory());
+	_eventLoop->SetBatchHandler([this]()
+								{
+									FlushPending();
+								});
+}
+
+EpollReactor::~EpollReactor()
+{
+	_memoryPool->Release(_receiveBuffer);
+
+	delete _eventLoop;
+}
+
+void EpollReactor::Run()
+{
+	_eventLoop->Run();
+
+	CloseClients();
+	StopListening();
+}
+
+void EpollReactor::Stop()
+{
+	_eventLoop->Stop();
+}
+
+void EpollReactor::Post(Task l_task)
+{
+	_eventLoop->Post(std::move(l_task));
+}
+
+IoBackend EpollReactor::Backend() const
+{
+	return IoBackend::Epoll;
+}
+
+void EpollReactor::OnListening()
+{
+	_eventLoop->Add(_serverDescriptor, EPOLLIN, this);
+}
+
+void EpollReactor::StopListening()
+{
+	if (_serverDescriptor >= 0)
+		_eventLoop->Remove(_serverDescriptor);
+
+	CloseListening();
+}
+
+void EpollReactor::Watch(Connection& l_connection)
+{
+	_eventLoop->Add(l_connection.Descriptor(), EPOLLIN | EPOLLOUT | EPOLLRDHUP, &l_connection);
+}
+
+void EpollReactor::Unwatch(Connection& l_connection)
+{
+	_eventLoop->Remove(l_connection.Descriptor());
+	shutdown(l_connection.Descriptor(), SHUT_RDWR);
+}
+
+void EpollReactor::OnReady(Connection& l_connection, UInt32 l_events)
+{
+	// Reading first lets us consume data that arrived together with the hang-up.
+	if (l_events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+	{
+		Read(l_connection);
+	}
+
+	if (l_connection.GetState() == Connection::State::Open && (l_events & (EPOLLHUP | EPOLLERR)))
+	{
+		l_connection.Close();
+		return;
+	}
+
+	if (l_connection.GetState() == Connection::State::Open && (l_events & EPOLLOUT))
+	{
+		Flush(l_connection);
+	}
+}
+
+void EpollReactor::Flush(Connection& l_connection)
+{
+	while (l_connection.GetState() == Connection::State::Open && l_connection.Queued() > 0)
+	{
+		std::size_t requested = 0;
+		ssize_t written;
+
+		msghdr message{};
+		message.msg_iov = _vectors.data();
+		message.msg_iovlen = l_connection.Gather(_vectors.data(), _vectors.size());
+
+		if (message.msg_iovlen == 0)
+		{
+			// The queue starts with a file region.
+			written = WriteFile(l_connection, requested);
+		}
+		else
+		{
+			for (std::size_t i = 0; i < message.msg_iovlen; ++i)
+			{
+				requested += _vectors[i].iov_len;
+			}
+
+			written = sendmsg(l_connection.Descriptor(), &message, MSG_NOSIGNAL);
+		}
+
+		if (written >= 0)
+		{
+			l_connection.Sent(static_cast<std::size_t>(written));
+
+			// A short write means the socket buffer is full; EPOLLOUT will tell us when to resume.
+			if (static_cast<std::size_t>(written) < requested)
+				return;
+
+			continue;
+		}
+
+		if (errno == EINTR)
+			continue;
+
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+			return;
+
+		if (errno != EPIPE && errno != ECONNRESET)
+			std::cerr << std::strerror(errno) << std::endl;
+
+		l_connection.Close();
+		return;
+	}
+}
+
+void EpollReactor::Resume(Connection& l_connection)
+{
+	// No edge is coming for data that arrived while paused, so read it now.
+	Read(l_connection);
+}
+
+void EpollReactor::OnEvents(UInt32 l_events)
+{
+	if (l_events & EPOLLIN)
+	{
+		Accept();
+	}
+}
+
+void EpollReactor::Accept()
+{
+	// Edge-triggered: accept until the backlog is empty.
+	for (;;)
+	{
+		SocketAddress clientAddress{};
+		auto clientLength = static_cast<socklen_t>(sizeof(clientAddress));
+
+		auto clientDescriptor = accept4(_serverDescriptor, (struct sockaddr *) &clientAddress, &clientLength,
+										SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+		if (clientDescriptor < 0)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return;
+
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+
+			if (errno == EMFILE || errno == ENFILE)
+			{
+				DropPending();
+				continue;
+			}
+
+			std::cerr << std::strerror(errno) << std::endl;
+			return;
+		}
+
+		AddClient(clientDescriptor, clientAddress);
+	}
+}
+
+void EpollReactor::Read(Connection& l_connection)
+{
+	auto size = _memoryPool->BlockSize();
+
+	// Edge-triggered: keep reading until the kernel buffer is drained, unless
+	// the peer is not reading our output or reading was paused; Resume() picks up from there.
+	while (l_connection.GetState() == Connection::State::Open && l_connection.Readable())
+	{
+		// The rest of a large frame goes straight into the connection's reassembly buffer.
+		std::size_t missing = 0;
+		auto target = l_connection.ReceiveSpace(missing);
+		if (l_connection.GetState() != Connection::State::Open)
+			return;
+
+		auto bytesRead = target != nullptr
+			? recv(l_connection.Descriptor(), target, missing, 0)
+			: recv(l_connection.Descriptor(), _receiveBuffer, size, 0);
+
+		if (bytesRead > 0)
+		{
+			if (target != nullptr)
+				l_connection.ReceivedInPlace(target, static_cast<std::size_t>(bytesRead));
+			else
+				l_connection.Receive(_receiveBuffer, static_cast<std::size_t>(bytesRead));
+			continue;
+		}
+
+		if (bytesRead == 0)
+		{
+			l_connection.Close();
+			return;
+		}
+
+		if (errno == EINTR)
+			continue;
+
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+			return;
+
+		std::cerr << std::strerror(errno) << std::endl;
+		l_connection.Close();
+		return;
+	}
+}
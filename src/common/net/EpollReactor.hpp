@@ -0,0 +1,76 @@
+/*
+* export-giggle
+* EpollReactor.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_EPOLLREACTOR_HPP
+#define EXPORT_GIGGLE_EPOLLREACTOR_HPP
+
+#include "Reactor.hpp"
+#include "EventLoop.hpp"
+
+namespace giggle::common::net
+{
+
+	/**
+	 * @brief A Reactor waiting on an edge-triggered epoll EventLoop.
+	 *
+	 * Every ready connection is drained into a single receive buffer
+	 * taken from the reactor's MemoryPool, so an idle connection does
+	 * not pin any pooled memory.
+	 *
+	 * Output is written with sendmsg, up to IOV_MAX segments per call.
+	 * Connections are registered for EPOLLOUT from the start: with
+	 * edge-triggered notifications it only fires after a write filled
+	 * the socket buffer, so it never needs to be toggled.
+	 */
+	class EpollReactor : public Reactor, private EventHandler
+	{
+	public:
+		EpollReactor(UInt32 l_index, UInt32 l_port, UInt32 l_maxConnections, bool l_reusePort,
+					 const Connection::Handlers& l_handlers);
+		~EpollReactor() override;
+
+		void Run() override;
+		void Stop() override;
+		void Post(Task l_task) override;
+		IoBackend Backend() const override;
+
+	protected:
+
+		void OnListening() override;
+		void StopListening() override;
+		void Watch(Connection& l_connection) override;
+		void Unwatch(Connection& l_connection) override;
+		void OnReady(Connection& l_connection, UInt32 l_events) override;
+		void Flush(Connection& l_connection) override;
+		void Resume(Connection& l_connection) override;
+
+	private:
+
+		void OnEvents(UInt32 l_events) override;
+
+		void Accept();
+		void Read(Connection& l_connection);
+
+		EventLoop* _eventLoop;
+		char* _receiveBuffer;
+		std::vector<iovec> _vectors;
+	};
+
+} // namespace net
+
+#endif //EXPORT_GIGGLE_EPOLLREACTOR_HPP
@@ -0,0 +1,214 @@
+/*
+* export-giggle
+* EventLoop.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "EventLoop.hpp"
+
+#include <exceptions/SystemException.hpp>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/eventfd.h>
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+using namespace giggle::common::exception;
+
+EventLoop::EventLoop(UInt32 l_maxEvents, TimerWheel* l_timers):
+	_epollDescriptor(-1),
+	_wakeupDescriptor(-1),
+	_events(l_maxEvents > 0 ? l_maxEvents : DEFAULT_MAX_EVENTS),
+	_running(false),
+	_stopRequested(false),
+	_threadId(),
+	_mutex(),
+	_pending(),
+	_onBatch(),
+	_timers(l_timers)
+{
+	_epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+	if (_epollDescriptor < 0)
+	{
+		throw SystemException("Error creating epoll instance.", std::strerror(errno), errno);
+	}
+
+	_wakeupDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_wakeupDescriptor < 0)
+	{
+		auto error = errno;
+		close(_epollDescriptor);
+		throw SystemException("Error creating wakeup descriptor.", std::strerror(error), error);
+	}
+
+	// The wakeup descriptor is the only one registered without a handler.
+	epoll_event event{};
+	event.events = EPOLLIN | EPOLLET;
+	event.data.ptr = nullptr;
+
+	if (epoll_ctl(_epollDescriptor, EPOLL_CTL_ADD, _wakeupDescriptor, &event) < 0)
+	{
+		auto error = errno;
+		close(_wakeupDescriptor);
+		close(_epollDescriptor);
+		throw SystemException("Error registering wakeup descriptor.", std::strerror(error), error);
+	}
+}
+
+EventLoop::~EventLoop()
+{
+	close(_wakeupDescriptor);
+	close(_epollDescriptor);
+}
+
+void EventLoop::Run()
+{
+	_threadId = std::this_thread::get_id();
+	_running = true;
+
+	while (!_stopRequested)
+	{
+		auto timeout = _timers != nullptr ? _timers->NextTimeout() : -1;
+		auto ready = epoll_wait(_epollDescriptor, _events.data(), static_cast<int>(_events.size()), timeout);
+
+		if (ready < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			std::cerr << std::strerror(errno) << std::endl;
+			break;
+		}
+
+		// Advancing before dispatching keeps Now() current for timers armed by the handlers.
+		if (_timers != nullptr)
+			_timers->Advance(TimerWheel::Clock());
+
+		for (int i = 0; i < ready; ++i)
+		{
+			auto handler = static_cast<EventHandler*>(_events[i].data.ptr);
+
+			if (handler == nullptr)
+				DrainWakeup();
+			else
+				handler->OnEvents(_events[i].events);
+		}
+
+		RunPending();
+
+		if (_onBatch)
+			_onBatch();
+	}
+
+	// Tasks posted while stopping still get to run, so nobody waits forever on them.
+	RunPending();
+
+	if (_onBatch)
+		_onBatch();
+
+	_running = false;
+	_stopRequested = false;
+	_threadId = std::thread::id();
+}
+
+void EventLoop::Stop()
+{
+	_stopRequested = true;
+	Wakeup();
+}
+
+void EventLoop::SetBatchHandler(Task l_handler)
+{
+	_onBatch = std::move(l_handler);
+}
+
+void EventLoop::Post(Task l_task)
+{
+	{
+		std::lock_guard<std::mutex> lock{_mutex};
+		_pending.push_back(std::move(l_task));
+	}
+	Wakeup();
+}
+
+void EventLoop::Add(SocketFileDescriptor l_descriptor, UInt32 l_events, EventHandler* l_handler)
+{
+	epoll_event event{};
+	event.events = l_events | EPOLLET;
+	event.data.ptr = l_handler;
+
+	if (epoll_ctl(_epollDescriptor, EPOLL_CTL_ADD, l_descriptor, &event) < 0)
+	{
+		throw SystemException("Error adding descriptor to epoll.", std::strerror(errno), errno);
+	}
+}
+
+void EventLoop::Modify(SocketFileDescriptor l_descriptor, UInt32 l_events, EventHandler* l_handler)
+{
+	epoll_event event{};
+	event.events = l_events | EPOLLET;
+	event.data.ptr = l_handler;
+
+	if (epoll_ctl(_epollDescriptor, EPOLL_CTL_MOD, l_descriptor, &event) < 0)
+	{
+		throw SystemException("Error modifying epoll descriptor.", std::strerror(errno), errno);
+	}
+}
+
+void EventLoop::Remove(SocketFileDescriptor l_descriptor)
+{
+	epoll_ctl(_epollDescriptor, EPOLL_CTL_DEL, l_descriptor, nullptr);
+}
+
+bool EventLoop::IsRunning() const
+{
+	return _running;
+}
+
+bool EventLoop::InLoopThread() const
+{
+	return _threadId.load() == std::this_thread::get_id();
+}
+
+void EventLoop::Wakeup()
+{
+	// write(2) is async-signal-safe, which is what allows Stop() from signal handlers.
+	UInt64 one = 1;
+	auto written = write(_wakeupDescriptor, &one, sizeof(one));
+	(void) written;
+}
+
+void EventLoop::DrainWakeup()
+{
+	UInt64 count = 0;
+	while (read(_wakeupDescriptor, &count, sizeof(count)) > 0)
+	{
+	}
+}
+
+void EventLoop::RunPending()
+{
+	std::vector<Task> tasks;
+	{
+		std::lock_guard<std::mutex> lock{_mutex};
+		tasks.swap(_pending);
+	}
+
+	for (auto& task : tasks)
+	{
+		task();
+	}
+}
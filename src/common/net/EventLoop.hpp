@@ -0,0 +1,162 @@
+/*
+* export-giggle
+* EventLoop.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_EVENTLOOP_HPP
+#define EXPORT_GIGGLE_EVENTLOOP_HPP
+
+#include "Net.hpp"
+#include "TimerWheel.hpp"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sys/epoll.h>
+
+namespace giggle::common::net
+{
+
+	/**
+	 * @brief Interface for objects that want to be notified
+	 * by an EventLoop when their descriptor becomes ready.
+	 */
+	class EventHandler
+	{
+	public:
+		virtual ~EventHandler() = default;
+
+		/**
+		 * @brief Called from the loop thread with the epoll
+		 * event mask reported for the registered descriptor.
+		 * @param l_events The ready events (EPOLLIN, EPOLLOUT, ...).
+		 */
+		virtual void OnEvents(UInt32 l_events) = 0;
+	};
+
+	/**
+	 * @brief A single threaded, edge-triggered epoll reactor.
+	 *
+	 * Descriptors are registered together with an EventHandler
+	 * that is invoked on the loop thread whenever the kernel
+	 * reports the descriptor as ready. Handlers must never block:
+	 * all registered descriptors are expected to be non-blocking
+	 * and drained until EAGAIN, as required by EPOLLET.
+	 *
+	 * Other threads interact with the loop through Post(), which
+	 * queues a task and wakes the loop through an eventfd.
+	 */
+	class EventLoop
+	{
+	public:
+		typedef std::function<void()> Task;
+
+		/**
+		 * @brief Creates the epoll instance and the wakeup descriptor.
+		 * @throws SystemException
+		 * @param l_maxEvents The number of events fetched per epoll_wait call.
+		 * @param l_timers A wheel to drive from the loop: epoll_wait never sleeps
+		 * past its next timeout and it is advanced right after every wakeup.
+		 */
+		explicit EventLoop(UInt32 l_maxEvents = DEFAULT_MAX_EVENTS, TimerWheel* l_timers = nullptr);
+		~EventLoop();
+
+		EventLoop(const EventLoop&) = delete;
+		EventLoop& operator = (const EventLoop&) = delete;
+
+		/**
+		 * @brief Runs the loop on the calling thread until Stop() is called.
+		 */
+		void Run();
+
+		/**
+		 * @brief Asks the loop to return from Run().
+		 * Only touches an atomic flag and the eventfd,
+		 * so it is safe to call from any thread and from signal handlers.
+		 */
+		void Stop();
+
+		/**
+		 * @brief Queues a task to be executed on the loop thread.
+		 * Safe to call from any thread.
+		 */
+		void Post(Task l_task);
+
+		/**
+		 * @brief Sets a callback invoked on the loop thread at the end of every
+		 * iteration, after the ready handlers and the posted tasks ran.
+		 * Must be set before calling Run().
+		 */
+		void SetBatchHandler(Task l_handler);
+
+		/**
+		 * @brief Registers a descriptor with the loop.
+		 * @throws SystemException
+		 * @param l_descriptor The non-blocking descriptor.
+		 * @param l_events The epoll events to watch; EPOLLET is always added.
+		 * @param l_handler The handler notified when the descriptor is ready.
+		 */
+		void Add(SocketFileDescriptor l_descriptor, UInt32 l_events, EventHandler* l_handler);
+
+		/**
+		 * @brief Changes the events watched for a registered descriptor.
+		 * @throws SystemException
+		 */
+		void Modify(SocketFileDescriptor l_descriptor, UInt32 l_events, EventHandler* l_handler);
+
+		/**
+		 * @brief Unregisters a descriptor. Must be called before closing it.
+		 */
+		void Remove(SocketFileDescriptor l_descriptor);
+
+		/**
+		 * @brief Returns true while the loop is inside Run().
+		 */
+		bool IsRunning() const;
+
+		/**
+		 * @brief Returns true if the caller is the thread running the loop.
+		 */
+		bool InLoopThread() const;
+
+	private:
+
+		void Wakeup();
+		void DrainWakeup();
+		void RunPending();
+
+		SocketFileDescriptor		_epollDescriptor;
+		int 						_wakeupDescriptor;
+
+		std::vector<epoll_event>	_events;
+
+		std::atomic_bool			_running;
+		std::atomic_bool			_stopRequested;
+		std::atomic<std::thread::id> _threadId;
+
+		std::mutex					_mutex;
+		std::vector<Task>			_pending;
+
+		Task						_onBatch;
+		TimerWheel*					_timers;
+	};
+
+} // namespace net
+
+#endif //EXPORT_GIGGLE_EVENTLOOP_HPP
@@ -0,0 +1,137 @@
+/*
+* export-giggle
+* FileCache.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "FileCache.hpp"
+
+#include <exceptions/SystemException.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+using namespace giggle::common::exception;
+
+File::File(int l_descriptor, UInt64 l_size):
+	_descriptor(l_descriptor),
+	_size(l_size)
+{
+
+}
+
+File::~File()
+{
+	close(_descriptor);
+}
+
+int File::Descriptor() const
+{
+	return _descriptor;
+}
+
+UInt64 File::Size() const
+{
+	return _size;
+}
+
+FileCache::FileCache(std::size_t l_capacity):
+	_entries(),
+	_index(),
+	_capacity(l_capacity)
+{
+
+}
+
+std::shared_ptr<const File> FileCache::Open(const std::string& l_path)
+{
+	auto it = _index.find(l_path);
+	if (it != _index.end())
+	{
+		_entries.splice(_entries.begin(), _entries, it->second);
+		return it->second->second;
+	}
+
+	auto descriptor = open(l_path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (descriptor < 0)
+	{
+		throw SystemException("Error opening " + l_path + ".", std::strerror(errno), errno);
+	}
+
+	struct stat status{};
+	auto statError = fstat(descriptor, &status) != 0 ? errno : 0;
+	if (statError != 0 || !S_ISREG(status.st_mode))
+	{
+		auto error = statError != 0 ? statError : EINVAL;
+		close(descriptor);
+		throw SystemException(l_path + " is not a regular file.", std::strerror(error), error);
+	}
+
+	auto file = std::make_shared<const File>(descriptor, static_cast<UInt64>(status.st_size));
+
+	if (_capacity > 0)
+	{
+		_entries.emplace_front(l_path, file);
+		_index[l_path] = _entries.begin();
+		Trim();
+	}
+
+	return file;
+}
+
+void FileCache::Invalidate(const std::string& l_path)
+{
+	auto it = _index.find(l_path);
+	if (it == _index.end())
+		return;
+
+	_entries.erase(it->second);
+	_index.erase(it);
+}
+
+void FileCache::Clear()
+{
+	_entries.clear();
+	_index.clear();
+}
+
+void FileCache::SetCapacity(std::size_t l_capacity)
+{
+	_capacity = l_capacity;
+	Trim();
+}
+
+std::size_t FileCache::Size() const
+{
+	return _entries.size();
+}
+
+std::size_t FileCache::Capacity() const
+{
+	return _capacity;
+}
+
+void FileCache::Trim()
+{
+	while (_entries.size() > _capacity)
+	{
+		_index.erase(_entries.back().first);
+		_entries.pop_back();
+	}
+}
@@ -0,0 +1,120 @@
+/*
+* export-giggle
+* FileCache.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_FILECACHE_HPP
+#define EXPORT_GIGGLE_FILECACHE_HPP
+
+#include "Net.hpp"
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace giggle::common::net
+{
+
+	/**
+	 * @brief A file opened for reading, closed when the last reference goes away.
+	 */
+	class File
+	{
+	public:
+
+		File(int l_descriptor, UInt64 l_size);
+		~File();
+
+		File(const File&) = delete;
+		File& operator = (const File&) = delete;
+
+		int Descriptor() const;
+
+		/**
+		 * @brief Returns the size of the file when it was opened.
+		 */
+		UInt64 Size() const;
+
+	private:
+
+		const int		_descriptor;
+		const UInt64	_size;
+	};
+
+	/**
+	 * @brief Keeps the most recently served files open.
+	 *
+	 * Serving the same blobs over and over should not cost an open()
+	 * and an fstat() per request, so files are looked up by path and
+	 * the least recently used one is dropped once the cache is full.
+	 * Files are handed out by shared pointer: an evicted file stays
+	 * open until the last queued region referencing it was written.
+	 *
+	 * Cached files are assumed not to change; call Invalidate() after
+	 * replacing one. Not thread safe; every reactor owns its own cache.
+	 */
+	class FileCache
+	{
+	public:
+
+		/**
+		 * @brief Creates the cache.
+		 * @param l_capacity The number of files kept open; 0 disables caching.
+		 */
+		explicit FileCache(std::size_t l_capacity = DEFAULT_FILE_CACHE_SIZE);
+
+		FileCache(const FileCache&) = delete;
+		FileCache& operator = (const FileCache&) = delete;
+
+		/**
+		 * @brief Returns the open file at the given path, opening it on a miss.
+		 * @throws SystemException if the file cannot be opened.
+		 */
+		std::shared_ptr<const File> Open(const std::string& l_path);
+
+		/**
+		 * @brief Drops the cached file at the given path, if any.
+		 */
+		void Invalidate(const std::string& l_path);
+
+		/**
+		 * @brief Drops every cached file.
+		 */
+		void Clear();
+
+		/**
+		 * @brief Sets the number of files kept open, evicting the least recently used ones.
+		 */
+		void SetCapacity(std::size_t l_capacity);
+
+		std::size_t Size() const;
+		std::size_t Capacity() const;
+
+	private:
+
+		typedef std::list<std::pair<std::string, std::shared_ptr<const File>>> Entries;
+
+		void Trim();
+
+		Entries 												_entries;
+		std::unordered_map<std::string, Entries::iterator>		_index;
+		std::size_t 											_capacity;
+	};
+
+} // namespace net
+
+#endif //EXPORT_GIGGLE_FILECACHE_HPP
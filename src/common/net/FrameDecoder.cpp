@@ -0,0 +1,69 @@
+/*
+* export-giggle
+* FrameDecoder.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "FrameDecoder.hpp"
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+
+FrameDecoder::FrameDecoder(UInt32 l_maxFrameSize):
+	_pending(0),
+	_expected(0),
+	_maxFrameSize(l_maxFrameSize)
+{
+
+}
+
+char* FrameDecoder::PendingSpace(std::size_t& l_size)
+{
+	if (_expected == 0 || _pending.Size() >= _expected)
+		return nullptr;
+
+	auto missing = _expected - _pending.Size();
+	if (missing < DIRECT_READ_THRESHOLD)
+		return nullptr;
+
+	// Grows with what arrived, geometrically, rather than to the size the header claims.
+	auto ahead = std::min(missing, std::max<std::size_t>(READ_AHEAD, _pending.Size()));
+	auto space = _pending.Reserve(ahead);
+
+	l_size = std::min(missing, _pending.Capacity() - _pending.Size());
+	return space;
+}
+
+std::size_t FrameDecoder::Pending() const
+{
+	return _pending.Size();
+}
+
+void FrameDecoder::Reset()
+{
+	Release();
+}
+
+void FrameDecoder::Release()
+{
+	_pending.Resize(0);
+	_expected = 0;
+
+	// Idle connections should not hold on to the memory of a large frame.
+	if (_pending.Capacity() > RETAINED_CAPACITY)
+	{
+		_pending.SetCapacity(0, false);
+	}
+}
@@ -0,0 +1,228 @@
+/*
+* export-giggle
+* FrameDecoder.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_FRAMEDECODER_HPP
+#define EXPORT_GIGGLE_FRAMEDECODER_HPP
+
+#include "Net.hpp"
+
+#include <ByteOrder.hpp>
+#include <memory/Buffer.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace giggle::common::net
+{
+
+	/**
+	 * @brief A non-owning view of the payload of a complete frame.
+	 *
+	 * The data is only valid for the duration of the handler call
+	 * it is passed to; copy it to keep it around.
+	 */
+	struct Frame
+	{
+		const char* Data;
+		std::size_t Size;
+	};
+
+	/**
+	 * @brief Splits a byte stream into length-prefixed frames.
+	 *
+	 * Every frame starts with a 4 byte, big-endian payload length.
+	 * Frames that are complete inside the chunk handed to Feed() are
+	 * dispatched in place, straight out of the receive buffer. Only the
+	 * trailing part of a frame that crosses a read boundary is copied,
+	 * into a pending buffer; the rest of that frame can then be read
+	 * directly into it (see PendingSpace()). The buffer grows with the
+	 * bytes that actually arrived, never trusting the length a header
+	 * claims, so a peer sending only headers cannot make the decoder
+	 * allocate whole frames.
+	 */
+	class FrameDecoder
+	{
+	public:
+
+		enum
+		{
+			HEADER_SIZE = sizeof(UInt32),
+			/// Pending buffers larger than this are released after use.
+			RETAINED_CAPACITY = 65536,
+			/// Pending frames missing at least this many bytes are read in place.
+			DIRECT_READ_THRESHOLD = 16384,
+			/// The most space PendingSpace() makes ahead of a small pending frame;
+			/// larger ones get as much as they already hold.
+			READ_AHEAD = 65536
+		};
+
+		/**
+		 * @brief Creates the decoder.
+		 * @param l_maxFrameSize The largest payload accepted; larger frames are a protocol error.
+		 */
+		explicit FrameDecoder(UInt32 l_maxFrameSize = DEFAULT_MAX_FRAME_SIZE);
+
+		FrameDecoder(const FrameDecoder&) = delete;
+		FrameDecoder& operator = (const FrameDecoder&) = delete;
+
+		/**
+		 * @brief Decodes the given bytes, invoking l_onFrame(const Frame&) for every
+		 * complete frame. The callback returns false to stop decoding, in which
+		 * case the remaining bytes are discarded.
+		 * @throws std::bad_alloc
+		 * @return false if a frame exceeds the maximum frame size.
+		 */
+		template <class F>
+		bool Feed(const char* l_data, std::size_t l_length, F&& l_onFrame);
+
+		/**
+		 * @brief Returns free space for a partially received frame whose length
+		 * is known, when enough of it is missing to be worth reading in place.
+		 * The pending buffer grows by at most READ_AHEAD or its size.
+		 * @throws std::bad_alloc
+		 * @param l_size Receives the number of bytes that fit, at most the missing ones.
+		 * @return The write position, or nullptr.
+		 */
+		char* PendingSpace(std::size_t& l_size);
+
+		/**
+		 * @brief Accounts for l_length bytes written at PendingSpace(), dispatching
+		 * the frame if it is now complete.
+		 */
+		template <class F>
+		void Commit(std::size_t l_length, F&& l_onFrame);
+
+		/**
+		 * @brief Returns the number of bytes held for an incomplete frame.
+		 */
+		std::size_t Pending() const;
+
+		/**
+		 * @brief Drops any incomplete frame.
+		 */
+		void Reset();
+
+		/**
+		 * @brief Writes the frame header for a payload of l_length bytes.
+		 * @param l_header At least HEADER_SIZE bytes.
+		 */
+		static void EncodeHeader(char* l_header, UInt32 l_length);
+
+	private:
+
+		static UInt32 DecodeHeader(const char* l_header);
+
+		void Release();
+
+		memory::Buffer<char>	_pending;
+		std::size_t				_expected;
+		const UInt32			_maxFrameSize;
+	};
+
+	template <class F>
+	bool FrameDecoder::Feed(const char* l_data, std::size_t l_length, F&& l_onFrame)
+	{
+		if (!_pending.Empty())
+		{
+			if (_pending.Size() < HEADER_SIZE)
+			{
+				auto take = std::min<std::size_t>(HEADER_SIZE - _pending.Size(), l_length);
+				_pending.Append(l_data, take);
+				l_data += take;
+				l_length -= take;
+
+				if (_pending.Size() < HEADER_SIZE)
+					return true;
+
+				auto payload = DecodeHeader(_pending.Begin());
+				if (payload > _maxFrameSize)
+					return false;
+
+				_expected = HEADER_SIZE + payload;
+			}
+
+			auto take = std::min(_expected - _pending.Size(), l_length);
+			_pending.Append(l_data, take);
+			l_data += take;
+			l_length -= take;
+
+			if (_pending.Size() < _expected)
+				return true;
+
+			auto keepGoing = l_onFrame(Frame{_pending.Begin() + HEADER_SIZE, _expected - HEADER_SIZE});
+			Release();
+
+			if (!keepGoing)
+				return true;
+		}
+
+		while (l_length >= HEADER_SIZE)
+		{
+			auto payload = DecodeHeader(l_data);
+			if (payload > _maxFrameSize)
+				return false;
+
+			if (l_length - HEADER_SIZE < payload)
+				break;
+
+			if (!l_onFrame(Frame{l_data + HEADER_SIZE, payload}))
+				return true;
+
+			l_data += HEADER_SIZE + payload;
+			l_length -= HEADER_SIZE + payload;
+		}
+
+		if (l_length > 0)
+		{
+			// Only the tail of a frame crossing the read boundary is copied.
+			_expected = l_length >= HEADER_SIZE ? HEADER_SIZE + DecodeHeader(l_data) : 0;
+			_pending.Append(l_data, l_length);
+		}
+
+		return true;
+	}
+
+	template <class F>
+	void FrameDecoder::Commit(std::size_t l_length, F&& l_onFrame)
+	{
+		// Stays within the space PendingSpace() reserved, so nothing moves.
+		_pending.Resize(_pending.Size() + l_length);
+
+		if (_pending.Size() == _expected)
+		{
+			l_onFrame(Frame{_pending.Begin() + HEADER_SIZE, _expected - HEADER_SIZE});
+			Release();
+		}
+	}
+
+	inline void FrameDecoder::EncodeHeader(char* l_header, UInt32 l_length)
+	{
+		auto length = ByteOrder::toNetwork(l_length);
+		std::memcpy(l_header, &length, sizeof(length));
+	}
+
+	inline UInt32 FrameDecoder::DecodeHeader(const char* l_header)
+	{
+		UInt32 length;
+		std::memcpy(&length, l_header, sizeof(length));
+		return ByteOrder::fromNetwork(length);
+	}
+
+} // namespace net
+
+#endif //EXPORT_GIGGLE_FRAMEDECODER_HPP
@@ -0,0 +1,203 @@
+/*
+* export-giggle
+* HandOff.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "HandOff.hpp"
+
+#include <exceptions/SystemException.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/un.h>
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+using namespace giggle::common::exception;
+
+sockaddr_un HandOff::Address(const std::string& l_path)
+{
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+
+	if (l_path.size() >= sizeof(address.sun_path))
+	{
+		throw SystemException("Hand-off socket path is too long.", l_path, ENAMETOOLONG);
+	}
+
+	std::memcpy(address.sun_path, l_path.c_str(), l_path.size());
+	return address;
+}
+
+void HandOff::Send(const std::string& l_path, const std::vector<SocketFileDescriptor>& l_descriptors)
+{
+	auto address = Address(l_path);
+
+	// Sequenced packets keep every batch of descriptors attached to its own header.
+	auto descriptor = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (descriptor < 0)
+	{
+		throw SystemException("Error opening hand-off socket.", std::strerror(errno), errno);
+	}
+
+	if (connect(descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+	{
+		auto error = errno;
+		close(descriptor);
+		throw SystemException("Error connecting to " + l_path + ".", std::strerror(error), error);
+	}
+
+	std::size_t sent = 0;
+	do
+	{
+		auto count = std::min<std::size_t>(l_descriptors.size() - sent, BATCH_SIZE);
+
+		Header header{MAGIC, static_cast<UInt32>(l_descriptors.size())};
+		iovec vector{&header, sizeof(header)};
+
+		std::vector<char> control(CMSG_SPACE(sizeof(SocketFileDescriptor) * BATCH_SIZE), 0);
+
+		msghdr message{};
+		message.msg_iov = &vector;
+		message.msg_iovlen = 1;
+
+		if (count > 0)
+		{
+			message.msg_control = control.data();
+			message.msg_controllen = CMSG_SPACE(sizeof(SocketFileDescriptor) * count);
+
+			auto cmsg = CMSG_FIRSTHDR(&message);
+			cmsg->cmsg_level = SOL_SOCKET;
+			cmsg->cmsg_type = SCM_RIGHTS;
+			cmsg->cmsg_len = CMSG_LEN(sizeof(SocketFileDescriptor) * count);
+			std::memcpy(CMSG_DATA(cmsg), l_descriptors.data() + sent, sizeof(SocketFileDescriptor) * count);
+		}
+
+		if (sendmsg(descriptor, &message, MSG_NOSIGNAL) < 0)
+		{
+			auto error = errno;
+			close(descriptor);
+			throw SystemException("Error sending descriptors.", std::strerror(error), error);
+		}
+
+		sent += count;
+	}
+	while (sent < l_descriptors.size());
+
+	close(descriptor);
+}
+
+std::vector<SocketFileDescriptor> HandOff::Receive(const std::string& l_path, int l_timeout)
+{
+	auto address = Address(l_path);
+
+	auto server = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (server < 0)
+	{
+		throw SystemException("Error opening hand-off socket.", std::strerror(errno), errno);
+	}
+
+	unlink(l_path.c_str());
+
+	if (bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(server, 1) < 0)
+	{
+		auto error = errno;
+		close(server);
+		throw SystemException("Error listening on " + l_path + ".", std::strerror(error), error);
+	}
+
+	std::vector<SocketFileDescriptor> descriptors;
+	auto fail = [&](const std::string& l_message, int l_error, int l_client)
+	{
+		for (auto received : descriptors)
+		{
+			close(received);
+		}
+
+		if (l_client >= 0)
+			close(l_client);
+
+		close(server);
+		unlink(l_path.c_str());
+		throw SystemException(l_message, std::strerror(l_error), l_error);
+	};
+
+	pollfd waiting{server, POLLIN, 0};
+	auto ready = poll(&waiting, 1, l_timeout);
+	if (ready <= 0)
+	{
+		fail("No descriptors were handed off.", ready == 0 ? ETIMEDOUT : errno, -1);
+	}
+
+	auto client = accept4(server, nullptr, nullptr, SOCK_CLOEXEC);
+	if (client < 0)
+	{
+		fail("Error accepting hand-off connection.", errno, -1);
+	}
+
+	UInt32 total = 0;
+	do
+	{
+		Header header{};
+		iovec vector{&header, sizeof(header)};
+
+		std::vector<char> control(CMSG_SPACE(sizeof(SocketFileDescriptor) * BATCH_SIZE), 0);
+
+		msghdr message{};
+		message.msg_iov = &vector;
+		message.msg_iovlen = 1;
+		message.msg_control = control.data();
+		message.msg_controllen = control.size();
+
+		// Retry the call itself: continuing the outer loop would end it while total is still 0.
+		ssize_t received;
+		do
+		{
+			received = recvmsg(client, &message, MSG_CMSG_CLOEXEC);
+		} while (received < 0 && errno == EINTR);
+
+		if (received < 0)
+			fail("Error receiving descriptors.", errno, client);
+
+		for (auto cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg))
+		{
+			if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+				continue;
+
+			auto count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(SocketFileDescriptor);
+			auto first = descriptors.size();
+			descriptors.resize(first + count);
+			std::memcpy(descriptors.data() + first, CMSG_DATA(cmsg), sizeof(SocketFileDescriptor) * count);
+		}
+
+		if (static_cast<std::size_t>(received) != sizeof(header) || header.Magic != MAGIC ||
+			(message.msg_flags & MSG_CTRUNC) != 0)
+		{
+			fail("Malformed hand-off message.", EPROTO, client);
+		}
+
+		total = header.Total;
+	}
+	while (descriptors.size() < total);
+
+	close(client);
+	close(server);
+	unlink(l_path.c_str());
+
+	return descriptors;
+}
@@ -0,0 +1,86 @@
+/*
+* export-giggle
+* HandOff.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_HANDOFF_HPP
+#define EXPORT_GIGGLE_HANDOFF_HPP
+
+#include "Net.hpp"
+
+#include <string>
+#include <vector>
+
+#include <sys/un.h>
+
+namespace giggle::common::net
+{
+
+	/**
+	 * @brief Passes listening sockets from a running server to the process replacing it.
+	 *
+	 * The replacement calls Receive(), which waits on a Unix socket at the
+	 * given path; the running server then calls Send() with its listening
+	 * descriptors, which travel as SCM_RIGHTS ancillary data. Both processes
+	 * now share the same sockets: the new one starts accepting right away,
+	 * while the old one drains, see TcpServer::Drain(). Connections waiting
+	 * in the backlog are accepted by whichever process gets to them first,
+	 * so none are refused during the switch.
+	 */
+	class HandOff
+	{
+	public:
+
+		/**
+		 * @brief Sends the descriptors to the process waiting at l_path.
+		 * The descriptors stay open in this process.
+		 * @throws SystemException
+		 */
+		static void Send(const std::string& l_path, const std::vector<SocketFileDescriptor>& l_descriptors);
+
+		/**
+		 * @brief Creates a Unix socket at l_path and waits for a single Send().
+		 * Any stale socket file at l_path is replaced; the file is removed
+		 * again before returning.
+		 * @throws SystemException on failure or when nothing arrives in time.
+		 * @param l_path The socket path.
+		 * @param l_timeout The longest wait in milliseconds, or -1 to wait indefinitely.
+		 * @return The received descriptors, in the order they were sent.
+		 */
+		static std::vector<SocketFileDescriptor> Receive(const std::string& l_path, int l_timeout = -1);
+
+	private:
+
+		/// The fixed part of every hand-off message.
+		struct Header
+		{
+			UInt32 Magic;
+			UInt32 Total;
+		};
+
+		enum : UInt32
+		{
+			MAGIC = 0x47474c48,
+			/// The kernel accepts at most 253 descriptors per message.
+			BATCH_SIZE = 253
+		};
+
+		static sockaddr_un Address(const std::string& l_path);
+	};
+
+} // namespace net
+
+#endif //EXPORT_GIGGLE_HANDOFF_HPP
@@ -0,0 +1,285 @@
+/*
+* export-giggle
+* IoUring.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "IoUring.hpp"
+
+#ifdef GIGGLE_NET_HAVE_IO_URING
+
+#include <exceptions/SystemException.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+using namespace giggle::common::exception;
+
+namespace
+{
+	int SetupRing(UInt32 l_entries, io_uring_params* l_params)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_setup, l_entries, l_params));
+	}
+
+	int EnterRing(int l_descriptor, UInt32 l_submit, UInt32 l_waitFor, UInt32 l_flags,
+				  const void* l_argument = nullptr, std::size_t l_argumentSize = 0)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_enter, l_descriptor, l_submit, l_waitFor, l_flags,
+										l_argument, l_argumentSize));
+	}
+
+	int RegisterRing(int l_descriptor, UInt32 l_opcode, void* l_argument, UInt32 l_count)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_register, l_descriptor, l_opcode, l_argument, l_count));
+	}
+}
+
+IoUring::IoUring(UInt32 l_entries):
+	_descriptor(-1),
+	_sqRing(MAP_FAILED), _sqRingSize(0),
+	_cqRing(MAP_FAILED), _cqRingSize(0),
+	_sqes(nullptr), _sqesSize(0),
+	_sqHead(nullptr), _sqTail(nullptr), _sqMask(0), _sqEntries(0), _sqArray(nullptr),
+	_sqeHead(0), _sqeTail(0),
+	_cqHead(nullptr), _cqTail(nullptr), _cqMask(0), _cqes(nullptr)
+{
+	io_uring_params params{};
+	params.flags = IORING_SETUP_CLAMP;
+
+	_descriptor = SetupRing(l_entries, &params);
+	if (_descriptor < 0)
+	{
+		throw SystemException("Error creating io_uring instance.", std::strerror(errno), errno);
+	}
+
+	_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(UInt32);
+	_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		_sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+	}
+
+	_sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				   _descriptor, IORING_OFF_SQ_RING);
+
+	if (_sqRing != MAP_FAILED)
+	{
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+			_cqRing = _sqRing;
+		else
+			_cqRing = mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+						   _descriptor, IORING_OFF_CQ_RING);
+	}
+
+	_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	void* sqes = MAP_FAILED;
+
+	if (_cqRing != MAP_FAILED)
+	{
+		sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+					_descriptor, IORING_OFF_SQES);
+	}
+
+	if (sqes == MAP_FAILED)
+	{
+		auto error = errno;
+		if (_cqRing != MAP_FAILED && _cqRing != _sqRing)
+			munmap(_cqRing, _cqRingSize);
+		if (_sqRing != MAP_FAILED)
+			munmap(_sqRing, _sqRingSize);
+		close(_descriptor);
+		throw SystemException("Error mapping io_uring rings.", std::strerror(error), error);
+	}
+
+	_sqes = static_cast<io_uring_sqe*>(sqes);
+
+	auto sq = static_cast<char*>(_sqRing);
+	_sqHead 	= reinterpret_cast<UInt32*>(sq + params.sq_off.head);
+	_sqTail 	= reinterpret_cast<UInt32*>(sq + params.sq_off.tail);
+	_sqMask 	= *reinterpret_cast<UInt32*>(sq + params.sq_off.ring_mask);
+	_sqEntries 	= *reinterpret_cast<UInt32*>(sq + params.sq_off.ring_entries);
+	_sqArray 	= reinterpret_cast<UInt32*>(sq + params.sq_off.array);
+
+	auto cq = static_cast<char*>(_cqRing);
+	_cqHead 	= reinterpret_cast<UInt32*>(cq + params.cq_off.head);
+	_cqTail 	= reinterpret_cast<UInt32*>(cq + params.cq_off.tail);
+	_cqMask 	= *reinterpret_cast<UInt32*>(cq + params.cq_off.ring_mask);
+	_cqes 		= reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+	_sqeHead = _sqeTail = *_sqTail;
+}
+
+IoUring::~IoUring()
+{
+	munmap(_sqes, _sqesSize);
+	if (_cqRing != _sqRing)
+		munmap(_cqRing, _cqRingSize);
+	munmap(_sqRing, _sqRingSize);
+	close(_descriptor);
+}
+
+bool IoUring::IsSupported()
+{
+	// Multishot recv is the newest feature we rely on (6.0); the opcode
+	// probe can not tell flags apart, so the kernel release decides.
+	utsname name{};
+	if (uname(&name) != 0)
+		return false;
+
+	int major = 0;
+	if (std::sscanf(name.release, "%d.", &major) != 1)
+		return false;
+
+	return major >= 6;
+}
+
+io_uring_sqe* IoUring::GetSqe()
+{
+	auto head = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+
+	if (_sqeTail - head >= _sqEntries)
+	{
+		Submit();
+		head = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+
+		if (_sqeTail - head >= _sqEntries)
+			return nullptr;
+	}
+
+	auto sqe = &_sqes[_sqeTail & _sqMask];
+	++_sqeTail;
+
+	std::memset(sqe, 0, sizeof(*sqe));
+	return sqe;
+}
+
+int IoUring::Submit(UInt32 l_waitFor, int l_timeout)
+{
+	auto tail = *_sqTail;
+	UInt32 toSubmit = _sqeTail - _sqeHead;
+
+	for (; _sqeHead != _sqeTail; ++_sqeHead, ++tail)
+	{
+		_sqArray[tail & _sqMask] = _sqeHead & _sqMask;
+	}
+
+	__atomic_store_n(_sqTail, tail, __ATOMIC_RELEASE);
+
+	if (toSubmit == 0 && l_waitFor == 0)
+		return 0;
+
+	int result;
+
+	if (l_waitFor > 0 && l_timeout >= 0)
+	{
+		__kernel_timespec timeout{};
+		timeout.tv_sec = l_timeout / 1000;
+		timeout.tv_nsec = static_cast<long long>(l_timeout % 1000) * 1000000;
+
+		io_uring_getevents_arg argument{};
+		argument.ts = reinterpret_cast<UInt64>(&timeout);
+
+		result = EnterRing(_descriptor, toSubmit, l_waitFor, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+						   &argument, sizeof(argument));
+		return result < 0 ? -errno : result;
+	}
+
+	do
+	{
+		result = EnterRing(_descriptor, toSubmit, l_waitFor, l_waitFor > 0 ? IORING_ENTER_GETEVENTS : 0);
+	}
+	while (result < 0 && errno == EINTR && l_waitFor == 0);
+
+	return result < 0 ? -errno : result;
+}
+
+void IoUring::RegisterBufferRing(io_uring_buf_ring* l_ring, UInt32 l_entries, UInt16 l_group)
+{
+	io_uring_buf_reg registration{};
+	registration.ring_addr = reinterpret_cast<UInt64>(l_ring);
+	registration.ring_entries = l_entries;
+	registration.bgid = l_group;
+
+	if (RegisterRing(_descriptor, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+	{
+		throw SystemException("Error registering provided buffer ring.", std::strerror(errno), errno);
+	}
+}
+
+void IoUring::UnregisterBufferRing(UInt16 l_group)
+{
+	io_uring_buf_reg registration{};
+	registration.bgid = l_group;
+
+	RegisterRing(_descriptor, IORING_UNREGISTER_PBUF_RING, &registration, 1);
+}
+
+void IoUring::PrepareAccept(io_uring_sqe* l_sqe, SocketFileDescriptor l_descriptor, UInt64 l_userData)
+{
+	l_sqe->opcode = IORING_OP_ACCEPT;
+	l_sqe->fd = l_descriptor;
+	l_sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	l_sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+	l_sqe->user_data = l_userData;
+}
+
+void IoUring::PrepareRecv(io_uring_sqe* l_sqe, SocketFileDescriptor l_descriptor, UInt16 l_group, UInt64 l_userData)
+{
+	l_sqe->opcode = IORING_OP_RECV;
+	l_sqe->fd = l_descriptor;
+	l_sqe->ioprio = IORING_RECV_MULTISHOT;
+	l_sqe->flags = IOSQE_BUFFER_SELECT;
+	l_sqe->buf_group = l_group;
+	l_sqe->user_data = l_userData;
+}
+
+void IoUring::PrepareSendMsg(io_uring_sqe* l_sqe, SocketFileDescriptor l_descriptor, const msghdr* l_message,
+							 UInt32 l_flags, UInt64 l_userData)
+{
+	l_sqe->opcode = IORING_OP_SENDMSG;
+	l_sqe->fd = l_descriptor;
+	l_sqe->addr = reinterpret_cast<UInt64>(l_message);
+	l_sqe->len = 1;
+	l_sqe->msg_flags = l_flags;
+	l_sqe->user_data = l_userData;
+}
+
+void IoUring::PreparePoll(io_uring_sqe* l_sqe, int l_descriptor, UInt32 l_events, UInt64 l_userData,
+						  bool l_multishot)
+{
+	l_sqe->opcode = IORING_OP_POLL_ADD;
+	l_sqe->fd = l_descriptor;
+	l_sqe->poll32_events = l_events;
+	l_sqe->len = l_multishot ? IORING_POLL_ADD_MULTI : 0;
+	l_sqe->user_data = l_userData;
+}
+
+void IoUring::PrepareCancel(io_uring_sqe* l_sqe, UInt64 l_target, UInt64 l_userData)
+{
+	l_sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	l_sqe->fd = -1;
+	l_sqe->addr = l_target;
+	l_sqe->user_data = l_userData;
+}
+
+#endif // GIGGLE_NET_HAVE_IO_URING
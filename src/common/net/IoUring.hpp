@@ -0,0 +1,164 @@
+/*
+* export-giggle
+* IoUring.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_IOURING_HPP
+#define EXPORT_GIGGLE_IOURING_HPP
+
+#include "Net.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+/*
+ * The io_uring backend needs multishot accept/recv and provided buffer rings,
+ * which first shipped together in the 6.0 kernel headers.
+ */
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_ACCEPT_MULTISHOT)
+#define GIGGLE_NET_HAVE_IO_URING 1
+#endif
+
+#ifdef GIGGLE_NET_HAVE_IO_URING
+
+struct msghdr;
+
+namespace giggle::common::net
+{
+
+	/**
+	 * @brief A minimal wrapper around the raw io_uring system calls.
+	 *
+	 * Maps the submission and completion rings of a new io_uring
+	 * instance and exposes just what the UringReactor needs: getting
+	 * submission entries, submitting and waiting, reaping completions
+	 * and registering provided buffer rings.
+	 *
+	 * Not thread safe; an instance belongs to the thread running it.
+	 */
+	class IoUring
+	{
+	public:
+
+		/**
+		 * @brief Creates the ring.
+		 * @throws SystemException if the kernel does not support io_uring.
+		 * @param l_entries The submission queue depth.
+		 */
+		explicit IoUring(UInt32 l_entries);
+		~IoUring();
+
+		IoUring(const IoUring&) = delete;
+		IoUring& operator = (const IoUring&) = delete;
+
+		/**
+		 * @brief Returns true if the running kernel provides everything
+		 * the io_uring backend relies on.
+		 */
+		static bool IsSupported();
+
+		/**
+		 * @brief Returns a zeroed submission entry, submitting the queued
+		 * ones first if the submission queue is full.
+		 */
+		io_uring_sqe* GetSqe();
+
+		/**
+		 * @brief Submits the queued entries and waits for at least
+		 * l_waitFor completions.
+		 * @param l_waitFor The completions to wait for.
+		 * @param l_timeout The longest wait in milliseconds, or -1 to wait indefinitely.
+		 * @return The number of submitted entries, or -errno; -ETIME if the wait timed out.
+		 */
+		int Submit(UInt32 l_waitFor = 0, int l_timeout = -1);
+
+		/**
+		 * @brief Invokes l_callback for every available completion and
+		 * marks them as consumed.
+		 * @return The number of reaped completions.
+		 */
+		template <class F>
+		UInt32 ForEachCompletion(F&& l_callback)
+		{
+			auto head = *_cqHead;
+			auto tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+			UInt32 count = 0;
+
+			for (; head != tail; ++head, ++count)
+			{
+				l_callback(_cqes[head & _cqMask]);
+			}
+
+			__atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+			return count;
+		}
+
+		/**
+		 * @brief Registers a provided buffer ring under the given group.
+		 * @throws SystemException
+		 * @param l_ring Page aligned ring memory.
+		 * @param l_entries The number of ring entries, a power of two.
+		 * @param l_group The buffer group id.
+		 */
+		void RegisterBufferRing(io_uring_buf_ring* l_ring, UInt32 l_entries, UInt16 l_group);
+
+		/**
+		 * @brief Unregisters a provided buffer ring.
+		 */
+		void UnregisterBufferRing(UInt16 l_group);
+
+		static void PrepareAccept(io_uring_sqe* l_sqe, SocketFileDescriptor l_descriptor, UInt64 l_userData);
+		static void PrepareRecv(io_uring_sqe* l_sqe, SocketFileDescriptor l_descriptor, UInt16 l_group, UInt64 l_userData);
+		static void PrepareSendMsg(io_uring_sqe* l_sqe, SocketFileDescriptor l_descriptor, const msghdr* l_message,
+								   UInt32 l_flags, UInt64 l_userData);
+		static void PreparePoll(io_uring_sqe* l_sqe, int l_descriptor, UInt32 l_events, UInt64 l_userData,
+								bool l_multishot = true);
+		static void PrepareCancel(io_uring_sqe* l_sqe, UInt64 l_target, UInt64 l_userData);
+
+	private:
+
+		int 				_descriptor;
+
+		void*				_sqRing;
+		std::size_t			_sqRingSize;
+		void*				_cqRing;
+		std::size_t			_cqRingSize;
+		io_uring_sqe*		_sqes;
+		std::size_t			_sqesSize;
+
+		UInt32*				_sqHead;
+		UInt32*				_sqTail;
+		UInt32				_sqMask;
+		UInt32				_sqEntries;
+		UInt32*				_sqArray;
+		UInt32				_sqeHead;
+		UInt32				_sqeTail;
+
+		UInt32*				_cqHead;
+		UInt32*				_cqTail;
+		UInt32				_cqMask;
+		io_uring_cqe*		_cqes;
+	};
+
+} // namespace net
+
+#endif // GIGGLE_NET_HAVE_IO_URING
+
+#endif //EXPORT_GIGGLE_IOURING_HPP
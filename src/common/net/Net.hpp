@@ -25,6 +25,7 @@
 #include <netinet/in.h>
 
 #include <Types.hpp>
+#include <cstddef>
 
 namespace giggle::common::net
 {
@@ -32,9 +33,34 @@ namespace giggle::common::net
 	typedef struct sockaddr_in SocketAddress;
 	typedef int SocketFileDescriptor;
 
-	const UInt32 DEFAULT_MAX_CONNECTIONS = 128;
+	/// Identifies a connection for as long as it is open, across all reactors of a server.
+	typedef UInt64 ConnectionId;
+	const ConnectionId INVALID_CONNECTION = 0;
+
+	const UInt32 DEFAULT_MAX_CONNECTIONS = 65536;
 	const UInt32 DEFAULT_BLOCK_SIZE = 1048576;
 	const UInt32 DEFAULT_MAX_BLOCKS = 100;
+	const UInt32 DEFAULT_MAX_EVENTS = 1024;
+	const UInt32 MAX_REACTORS = 256;
+	const UInt32 DEFAULT_MAX_FRAME_SIZE = 16777216;
+	const UInt32 DEFAULT_LOW_WATERMARK = 65536;
+	const UInt32 DEFAULT_HIGH_WATERMARK = 1048576;
+	const UInt32 DEFAULT_FILE_CACHE_SIZE = 256;
+	const UInt32 DRAIN_CHECK_INTERVAL = 10;
+	const UInt32 HANDOFF_COLLECT_TIMEOUT = 5000;
+
+	const UInt32 URING_QUEUE_DEPTH = 4096;
+	const UInt32 URING_BUFFER_SIZE = 16384;
+	const UInt32 URING_BUFFER_COUNT = 256;
+
+	/**
+	 * @brief The kernel interface used by a server to wait for I/O.
+	 */
+	enum class IoBackend
+	{
+		Epoll,		/// Edge-triggered readiness notifications.
+		IoUring		/// Completion based; falls back to Epoll when unavailable.
+	};
 
 } // namespace net
 
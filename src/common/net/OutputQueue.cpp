@@ -0,0 +1,136 @@
+/*
+* export-giggle
+* OutputQueue.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "OutputQueue.hpp"
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+
+OutputQueue::OutputQueue():
+	_segments(),
+	_offset(0),
+	_bytes(0)
+{
+
+}
+
+void OutputQueue::Push(memory::Buffer<char>&& l_segment)
+{
+	if (l_segment.Empty())
+		return;
+
+	_bytes += l_segment.Size();
+	_segments.push_back(Segment{std::move(l_segment), FileRegion{nullptr, 0, 0}, {}});
+}
+
+void OutputQueue::Push(const memory::BufferChain& l_chain)
+{
+	for (auto& shared : l_chain)
+	{
+		if (shared.Size() == 0)
+			continue;
+
+		// The block stays referenced by the segment for as long as the view is queued.
+		memory::Buffer<char> view(const_cast<char*>(shared.Data()), shared.Size());
+		_bytes += shared.Size();
+		_segments.push_back(Segment{std::move(view), FileRegion{nullptr, 0, 0}, shared});
+	}
+}
+
+void OutputQueue::Push(FileRegion&& l_region)
+{
+	if (l_region.Length == 0)
+		return;
+
+	_bytes += l_region.Length;
+	_segments.push_back(Segment{memory::Buffer<char>(0), std::move(l_region), {}});
+}
+
+std::size_t OutputQueue::Gather(iovec* l_vectors, std::size_t l_max) const
+{
+	std::size_t count = 0;
+	auto offset = _offset;
+
+	for (auto it = _segments.begin(); it != _segments.end() && count < l_max && it->Region.Source == nullptr;
+		 ++it, ++count)
+	{
+		l_vectors[count].iov_base = const_cast<char*>(it->Data.Begin()) + offset;
+		l_vectors[count].iov_len = it->Data.Size() - offset;
+		offset = 0;
+	}
+
+	return count;
+}
+
+const File* OutputQueue::GatherFile(UInt64& l_offset, std::size_t& l_length) const
+{
+	if (_segments.empty() || _segments.front().Region.Source == nullptr)
+		return nullptr;
+
+	auto& region = _segments.front().Region;
+	l_offset = region.Offset + _offset;
+	l_length = region.Length - _offset;
+	return region.Source.get();
+}
+
+void OutputQueue::Consume(std::size_t l_bytes)
+{
+	_bytes -= l_bytes;
+
+	while (l_bytes > 0)
+	{
+		auto remaining = _segments.front().Size() - _offset;
+
+		if (l_bytes < remaining)
+		{
+			_offset += l_bytes;
+			return;
+		}
+
+		l_bytes -= remaining;
+		_offset = 0;
+		_segments.pop_front();
+	}
+}
+
+void OutputQueue::Clear()
+{
+	_segments.clear();
+	_offset = 0;
+	_bytes = 0;
+}
+
+std::size_t OutputQueue::Bytes() const
+{
+	return _bytes;
+}
+
+std::size_t OutputQueue::Segments() const
+{
+	return _segments.size();
+}
+
+bool OutputQueue::Empty() const
+{
+	return _segments.empty();
+}
+
+std::size_t OutputQueue::Segment::Size() const
+{
+	return Region.Source != nullptr ? Region.Length : Data.Size();
+}
@@ -0,0 +1,147 @@
+/*
+* export-giggle
+* OutputQueue.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_OUTPUTQUEUE_HPP
+#define EXPORT_GIGGLE_OUTPUTQUEUE_HPP
+
+#include "Net.hpp"
+#include "FileCache.hpp"
+
+#include <memory/Buffer.hpp>
+#include <memory/BufferChain.hpp>
+
+#include <deque>
+#include <memory>
+
+#include <sys/uio.h>
+
+namespace giggle::common::net
+{
+
+	/**
+	 * @brief A range of a file to be written to a connection by the kernel.
+	 */
+	struct FileRegion
+	{
+		std::shared_ptr<const File> Source;
+		UInt64 Offset;
+		std::size_t Length;
+	};
+
+	/**
+	 * @brief The bytes waiting to be written to a connection.
+	 *
+	 * Data is kept as a sequence of segments, each one a Buffer handed
+	 * over by the producer, so separately built parts of a message
+	 * (a header and a body, say) never have to be joined. Gather()
+	 * describes the queued segments as an iovec array for a single
+	 * writev/sendmsg call and Consume() drops whatever the kernel took,
+	 * including partially written segments.
+	 *
+	 * A segment may also be a FileRegion, which is written with
+	 * sendfile() instead; Gather() stops in front of it and
+	 * GatherFile() describes it once it reaches the head of the queue.
+	 * Its bytes count towards Bytes() like any other.
+	 *
+	 * Segments are never moved in memory once queued, so the iovecs
+	 * stay valid until the bytes they describe are consumed.
+	 */
+	class OutputQueue
+	{
+	public:
+
+		OutputQueue();
+
+		OutputQueue(const OutputQueue&) = delete;
+		OutputQueue& operator = (const OutputQueue&) = delete;
+
+		/**
+		 * @brief Appends a segment; empty buffers are ignored.
+		 */
+		void Push(memory::Buffer<char>&& l_segment);
+
+		/**
+		 * @brief Appends the segments of a chain, sharing its blocks instead of copying them.
+		 */
+		void Push(const memory::BufferChain& l_chain);
+
+		/**
+		 * @brief Appends a file region; empty regions are ignored.
+		 */
+		void Push(FileRegion&& l_region);
+
+		/**
+		 * @brief Describes up to l_max leading segments in l_vectors,
+		 * stopping at the first file region.
+		 * @return The number of iovecs filled in.
+		 */
+		std::size_t Gather(iovec* l_vectors, std::size_t l_max) const;
+
+		/**
+		 * @brief Describes the unwritten part of the file region at the head of the queue.
+		 * @param l_offset Receives the file offset to continue from.
+		 * @param l_length Receives the number of bytes left.
+		 * @return The file, or nullptr if the queue does not start with a file region.
+		 */
+		const File* GatherFile(UInt64& l_offset, std::size_t& l_length) const;
+
+		/**
+		 * @brief Drops the first l_bytes queued bytes, releasing fully written segments.
+		 */
+		void Consume(std::size_t l_bytes);
+
+		/**
+		 * @brief Drops every queued segment.
+		 */
+		void Clear();
+
+		/**
+		 * @brief Returns the number of bytes waiting to be written.
+		 */
+		std::size_t Bytes() const;
+
+		/**
+		 * @brief Returns the number of queued segments.
+		 */
+		std::size_t Segments() const;
+
+		bool Empty() const;
+
+	private:
+
+		/**
+		 * Either a buffer or, when Data is empty, a file region. Data
+		 * only wraps the bytes of Shared when it came from a BufferChain.
+		 */
+		struct Segment
+		{
+			memory::Buffer<char> Data;
+			FileRegion Region;
+			memory::BufferChain::Segment Shared;
+
+			std::size_t Size() const;
+		};
+
+		std::deque<Segment>					_segments;
+		std::size_t							_offset;
+		std::size_t							_bytes;
+	};
+
+} // namespace net
+
+#endif //EXPORT_GIGGLE_OUTPUTQUEUE_HPP
@@ -0,0 +1,432 @@
+/*
+* export-giggle
+* Reactor.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "Reactor.hpp"
+#include "EpollReactor.hpp"
+#include "UringReactor.hpp"
+
+#include <exceptions/SystemException.hpp>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/sendfile.h>
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+using namespace giggle::common::exception;
+
+std::unique_ptr<Reactor> Reactor::Create(IoBackend l_backend, UInt32 l_index, UInt32 l_port,
+										 UInt32 l_maxConnections, bool l_reusePort,
+										 const Connection::Handlers& l_handlers)
+{
+	if (l_backend == IoBackend::IoUring)
+	{
+#ifdef GIGGLE_NET_HAVE_IO_URING
+		if (IoUring::IsSupported())
+		{
+			try
+			{
+				return std::make_unique<UringReactor>(l_index, l_port, l_maxConnections, l_reusePort, l_handlers);
+			}
+			catch (SystemException& l_exception)
+			{
+				std::cerr << l_exception.what() << std::endl;
+			}
+		}
+#endif
+		std::cerr << "io_uring is not available, falling back to epoll." << std::endl;
+	}
+
+	return std::make_unique<EpollReactor>(l_index, l_port, l_maxConnections, l_reusePort, l_handlers);
+}
+
+Reactor::Reactor(UInt32 l_index, UInt32 l_port, UInt32 l_maxConnections, bool l_reusePort,
+				 const Connection::Handlers& l_handlers):
+	_index(l_index),
+	_port(l_port),
+	_maxConnections(l_maxConnections),
+	_reusePort(l_reusePort),
+	_serverDescriptor(-1),
+	_memoryPool(new memory::MemoryPool(DEFAULT_BLOCK_SIZE, 0, DEFAULT_MAX_BLOCKS)),
+	_timers(new TimerWheel()),
+	_files(new FileCache()),
+	_handlers(l_handlers),
+	_clients(l_maxConnections, l_index),
+	_descriptors(),
+	_closedClients(),
+	_flushing(),
+	_idleDescriptor(-1),
+	_idleTimeout(0),
+	_workers(nullptr),
+	_draining(false),
+	_drainDeadline(0)
+{
+
+}
+
+Reactor::~Reactor()
+{
+	CloseListening();
+
+	// Connections still in the table only outlive the wheel with their timers detached.
+	_closedClients.clear();
+
+	delete _files;
+	delete _timers;
+	delete _memoryPool;
+}
+
+void Reactor::Bind()
+{
+	_serverDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (_serverDescriptor < 0)
+	{
+		std::cerr << std::strerror(errno) << std::endl;
+
+		throw exception::SystemException("Error opening socket.");
+	}
+
+	int enable = 1;
+	setsockopt(_serverDescriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+	if (_reusePort && setsockopt(_serverDescriptor, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0)
+	{
+		std::cerr << std::strerror(errno) << std::endl;
+
+		CloseListening();
+		throw exception::SystemException("Error enabling SO_REUSEPORT.");
+	}
+
+	SocketAddress serverAddress{};
+	serverAddress.sin_family = AF_INET;
+	serverAddress.sin_addr.s_addr = INADDR_ANY;
+	serverAddress.sin_port = htons(_port);
+
+	if (bind(_serverDescriptor, (struct sockaddr *) &serverAddress, sizeof(serverAddress)) < 0)
+	{
+		std::cerr << std::strerror(errno) << std::endl;
+
+		CloseListening();
+		throw exception::SystemException("Error binding socket.");
+	}
+
+	if (listen(_serverDescriptor, SOMAXCONN) != 0)
+	{
+		std::cerr << std::strerror(errno) << std::endl;
+
+		CloseListening();
+		throw exception::SystemException("Error listening on socket.");
+	}
+
+	// Spare descriptor, given up when the process runs out of descriptors
+	// so that pending connections can still be accepted and dropped.
+	_idleDescriptor = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+	OnListening();
+}
+
+void Reactor::Adopt(SocketFileDescriptor l_descriptor)
+{
+	int listening = 0;
+	auto length = static_cast<socklen_t>(sizeof(listening));
+	if (getsockopt(l_descriptor, SOL_SOCKET, SO_ACCEPTCONN, &listening, &length) < 0 || listening == 0)
+	{
+		close(l_descriptor);
+		throw exception::SystemException("Inherited descriptor is not a listening socket.");
+	}
+
+	// The flag is shared with the process the socket came from, which set it as well.
+	fcntl(l_descriptor, F_SETFL, fcntl(l_descriptor, F_GETFL, 0) | O_NONBLOCK);
+	_serverDescriptor = l_descriptor;
+
+	// See Bind().
+	_idleDescriptor = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+	OnListening();
+}
+
+SocketFileDescriptor Reactor::ListeningDescriptor() const
+{
+	return _serverDescriptor;
+}
+
+void Reactor::Schedule(UInt64 l_delay, Task l_task)
+{
+	_timers->Schedule(l_delay, std::move(l_task));
+}
+
+void Reactor::SetIdleTimeout(UInt32 l_milliseconds)
+{
+	_idleTimeout = l_milliseconds;
+}
+
+void Reactor::SetFileCacheSize(std::size_t l_files)
+{
+	_files->SetCapacity(l_files);
+}
+
+void Reactor::Drain(UInt32 l_milliseconds)
+{
+	if (_draining)
+		return;
+
+	_draining = true;
+	_drainDeadline = _timers->Now() + l_milliseconds;
+
+	StopListening();
+	CloseIdleClients();
+}
+
+void Reactor::CloseIdleClients()
+{
+	auto now = _timers->Now();
+
+	// A request may be on its way to a connection that just went quiet, so
+	// only close those that have been idle for a whole check interval.
+	std::vector<Connection*> idle;
+	_clients.ForEach([&idle, now, this](Connection& l_connection)
+					 {
+						 if (now >= _drainDeadline ||
+							 (l_connection.Idle() && now >= l_connection._lastActivity + DRAIN_CHECK_INTERVAL))
+							 idle.push_back(&l_connection);
+					 });
+
+	for (auto client : idle)
+	{
+		client->Close();
+	}
+
+	if (_clients.Size() == 0)
+	{
+		Stop();
+		return;
+	}
+
+	_timers->Schedule(std::min<UInt64>(DRAIN_CHECK_INTERVAL, _drainDeadline - now), [this]()
+					  {
+						  CloseIdleClients();
+					  });
+}
+
+UInt32 Reactor::ConnectedClients() const
+{
+	return _clients.Size();
+}
+
+UInt32 Reactor::Index() const
+{
+	return _index;
+}
+
+threading::ThreadPool* Reactor::Workers() const
+{
+	return _workers;
+}
+
+void Reactor::SetWorkers(threading::ThreadPool* l_workers)
+{
+	_workers = l_workers;
+}
+
+Connection* Reactor::Find(ConnectionId l_id) const
+{
+	return _clients.Find(l_id);
+}
+
+bool Reactor::Contains(ConnectionId l_id) const
+{
+	return _clients.Contains(l_id);
+}
+
+void Reactor::OnReady(Connection&, UInt32)
+{
+
+}
+
+void Reactor::Retire(std::unique_ptr<Connection> l_connection)
+{
+	if (_closedClients.empty())
+	{
+		Post([this]()
+			 {
+				 _closedClients.clear();
+			 });
+	}
+
+	_closedClients.push_back(std::move(l_connection));
+}
+
+Connection* Reactor::AddClient(SocketFileDescriptor l_descriptor, const SocketAddress& l_address)
+{
+	// The table may hold fewer slots than the limit asks for, see ConnectionTable.
+	if (_clients.Size() >= _maxConnections || _clients.Size() >= _clients.Capacity())
+	{
+		close(l_descriptor);
+		return nullptr;
+	}
+
+	int enable = 1;
+	setsockopt(l_descriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+	auto connection = std::make_unique<Connection>(*this, l_descriptor, l_address, _handlers);
+	try
+	{
+		Watch(*connection);
+	}
+	catch (SystemException& l_exception)
+	{
+		std::cerr << l_exception.what() << std::endl;
+		return nullptr;
+	}
+
+	auto pointer = connection.get();
+	pointer->_id = _clients.Insert(std::move(connection));
+
+	if (static_cast<std::size_t>(l_descriptor) >= _descriptors.size())
+		_descriptors.resize(static_cast<std::size_t>(l_descriptor) + 1, nullptr);
+	_descriptors[l_descriptor] = pointer;
+
+	if (_idleTimeout > 0)
+		pointer->SetIdleTimeout(_idleTimeout);
+
+	if (_handlers.OnOpen)
+		_handlers.OnOpen(*pointer);
+
+	return pointer;
+}
+
+Connection* Reactor::FindClient(SocketFileDescriptor l_descriptor)
+{
+	if (l_descriptor < 0 || static_cast<std::size_t>(l_descriptor) >= _descriptors.size())
+		return nullptr;
+
+	return _descriptors[l_descriptor];
+}
+
+void Reactor::RemoveClient(Connection& l_connection)
+{
+	auto connection = _clients.Remove(l_connection.Id());
+	if (connection == nullptr)
+		return;
+
+	_descriptors[connection->Descriptor()] = nullptr;
+
+	Retire(std::move(connection));
+}
+
+void Reactor::CloseClients()
+{
+	std::vector<Connection*> clients;
+	clients.reserve(_clients.Size());
+
+	_clients.ForEach([&clients](Connection& l_connection)
+					 {
+						 clients.push_back(&l_connection);
+					 });
+
+	for (auto client : clients)
+	{
+		client->Close();
+	}
+
+	_closedClients.clear();
+	_flushing.clear();
+}
+
+void Reactor::ScheduleFlush(Connection& l_connection)
+{
+	_flushing.push_back(l_connection.Id());
+}
+
+void Reactor::FlushPending()
+{
+	// Flushing may run handlers that send again, so keep going until nothing is left.
+	std::vector<ConnectionId> flushing;
+
+	while (!_flushing.empty())
+	{
+		flushing.swap(_flushing);
+
+		for (auto id : flushing)
+		{
+			auto connection = _clients.Find(id);
+			if (connection == nullptr)
+				continue;
+
+			connection->_flushScheduled = false;
+			Flush(*connection);
+		}
+
+		flushing.clear();
+	}
+}
+
+ssize_t Reactor::WriteFile(Connection& l_connection, std::size_t& l_requested)
+{
+	UInt64 offset = 0;
+	auto file = l_connection.GatherFile(offset, l_requested);
+
+	// sendfile() moves at most this much per call anyway.
+	l_requested = std::min<std::size_t>(l_requested, 0x7ffff000);
+
+	auto position = static_cast<off_t>(offset);
+	auto written = sendfile(l_connection.Descriptor(), file->Descriptor(), &position, l_requested);
+
+	// The file shrank since it was opened.
+	if (written == 0 && l_requested > 0)
+	{
+		errno = ENODATA;
+		return -1;
+	}
+
+	return written;
+}
+
+void Reactor::StopListening()
+{
+	CloseListening();
+}
+
+void Reactor::CloseListening()
+{
+	if (_serverDescriptor >= 0)
+	{
+		close(_serverDescriptor);
+		_serverDescriptor = -1;
+	}
+
+	if (_idleDescriptor >= 0)
+	{
+		close(_idleDescriptor);
+		_idleDescriptor = -1;
+	}
+}
+
+void Reactor::DropPending()
+{
+	if (_idleDescriptor < 0)
+		return;
+
+	close(_idleDescriptor);
+	_idleDescriptor = accept(_serverDescriptor, nullptr, nullptr);
+	close(_idleDescriptor);
+	_idleDescriptor = open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
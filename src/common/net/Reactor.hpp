@@ -0,0 +1,325 @@
+/*
+* export-giggle
+* Reactor.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_REACTOR_HPP
+#define EXPORT_GIGGLE_REACTOR_HPP
+
+#include "Net.hpp"
+#include "Connection.hpp"
+#include "ConnectionTable.hpp"
+#include "FileCache.hpp"
+#include "TimerWheel.hpp"
+
+#include <memory/MemoryPool.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace giggle::common::threading
+{
+	class ThreadPool;
+}
+
+namespace giggle::common::net
+{
+
+	/**
+	 * @brief One shard of a TcpServer.
+	 *
+	 * A reactor owns a listening socket, the table of connections it
+	 * accepted, the MemoryPool their receive buffers come from, the
+	 * TimerWheel driving their timeouts and delayed tasks and the
+	 * FileCache holding the files they serve.
+	 * Nothing is shared between reactors: when a server runs several
+	 * of them, each listening socket is bound with SO_REUSEPORT and the
+	 * kernel spreads incoming connections across them, so accept, read
+	 * and write never contend on a lock.
+	 *
+	 * How the reactor waits for I/O is left to the subclasses, see
+	 * EpollReactor and UringReactor.
+	 */
+	class Reactor
+	{
+	public:
+		typedef std::function<void()> Task;
+
+		/**
+		 * @brief Creates a reactor for the requested backend. When io_uring
+		 * is requested but not usable on this kernel, an epoll reactor is
+		 * returned instead.
+		 * @throws SystemException
+		 * @param l_backend The preferred backend.
+		 * @param l_index The index of the reactor within its server, encoded in connection ids.
+		 * @param l_port The port to listen on.
+		 * @param l_maxConnections The connections this reactor accepts before dropping new ones.
+		 * @param l_reusePort Whether the listening socket is bound with SO_REUSEPORT.
+		 * @param l_handlers The server's connection handlers.
+		 */
+		static std::unique_ptr<Reactor> Create(IoBackend l_backend, UInt32 l_index, UInt32 l_port,
+											   UInt32 l_maxConnections, bool l_reusePort,
+											   const Connection::Handlers& l_handlers);
+
+		virtual ~Reactor();
+
+		Reactor(const Reactor&) = delete;
+		Reactor& operator = (const Reactor&) = delete;
+
+		/**
+		 * @brief Creates, binds and registers the listening socket.
+		 * @throws SystemException
+		 */
+		void Bind();
+
+		/**
+		 * @brief Registers a listening socket inherited from another process
+		 * instead of binding a new one, see HandOff. The reactor takes ownership.
+		 * @throws SystemException if the descriptor is not a listening socket.
+		 */
+		void Adopt(SocketFileDescriptor l_descriptor);
+
+		/**
+		 * @brief Returns the listening socket, or -1 once it was closed.
+		 */
+		SocketFileDescriptor ListeningDescriptor() const;
+
+		/**
+		 * @brief Runs the reactor on the calling thread until Stop() is called,
+		 * then closes every connection and the listening socket.
+		 */
+		virtual void Run() = 0;
+
+		/**
+		 * @brief Stops the reactor. Safe to call from any thread and from signal handlers.
+		 */
+		virtual void Stop() = 0;
+
+		/**
+		 * @brief Queues a task to be executed on the reactor thread. Safe to call from any thread.
+		 */
+		virtual void Post(Task l_task) = 0;
+
+		/**
+		 * @brief Returns the backend actually used by this reactor.
+		 */
+		virtual IoBackend Backend() const = 0;
+
+		/**
+		 * @brief Runs a task on the reactor thread l_delay milliseconds from now.
+		 * Must be called from the reactor thread; use Post() to get there.
+		 */
+		void Schedule(UInt64 l_delay, Task l_task);
+
+		/**
+		 * @brief Sets the idle timeout applied to connections accepted from now on.
+		 * @param l_milliseconds The timeout, or 0 to keep idle connections open.
+		 */
+		void SetIdleTimeout(UInt32 l_milliseconds);
+
+		/**
+		 * @brief Sets the number of files kept open for Connection::SendFile().
+		 * Must be called before Run() or from the reactor thread.
+		 */
+		void SetFileCacheSize(std::size_t l_files);
+
+		/**
+		 * @brief Stops accepting and closes the listening socket, then closes
+		 * every connection as soon as it is idle, see Connection::Idle(), and
+		 * stops once none are left. Connections still busy after the deadline
+		 * are closed regardless. Must be called from the reactor thread.
+		 * @param l_milliseconds The deadline from now.
+		 */
+		void Drain(UInt32 l_milliseconds);
+
+		/**
+		 * @brief Returns the number of connections currently served by this reactor. Thread safe.
+		 */
+		UInt32 ConnectedClients() const;
+
+		/**
+		 * @brief Returns the index of the reactor within its server.
+		 */
+		UInt32 Index() const;
+
+		/**
+		 * @brief Returns the pool of workers placed next to this reactor,
+		 * see TcpServerOptions::WorkersPerReactor, or nullptr if it has none.
+		 */
+		threading::ThreadPool* Workers() const;
+		void SetWorkers(threading::ThreadPool* l_workers);
+
+		/**
+		 * @brief Returns the open connection with the given id, or nullptr.
+		 * Must be called from the reactor thread.
+		 */
+		Connection* Find(ConnectionId l_id) const;
+
+		/**
+		 * @brief Returns true if the id belongs to an open connection of this
+		 * reactor. Thread safe and lock-free.
+		 */
+		bool Contains(ConnectionId l_id) const;
+
+		/**
+		 * @brief Invokes l_callback(Connection&) for every open connection.
+		 * Must be called from the reactor thread; the callback may send but
+		 * must not close connections.
+		 */
+		template <class F>
+		void ForEachClient(F&& l_callback) const
+		{
+			_clients.ForEach(std::forward<F>(l_callback));
+		}
+
+	protected:
+
+		friend class Connection;
+
+		Reactor(UInt32 l_index, UInt32 l_port, UInt32 l_maxConnections, bool l_reusePort,
+				const Connection::Handlers& l_handlers);
+
+		/**
+		 * @brief Starts waiting for connections on the bound listening socket.
+		 */
+		virtual void OnListening() = 0;
+
+		/**
+		 * @brief Stops waiting for connections and closes the listening socket.
+		 */
+		virtual void StopListening();
+
+		/**
+		 * @brief Starts I/O on a freshly accepted connection.
+		 * @throws SystemException
+		 */
+		virtual void Watch(Connection& l_connection) = 0;
+
+		/**
+		 * @brief Stops I/O on a connection that is being closed.
+		 */
+		virtual void Unwatch(Connection& l_connection) = 0;
+
+		/**
+		 * @brief Writes as much of the connection's output queue as the socket
+		 * takes, or starts doing so asynchronously.
+		 */
+		virtual void Flush(Connection& l_connection) = 0;
+
+		/**
+		 * @brief Resumes reading from a connection whose output queue drained
+		 * below the low watermark or whose reading was resumed. Backends stop
+		 * reading from connections that are not Readable().
+		 */
+		virtual void Resume(Connection& l_connection) = 0;
+
+		/**
+		 * @brief Flushes every connection that queued data since the last call.
+		 * Backends call this once per iteration, after handling events and
+		 * posted tasks, so all sends of an iteration share the same writes.
+		 */
+		void FlushPending();
+
+		/**
+		 * @brief Writes the file region at the head of the connection's
+		 * output queue to its socket with sendfile().
+		 * @param l_requested Receives the number of bytes asked for.
+		 * @return The number of bytes written, or -1 with errno set; a region
+		 * reaching past the end of a truncated file fails with ENODATA.
+		 */
+		ssize_t WriteFile(Connection& l_connection, std::size_t& l_requested);
+
+		/**
+		 * @brief Receives readiness events for connections registered with an EventLoop.
+		 */
+		virtual void OnReady(Connection& l_connection, UInt32 l_events);
+
+		/**
+		 * @brief Takes ownership of a closed connection and destroys it once
+		 * it is safe to do so. By default that is after the current batch of
+		 * events, since the connection may be closing from inside its own handler.
+		 */
+		virtual void Retire(std::unique_ptr<Connection> l_connection);
+
+		/**
+		 * @brief Creates and watches a connection for an accepted descriptor.
+		 * The descriptor is closed if the connection limit is reached.
+		 * @return The connection, or nullptr if it was rejected.
+		 */
+		Connection* AddClient(SocketFileDescriptor l_descriptor, const SocketAddress& l_address);
+
+		/**
+		 * @brief Returns the open connection using the descriptor, or nullptr.
+		 * Descriptors are small integers, so this is a plain array lookup.
+		 */
+		Connection* FindClient(SocketFileDescriptor l_descriptor);
+
+		/**
+		 * @brief Closes every connection; used when the reactor stops.
+		 */
+		void CloseClients();
+
+		/**
+		 * @brief Closes the listening socket.
+		 */
+		void CloseListening();
+
+		/**
+		 * @brief Accepts and drops one pending connection after the process
+		 * ran out of descriptors, so the backlog does not stall.
+		 */
+		void DropPending();
+
+		const UInt32 _index;
+		const UInt32 _port;
+		const UInt32 _maxConnections;
+		const bool _reusePort;
+
+		SocketFileDescriptor _serverDescriptor;
+
+		memory::MemoryPool* _memoryPool;
+
+		TimerWheel* _timers;
+
+		FileCache* _files;
+
+		const Connection::Handlers& _handlers;
+
+	private:
+
+		void RemoveClient(Connection& l_connection);
+		void ScheduleFlush(Connection& l_connection);
+		void CloseIdleClients();
+
+		ConnectionTable _clients;
+		std::vector<Connection*> _descriptors;
+		std::vector<std::unique_ptr<Connection>> _closedClients;
+		std::vector<ConnectionId> _flushing;
+
+		SocketFileDescriptor _idleDescriptor;
+
+		UInt32 _idleTimeout;
+		threading::ThreadPool* _workers;
+
+		bool _draining;
+		UInt64 _drainDeadline;
+	};
+
+} // namespace net
+
+#endif //EXPORT_GIGGLE_REACTOR_HPP
@@ -17,187 +17,487 @@
 */
 
 #include "TcpServer.hpp"
+#include "HandOff.hpp"
 
 #include <exceptions/SystemException.hpp>
-#include <memory/MemoryPool.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
-#include <arpa/inet.h>
+#include <mutex>
+#include <thread>
+#include <csignal>
+#include <fcntl.h>
 
+using namespace giggle::common;
 using namespace giggle::common::net;
 using namespace giggle::common::exception;
 using namespace giggle::common::threading;
-using namespace giggle::common::memory;
 
-TcpServer::TcpServer(UInt32 l_port, UInt32 l_maxConnections):
-	_clientAddress{}, _serverAddress{},
-	_port(l_port), _running(false),
-	_maxConnections(l_maxConnections),
-	_connectedClients(0),
-	_clients(),
-	_threadPool(new threading::ThreadPool(_maxConnections / 2)),
-	_memoryPool(new memory::MemoryPool(DEFAULT_BLOCK_SIZE, 10, DEFAULT_MAX_BLOCKS))
+TcpServer::TcpServer(UInt32 l_port, UInt32 l_maxConnections, UInt32 l_reactors):
+	TcpServer(l_port, TcpServerOptions{l_maxConnections, l_reactors})
 {
 
 }
 
-TcpServer::~TcpServer()
+TcpServer::TcpServer(UInt32 l_port, const TcpServerOptions& l_options):
+	_port(l_port),
+	_maxConnections(l_options.MaxConnections),
+	_reactors(),
+	_cpus(),
+	_workers(),
+	_listeners(),
+	_handlers(),
+	_running(false),
+	_draining(false)
 {
-	if (_running)
-	{
-		_running = false;
-		Close();
-	}
+	auto reactors = l_options.Reactors;
+	if (reactors == 0)
+		reactors = std::max(1U, std::thread::hardware_concurrency());
 
-	delete _threadPool;
+	CreateReactors(std::min(reactors, MAX_REACTORS), l_options);
 }
 
-void TcpServer::Close()
+TcpServer::TcpServer(std::vector<SocketFileDescriptor> l_listeners, const TcpServerOptions& l_options):
+	_port(l_listeners.empty() ? 0 : PortOf(l_listeners.front())),
+	_maxConnections(l_options.MaxConnections),
+	_reactors(),
+	_cpus(),
+	_workers(),
+	_listeners(std::move(l_listeners)),
+	_handlers(),
+	_running(false),
+	_draining(false)
 {
-	if(_running)
+	if (_listeners.empty() || _listeners.size() > MAX_REACTORS)
 	{
-		_running = false;
-		for(auto client : _clients)
+		for (auto listener : _listeners)
 		{
-			std::cout << "Removing client " << client << "." << std::endl;
-			close(client);
+			close(listener);
 		}
-		std::cout << "Closing server descriptor" << std::endl;
-		close(_serverDescriptor);
+
+		throw SystemException("Expected between 1 and " + std::to_string(MAX_REACTORS) + " listening sockets.");
 	}
-}
 
-void TcpServer::Listen()
-{
-	_serverDescriptor = socket(AF_INET, SOCK_STREAM, 0);
-	if (_serverDescriptor < 0)
+	try
+	{
+		CreateReactors(static_cast<UInt32>(_listeners.size()), l_options);
+	}
+	catch (...)
 	{
-		std::cerr << std::strerror(errno) << std::endl;
+		// The destructor does not run for a constructor that throws.
+		for (auto listener : _listeners)
+		{
+			close(listener);
+		}
 
-		throw exception::SystemException("Error opening socket.");
+		throw;
 	}
+}
 
-	bzero((char *) &_serverAddress, sizeof(_serverAddress));
+void TcpServer::CreateReactors(UInt32 l_reactors, const TcpServerOptions& l_options)
+{
+	auto reactorConnections = (_maxConnections + l_reactors - 1) / l_reactors;
 
-	_serverAddress.sin_family = AF_INET;
-	_serverAddress.sin_addr.s_addr = INADDR_ANY;
-	_serverAddress.sin_port = htons(_port);
+	for (UInt32 i = 0; i < l_reactors; ++i)
+	{
+		_reactors.push_back(Reactor::Create(l_options.Backend, i, _port, reactorConnections, l_reactors > 1, _handlers));
+		_reactors.back()->SetIdleTimeout(l_options.IdleTimeout);
+		_reactors.back()->SetFileCacheSize(l_options.FileCacheSize);
+	}
+
+	_cpus.resize(l_reactors);
 
-	if (bind(_serverDescriptor, (struct sockaddr *) &_serverAddress, sizeof(_serverAddress)) < 0)
+	if (l_options.PinReactors)
 	{
-		std::cerr << std::strerror(errno) << std::endl;
+		auto nodes = NumaNodes();
+
+		for (UInt32 i = 0; i < l_reactors; ++i)
+		{
+			// Reactors sharing a node split its CPUs into contiguous slices.
+			auto& node = nodes[i % nodes.size()];
+			auto sharing = (l_reactors - i % nodes.size() + nodes.size() - 1) / nodes.size();
+			auto rank = i / nodes.size();
 
-		close(_serverDescriptor);
-		throw exception::SystemException("Error binding socket.");
+			if (node.size() >= sharing)
+				_cpus[i].assign(node.begin() + rank * node.size() / sharing, node.begin() + (rank + 1) * node.size() / sharing);
+			else
+				_cpus[i].push_back(node[rank % node.size()]);
+		}
 	}
 
-	if (listen(_serverDescriptor, _maxConnections) != 0)
+	for (UInt32 i = 0; i < l_reactors && l_options.WorkersPerReactor > 0; ++i)
 	{
-		std::cerr << std::strerror(errno) << std::endl;
+		ThreadPoolOptions options;
+		options.Name = "worker" + std::to_string(i);
+		options.Cpus = _cpus[i];
 
-		close(_serverDescriptor);
+		_workers.emplace_back(new ThreadPool(l_options.WorkersPerReactor, options));
+		_reactors[i]->SetWorkers(_workers.back().get());
 	}
+}
 
-	_running = true;
-
-	auto clientLength = static_cast<unsigned int>(sizeof(_clientAddress));
+void TcpServer::RunReactor(std::size_t l_index, bool l_name)
+{
+	auto thread = pthread_self();
+	CpuList previous;
 
-	std::cout << "Ready to accept connections..." << std::endl;
+	if (l_name)
+		SetThreadName(thread, "reactor" + std::to_string(l_index));
 
-	while (true)
+	if (!_cpus[l_index].empty())
 	{
+		try
+		{
+			previous = GetAffinity(thread);
+			SetAffinity(thread, _cpus[l_index]);
+		}
+		catch (SystemException& l_exception)
+		{
+			std::cerr << l_exception.what() << std::endl;
+			previous.clear();
+		}
+	}
 
-		_clientDescriptor = accept(_serverDescriptor, (struct sockaddr *) &_clientAddress, &clientLength);
+	_reactors[l_index]->Run();
 
-		if (_clientDescriptor < 0)
+	if (!previous.empty())
+	{
+		try
 		{
-			std::cerr << std::strerror(errno) << std::endl;
+			SetAffinity(thread, previous);
 		}
-		else
+		catch (SystemException&)
 		{
-			_connectedClients++;
+		}
+	}
+}
 
-			if (_connectedClients > _maxConnections)
-			{
-				close(_clientDescriptor);
-				_connectedClients--;
-			}
-			else
-			{
-				_clients.push_back(_clientDescriptor);
+UInt32 TcpServer::PortOf(SocketFileDescriptor l_descriptor)
+{
+	SocketAddress address{};
+	auto length = static_cast<socklen_t>(sizeof(address));
+	if (getsockname(l_descriptor, reinterpret_cast<sockaddr*>(&address), &length) < 0)
+		return 0;
 
-				auto connection = GetClient(_clientDescriptor);
+	return ntohs(address.sin_port);
+}
 
-				_threadPool->enqueue([](ClientConnection l_connection)
-									 {
-										TcpServer::HandleConnection(l_connection);
-									 }, connection);
-			}
-		}
+TcpServer::~TcpServer()
+{
+	Close();
 
-		if (!_running)
-		{
-			break;
-		}
+	// Inherited sockets Listen() never got to hand to a reactor.
+	for (auto listener : _listeners)
+	{
+		close(listener);
 	}
+}
+
+void TcpServer::SetReceiveHandler(ReceiveHandler l_handler)
+{
+	_handlers.OnReceive = std::move(l_handler);
+}
 
+void TcpServer::SetFrameHandler(FrameHandler l_handler)
+{
+	_handlers.OnFrame = std::move(l_handler);
 }
 
-auto operator""_MB( unsigned long long const x )
--> long
-{ return static_cast<long>(1024L * 1024L * x); }
+void TcpServer::SetWritableHandler(WritableHandler l_handler)
+{
+	_handlers.OnWritable = std::move(l_handler);
+}
 
-TcpServer::ClientConnection TcpServer::GetClient(SocketFileDescriptor l_descriptor)
+void TcpServer::SetOpenHandler(OpenHandler l_handler)
 {
-	struct sockaddr_in addr{};
-	auto addr_size = static_cast<socklen_t>(sizeof(struct sockaddr_in));
+	_handlers.OnOpen = std::move(l_handler);
+}
 
-	getpeername(l_descriptor, (struct sockaddr *)&addr, &addr_size);
+void TcpServer::SetCloseHandler(CloseHandler l_handler)
+{
+	_handlers.OnClose = std::move(l_handler);
+}
 
-	auto client_ip = new char[30];
-	strcpy(client_ip, inet_ntoa(addr.sin_addr));
+bool TcpServer::Send(ConnectionId l_id, memory::Buffer<char> l_segment)
+{
+	auto reactor = Owner(l_id);
+	if (reactor == nullptr)
+		return false;
+
+	reactor->Post([reactor, l_id, segment = std::move(l_segment)]() mutable
+				  {
+					  auto connection = reactor->Find(l_id);
+					  if (connection != nullptr)
+						  connection->Send(std::move(segment));
+				  });
+	return true;
+}
 
-	ClientConnection connection {};
-	connection.Authenticated 			= false;
-	connection.Connected 				= true,
-	connection.Descriptor 				= l_descriptor;
-	connection.IPAddress 				= client_ip;
-	connection.Port 					= ntohs(addr.sin_port);
-	connection.Buffer 					= static_cast<char *>(_memoryPool->GetMemory());
+bool TcpServer::Send(ConnectionId l_id, memory::BufferChain l_chain)
+{
+	auto reactor = Owner(l_id);
+	if (reactor == nullptr)
+		return false;
+
+	reactor->Post([reactor, l_id, chain = std::move(l_chain)]()
+				  {
+					  auto connection = reactor->Find(l_id);
+					  if (connection != nullptr)
+						  connection->Send(chain);
+				  });
+	return true;
+}
 
-	return connection;
+bool TcpServer::Disconnect(ConnectionId l_id)
+{
+	auto reactor = Owner(l_id);
+	if (reactor == nullptr)
+		return false;
+
+	reactor->Post([reactor, l_id]()
+				  {
+					  auto connection = reactor->Find(l_id);
+					  if (connection != nullptr)
+						  connection->Close();
+				  });
+	return true;
 }
 
-void * TcpServer::HandleConnection(ClientConnection l_connection)
+void TcpServer::Broadcast(const char* l_data, std::size_t l_length)
 {
-	// FIXME: This is not allocating the desired memory correctly.
-	auto buffer = l_connection.Buffer;
+	auto payload = std::make_shared<memory::Buffer<char>>(l_data, l_length);
 
-	std::cout << "Client buffer size: " << sizeof(l_connection.Buffer) << " bytes" << std::endl;
+	for (auto& reactor : _reactors)
+	{
+		auto owner = reactor.get();
+		owner->Post([owner, payload]()
+					{
+						owner->ForEachClient([&payload](Connection& l_connection)
+											 {
+												 l_connection.Send(payload->Begin(), payload->Size());
+											 });
+					});
+	}
+}
 
-	while (l_connection.Connected)
+void TcpServer::Broadcast(const memory::BufferChain& l_chain)
+{
+	for (auto& reactor : _reactors)
 	{
-		auto bytesRead = recv(l_connection.Descriptor, buffer, sizeof(buffer), 0);
+		auto owner = reactor.get();
+		owner->Post([owner, l_chain]()
+					{
+						owner->ForEachClient([&l_chain](Connection& l_connection)
+											 {
+												 l_connection.Send(l_chain);
+											 });
+					});
+	}
+}
 
-		if (bytesRead == -1)
+bool TcpServer::Connected(ConnectionId l_id) const
+{
+	return Owner(l_id) != nullptr;
+}
+
+Reactor* TcpServer::Owner(ConnectionId l_id) const
+{
+	auto index = ConnectionTable::ReactorOf(l_id);
+	if (index >= _reactors.size() || !_reactors[index]->Contains(l_id))
+		return nullptr;
+
+	return _reactors[index].get();
+}
+
+UInt32 TcpServer::ConnectedClients() const
+{
+	UInt32 connected = 0;
+	for (auto& reactor : _reactors)
+	{
+		connected += reactor->ConnectedClients();
+	}
+	return connected;
+}
+
+UInt32 TcpServer::Reactors() const
+{
+	return static_cast<UInt32>(_reactors.size());
+}
+
+IoBackend TcpServer::Backend() const
+{
+	return _reactors.front()->Backend();
+}
+
+void TcpServer::Drain(UInt32 l_milliseconds)
+{
+	if (!_running || _draining.exchange(true))
+		return;
+
+	for (auto& reactor : _reactors)
+	{
+		auto owner = reactor.get();
+		owner->Post([owner, l_milliseconds]()
+					{
+						owner->Drain(l_milliseconds);
+					});
+	}
+}
+
+void TcpServer::HandOff(const std::string& l_path)
+{
+	if (!_running || _draining)
+	{
+		throw SystemException("The server is not listening.");
+	}
+
+	// Each reactor duplicates its own listening socket on its thread, so a
+	// Drain() closing it concurrently cannot hand over a stale or reused number.
+	struct Collected
+	{
+		std::mutex					Mutex;
+		std::condition_variable		Done;
+		std::vector<SocketFileDescriptor> Descriptors;
+		std::size_t					Pending;
+		bool						Abandoned;
+	};
+
+	auto collected = std::make_shared<Collected>();
+	collected->Descriptors.assign(_reactors.size(), -1);
+	collected->Pending = _reactors.size();
+	collected->Abandoned = false;
+
+	for (std::size_t i = 0; i < _reactors.size(); ++i)
+	{
+		auto owner = _reactors[i].get();
+		owner->Post([owner, collected, i]()
+					{
+						std::lock_guard<std::mutex> lock{collected->Mutex};
+						if (collected->Abandoned)
+							return;
+
+						auto listener = owner->ListeningDescriptor();
+						if (listener >= 0)
+							collected->Descriptors[i] = fcntl(listener, F_DUPFD_CLOEXEC, 0);
+
+						--collected->Pending;
+						collected->Done.notify_one();
+					});
+	}
+
+	std::vector<SocketFileDescriptor> listeners;
+	{
+		std::unique_lock<std::mutex> lock{collected->Mutex};
+		auto done = collected->Done.wait_for(lock, std::chrono::milliseconds(HANDOFF_COLLECT_TIMEOUT),
+											 [&collected]() { return collected->Pending == 0; });
+
+		// Reactors that have not answered yet skip the task when they get to it.
+		collected->Abandoned = true;
+		listeners.swap(collected->Descriptors);
+
+		if (!done)
+			listeners.push_back(-1);
+	}
+
+	auto release = [&listeners]()
+	{
+		for (auto listener : listeners)
+		{
+			if (listener >= 0)
+				close(listener);
+		}
+	};
+
+	if (std::find(listeners.begin(), listeners.end(), -1) != listeners.end())
+	{
+		release();
+		throw SystemException("The server is not listening.");
+	}
+
+	try
+	{
+		net::HandOff::Send(l_path, listeners);
+	}
+	catch (...)
+	{
+		release();
+		throw;
+	}
+
+	release();
+}
+
+void TcpServer::Close()
+{
+	if (_running.exchange(false))
+	{
+		for (auto& reactor : _reactors)
+		{
+			reactor->Stop();
+		}
+	}
+}
+
+void TcpServer::Listen()
+{
+	// Writing file regions to a peer that went away must not kill the process.
+	struct sigaction action{};
+	if (sigaction(SIGPIPE, nullptr, &action) == 0 && action.sa_handler == SIG_DFL)
+	{
+		signal(SIGPIPE, SIG_IGN);
+	}
+
+	for (std::size_t i = 0; i < _reactors.size(); ++i)
+	{
+		if (_listeners.empty())
 		{
-			std::cerr << std::strerror(errno) << std::endl;
-			break;
+			_reactors[i]->Bind();
+			continue;
 		}
 
-		std::cout << "Bytes Read: " << bytesRead << std::endl;
-		std::cout << "Received: " << std::endl;
+		auto listener = _listeners[i];
+		_listeners[i] = -1;
+		_reactors[i]->Adopt(listener);
+	}
+	_listeners.clear();
+
+	_running = true;
+
+	std::vector<std::thread> threads;
+	for (std::size_t i = 1; i < _reactors.size(); ++i)
+	{
+		threads.emplace_back([this, i]()
+							 {
+								 RunReactor(i, true);
+							 });
+	}
+
+	std::cout << "Ready to accept connections..." << std::endl;
 
-		for (int i = 0; i < bytesRead + 1; ++i) {
-			std::cout << buffer[i];
+	// The calling thread keeps its name, which is the process's as well.
+	RunReactor(0, false);
 
+	// The first reactor may also return on its own, so make sure the others
+	// follow, unless it simply finished draining before them.
+	if (!_draining)
+	{
+		for (auto& reactor : _reactors)
+		{
+			reactor->Stop();
 		}
+	}
+	_running = false;
 
-		if(!l_connection.Connected)
-			break;
+	for (auto& thread : threads)
+	{
+		thread.join();
 	}
 
-	// Returns the buffer so it can be properly freed from memory
-	return l_connection.Buffer;
+	std::cout << "Closing server descriptor" << std::endl;
 }
 
-
+const CpuList& TcpServer::ReactorCpus(UInt32 l_reactor) const
+{
+	return _cpus.at(l_reactor);
+}
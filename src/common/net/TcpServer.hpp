@@ -20,59 +20,246 @@
 #define EXPORT_GIGGLE_TCPSERVER_HPP
 
 #include "Net.hpp"
+#include "Reactor.hpp"
 
-#include <threading/ThreadPool.hpp>
 #include <memory/MemoryPool.hpp>
 #include <memory/Buffer.hpp>
+#include <threading/ThreadPool.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace giggle::common::net
 {
 
+	/**
+	 * @brief Tuning knobs for a TcpServer.
+	 */
+	struct TcpServerOptions
+	{
+		/// The total connections accepted, split evenly between reactors.
+		UInt32 MaxConnections = DEFAULT_MAX_CONNECTIONS;
+
+		/// The number of reactors; 0 starts one per hardware thread.
+		UInt32 Reactors = 1;
+
+		/// The I/O backend; io_uring falls back to epoll at runtime when unavailable.
+		IoBackend Backend = IoBackend::Epoll;
+
+		/// Milliseconds without traffic after which a client is disconnected; 0 disables it.
+		UInt32 IdleTimeout = 0;
+
+		/// The number of files each reactor keeps open for Connection::SendFile().
+		UInt32 FileCacheSize = DEFAULT_FILE_CACHE_SIZE;
+		/// Workers in a ThreadPool next to each reactor, see Reactor::Workers(); 0 creates none.
+		UInt32 WorkersPerReactor = 0;
+		/// Confines each reactor thread and its workers to a share of one NUMA node's CPUs,
+		/// handing out nodes round-robin, so they share caches and local memory.
+		bool PinReactors = false;
+	};
+
+	/**
+	 * @brief A TCP server driven by one or more reactors.
+	 *
+	 * The listening socket and every accepted client are non-blocking
+	 * and multiplexed on a Reactor, either through edge-triggered epoll
+	 * or through io_uring completions, so the number of live connections
+	 * is bound by descriptors and memory rather than by threads. CPU
+	 * time is only spent on sockets the kernel reports as ready.
+	 *
+	 * With more than one reactor, each one binds its own SO_REUSEPORT
+	 * listening socket and runs on its own thread with its own
+	 * connection table and MemoryPool, so accepting, reading and
+	 * writing scale across cores without shared locks.
+	 */
 	class TcpServer
 	{
 	public:
-		explicit TcpServer(UInt32 l_port, UInt32 l_maxConnections = DEFAULT_MAX_CONNECTIONS);
+		typedef Connection::ReceiveHandler ReceiveHandler;
+		typedef Connection::FrameHandler FrameHandler;
+		typedef Connection::WritableHandler WritableHandler;
+		typedef Connection::OpenHandler OpenHandler;
+		typedef Connection::CloseHandler CloseHandler;
+
+		/**
+		 * @brief Creates the server.
+		 * @param l_port The port to listen on.
+		 * @param l_maxConnections The total connections accepted, split evenly between reactors.
+		 * @param l_reactors The number of reactors; 0 starts one per hardware thread.
+		 */
+		explicit TcpServer(UInt32 l_port, UInt32 l_maxConnections = DEFAULT_MAX_CONNECTIONS, UInt32 l_reactors = 1);
+
+		/**
+		 * @brief Creates the server.
+		 * @param l_port The port to listen on.
+		 * @param l_options The server options.
+		 */
+		TcpServer(UInt32 l_port, const TcpServerOptions& l_options);
+
+		/**
+		 * @brief Creates a server for listening sockets handed off by the
+		 * process it replaces, see HandOff::Receive(). Listen() serves them
+		 * as they are, one reactor per socket; Reactors in the options is ignored.
+		 * @param l_listeners The inherited listening sockets, owned by the server from now on.
+		 * @param l_options The server options.
+		 */
+		TcpServer(std::vector<SocketFileDescriptor> l_listeners, const TcpServerOptions& l_options);
 		~TcpServer();
 
 		TcpServer(const TcpServer& l_other) = delete;
 		TcpServer & operator = (const TcpServer&) = delete;
 
+		/**
+		 * @brief Sets the handler invoked with the bytes read from a client.
+		 * Must be set before calling Listen(). With several reactors the
+		 * handler is invoked concurrently from each reactor thread.
+		 */
+		void SetReceiveHandler(ReceiveHandler l_handler);
+
+		/**
+		 * @brief Sets the handler invoked with every complete frame read from
+		 * a client. Each frame is a 4 byte big-endian payload length followed
+		 * by the payload; the handler receives a view of the payload, which
+		 * points into the reactor's receive buffer whenever the frame arrived
+		 * in one read. Clients sending frames over DEFAULT_MAX_FRAME_SIZE
+		 * are disconnected. Must be set before calling Listen().
+		 */
+		void SetFrameHandler(FrameHandler l_handler);
+
+		/**
+		 * @brief Sets the handler invoked when a client that refused sends
+		 * because it was reading too slowly has caught up again, see
+		 * Connection::Send(). Must be set before calling Listen().
+		 */
+		void SetWritableHandler(WritableHandler l_handler);
+
+		/**
+		 * @brief Sets the handlers invoked when a client was accepted and
+		 * when it closed, on the reactor thread serving it. The close
+		 * handler runs for every client, including those closed when the
+		 * server stops. Must be set before calling Listen().
+		 */
+		void SetOpenHandler(OpenHandler l_handler);
+		void SetCloseHandler(CloseHandler l_handler);
+
+		/**
+		 * @brief Binds the server sockets and runs the reactors until Close()
+		 * is called. The first reactor runs on the calling thread.
+		 * SIGPIPE is ignored from then on unless the process handles it,
+		 * since sendfile() cannot be told not to raise it.
+		 * @throws SystemException
+		 */
 		void Listen();
+
+		/**
+		 * @brief Stops every reactor; Listen() closes every client and the
+		 * server descriptors before returning. Safe to call from signal handlers.
+		 */
 		void Close();
 
-	private:
+		/**
+		 * @brief Stops accepting new clients and closes the listening sockets,
+		 * then closes every client as soon as it has no partially received
+		 * frame and nothing left to write. Listen() returns once every client
+		 * is gone, or after the deadline, which closes the remaining ones
+		 * regardless. Thread safe.
+		 * @param l_milliseconds The deadline from now.
+		 */
+		void Drain(UInt32 l_milliseconds);
 
-		typedef struct {
-			SocketFileDescriptor Descriptor;
-			std::string IPAddress;
-			UInt16 Port;
-			bool Connected;
-			bool Authenticated;
-			char* Buffer;
-		} ClientConnection;
+		/**
+		 * @brief Passes the listening sockets to a replacement process waiting
+		 * in HandOff::Receive() at l_path. Call it while the server is listening
+		 * and before Drain(), which closes this process's copies. Thread safe:
+		 * each reactor duplicates its socket on its own thread, so the call
+		 * fails rather than sending a closed descriptor if a Drain() overlaps.
+		 * @throws SystemException
+		 */
+		void HandOff(const std::string& l_path);
 
-		static void * HandleConnection(ClientConnection l_connection);
+		/**
+		 * @brief Queues a segment for the client with the given id. Thread safe;
+		 * the send happens on the client's reactor thread. Handlers running on
+		 * that thread should call Connection::Send() directly instead.
+		 * @return false if no client with that id is connected.
+		 */
+		bool Send(ConnectionId l_id, memory::Buffer<char> l_segment);
 
-		ClientConnection GetClient(SocketFileDescriptor l_descriptor);
+		/**
+		 * @brief Queues the bytes of a chain for the client with the given id,
+		 * sharing its blocks. Thread safe, see Send(ConnectionId, Buffer).
+		 * @return false if no client with that id is connected.
+		 */
+		bool Send(ConnectionId l_id, memory::BufferChain l_chain);
 
-		const UInt32 _port;
-		const UInt32 _maxConnections;
+		/**
+		 * @brief Closes the client with the given id. Thread safe.
+		 * @return false if no client with that id is connected.
+		 */
+		bool Disconnect(ConnectionId l_id);
+
+		/**
+		 * @brief Sends a copy of the data to every connected client. Thread safe.
+		 */
+		void Broadcast(const char* l_data, std::size_t l_length);
+
+		/**
+		 * @brief Sends the bytes of a chain to every connected client. Every
+		 * connection shares the chain's blocks, so nothing is copied. Thread safe.
+		 */
+		void Broadcast(const memory::BufferChain& l_chain);
+
+		/**
+		 * @brief Returns true if a client with the given id is connected.
+		 * Thread safe and lock-free.
+		 */
+		bool Connected(ConnectionId l_id) const;
 
-		UInt32 _connectedClients;
+		/**
+		 * @brief Returns the number of currently connected clients.
+		 */
+		UInt32 ConnectedClients() const;
 
-		std::vector<SocketFileDescriptor> _clients;
+		/**
+		 * @brief Returns the number of reactors serving this server.
+		 */
+		UInt32 Reactors() const;
 
-		SocketAddress _serverAddress;
-		SocketAddress _clientAddress;
+		/**
+		 * @brief Returns the I/O backend in use, after any runtime fallback.
+		 */
+		IoBackend Backend() const;
+
+		/**
+		 * @brief Returns the CPUs the reactor with the given index, and its
+		 * workers, are confined to; empty unless PinReactors is set.
+		 */
+		const threading::CpuList& ReactorCpus(UInt32 l_reactor) const;
+
+	private:
+
+		Reactor* Owner(ConnectionId l_id) const;
+		void CreateReactors(UInt32 l_reactors, const TcpServerOptions& l_options);
+		/// Runs a reactor on the calling thread, placed on its CPUs.
+		void RunReactor(std::size_t l_index, bool l_name);
+
+		static UInt32 PortOf(SocketFileDescriptor l_descriptor);
+
+		const UInt32 _port;
+		const UInt32 _maxConnections;
 
-		SocketFileDescriptor _serverDescriptor;
-		SocketFileDescriptor _clientDescriptor;
+		std::vector<std::unique_ptr<Reactor>> _reactors;
+		std::vector<threading::CpuList> _cpus;
+		/// Declared after the reactors, so they are still there while workers finish their tasks.
+		std::vector<std::unique_ptr<threading::ThreadPool>> _workers;
+		std::vector<SocketFileDescriptor> _listeners;
 
-		threading::ThreadPool* _threadPool;
-		// threading::FastMutex _mutex;
-		memory::MemoryPool* _memoryPool;
+		Connection::Handlers _handlers;
 
-		bool _running;
+		std::atomic_bool _running;
+		std::atomic_bool _draining;
 	};
 
 } // namespace net
@@ -0,0 +1,327 @@
+/*
+* export-giggle
+* TimerWheel.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+
+Timer::Timer():
+	_wheel(nullptr),
+	_expiry(0),
+	_callback()
+{
+
+}
+
+Timer::Timer(Callback l_callback):
+	_wheel(nullptr),
+	_expiry(0),
+	_callback(std::move(l_callback))
+{
+
+}
+
+Timer::~Timer()
+{
+	if (_wheel != nullptr)
+		_wheel->Cancel(*this);
+}
+
+void Timer::SetCallback(Callback l_callback)
+{
+	_callback = std::move(l_callback);
+}
+
+bool Timer::Armed() const
+{
+	return _wheel != nullptr;
+}
+
+UInt64 Timer::Expiry() const
+{
+	return _expiry;
+}
+
+TimerWheel::TimerWheel(UInt64 l_now):
+	_now(l_now),
+	_current(l_now),
+	_size(0),
+	_root(),
+	_levels(),
+	_tasks(),
+	_idleTasks()
+{
+
+}
+
+TimerWheel::~TimerWheel()
+{
+	for (auto task : _tasks)
+	{
+		delete task;
+	}
+
+	// Timers owned by others outlive the wheel only disarmed.
+	auto detach = [](TimerLink& l_slot)
+	{
+		while (l_slot.Next != &l_slot)
+		{
+			auto timer = static_cast<Timer*>(l_slot.Next);
+			Unlink(*timer);
+			timer->_wheel = nullptr;
+		}
+	};
+
+	for (auto& slot : _root)
+		detach(slot);
+
+	for (auto& level : _levels)
+		for (auto& slot : level)
+			detach(slot);
+}
+
+UInt64 TimerWheel::Clock()
+{
+	timespec now{};
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return static_cast<UInt64>(now.tv_sec) * 1000 + static_cast<UInt64>(now.tv_nsec) / 1000000;
+}
+
+UInt64 TimerWheel::Now() const
+{
+	return _now;
+}
+
+void TimerWheel::Arm(Timer& l_timer, UInt64 l_delay)
+{
+	ArmAt(l_timer, _now + std::min(l_delay, MAX_DELAY));
+}
+
+void TimerWheel::ArmAt(Timer& l_timer, UInt64 l_time)
+{
+	if (l_timer._wheel != nullptr)
+		l_timer._wheel->Cancel(l_timer);
+
+	l_timer._wheel = this;
+	l_timer._expiry = l_time;
+	++_size;
+
+	Insert(l_timer);
+}
+
+void TimerWheel::Cancel(Timer& l_timer)
+{
+	if (l_timer._wheel != this)
+		return;
+
+	Unlink(l_timer);
+	l_timer._wheel = nullptr;
+	--_size;
+}
+
+void TimerWheel::Schedule(UInt64 l_delay, Task l_task)
+{
+	ScheduledTask* scheduled;
+
+	if (_idleTasks.empty())
+	{
+		scheduled = new ScheduledTask();
+		scheduled->Node.SetCallback([this, scheduled]()
+									{
+										auto work = std::move(scheduled->Work);
+										scheduled->Work = nullptr;
+										_idleTasks.push_back(scheduled);
+										work();
+									});
+		_tasks.push_back(scheduled);
+	}
+	else
+	{
+		scheduled = _idleTasks.back();
+		_idleTasks.pop_back();
+	}
+
+	scheduled->Work = std::move(l_task);
+	Arm(scheduled->Node, l_delay);
+}
+
+std::size_t TimerWheel::Advance(UInt64 l_now)
+{
+	std::size_t expired = 0;
+
+	if (l_now > _now)
+		_now = l_now;
+
+	while (_current <= _now)
+	{
+		// Nothing to expire or cascade: catch up in one step.
+		if (_size == 0)
+		{
+			_current = _now + 1;
+			break;
+		}
+
+		auto index = static_cast<UInt32>(_current & ROOT_MASK);
+
+		if (index == 0)
+		{
+			for (UInt32 level = 0; level < LEVELS; ++level)
+			{
+				auto slot = static_cast<UInt32>((_current >> (ROOT_BITS + level * LEVEL_BITS)) & LEVEL_MASK);
+				Cascade(level, slot);
+
+				if (slot != 0)
+					break;
+			}
+		}
+
+		expired += Expire(_root[index]);
+	}
+
+	return expired;
+}
+
+int TimerWheel::NextTimeout() const
+{
+	if (_size == 0)
+		return -1;
+
+	// Only the root level is exact; at its next wrap around the wheel
+	// has to be advanced anyway to cascade the level above.
+	auto tick = _current;
+
+	if ((tick & ROOT_MASK) != 0)
+	{
+		for (; (tick & ROOT_MASK) != 0; ++tick)
+		{
+			auto& slot = _root[tick & ROOT_MASK];
+			if (slot.Next != &slot)
+				break;
+		}
+	}
+
+	return tick > _now ? static_cast<int>(std::min<UInt64>(tick - _now, INT32_MAX)) : 0;
+}
+
+std::size_t TimerWheel::Size() const
+{
+	return _size;
+}
+
+void TimerWheel::Link(TimerLink& l_slot, Timer& l_timer)
+{
+	l_timer.Prev = l_slot.Prev;
+	l_timer.Next = &l_slot;
+	l_slot.Prev->Next = &l_timer;
+	l_slot.Prev = &l_timer;
+}
+
+void TimerWheel::Unlink(Timer& l_timer)
+{
+	l_timer.Prev->Next = l_timer.Next;
+	l_timer.Next->Prev = l_timer.Prev;
+	l_timer.Next = &l_timer;
+	l_timer.Prev = &l_timer;
+}
+
+void TimerWheel::Insert(Timer& l_timer)
+{
+	auto expiry = std::max(l_timer._expiry, _current);
+	auto delay = expiry - _current;
+
+	if (delay < ROOT_SIZE)
+	{
+		Link(_root[expiry & ROOT_MASK], l_timer);
+		return;
+	}
+
+	for (UInt32 level = 0; level < LEVELS; ++level)
+	{
+		auto shift = ROOT_BITS + level * LEVEL_BITS;
+
+		if (delay < (UInt64(1) << (shift + LEVEL_BITS)) || level == LEVELS - 1)
+		{
+			if (delay > MAX_DELAY)
+				expiry = _current + MAX_DELAY;
+
+			Link(_levels[level][(expiry >> shift) & LEVEL_MASK], l_timer);
+			return;
+		}
+	}
+}
+
+void TimerWheel::Cascade(UInt32 l_level, UInt32 l_index)
+{
+	TimerLink pending;
+	auto& slot = _levels[l_level][l_index];
+
+	if (slot.Next == &slot)
+		return;
+
+	// Detach the whole slot first, re-inserting may land timers back in it.
+	pending.Next = slot.Next;
+	pending.Prev = slot.Prev;
+	pending.Next->Prev = &pending;
+	pending.Prev->Next = &pending;
+	slot.Next = slot.Prev = &slot;
+
+	while (pending.Next != &pending)
+	{
+		auto timer = static_cast<Timer*>(pending.Next);
+		Unlink(*timer);
+		Insert(*timer);
+	}
+}
+
+std::size_t TimerWheel::Expire(TimerLink& l_slot)
+{
+	TimerLink expiring;
+	std::size_t expired = 0;
+
+	if (l_slot.Next != &l_slot)
+	{
+		expiring.Next = l_slot.Next;
+		expiring.Prev = l_slot.Prev;
+		expiring.Next->Prev = &expiring;
+		expiring.Prev->Next = &expiring;
+		l_slot.Next = l_slot.Prev = &l_slot;
+	}
+
+	// Timers re-armed by a callback must not land in the tick being expired.
+	++_current;
+
+	// Callbacks may arm or cancel any timer, including the ones still in this list.
+	while (expiring.Next != &expiring)
+	{
+		auto timer = static_cast<Timer*>(expiring.Next);
+		Unlink(*timer);
+		timer->_wheel = nullptr;
+		--_size;
+		++expired;
+
+		if (timer->_callback)
+			timer->_callback();
+	}
+
+	return expired;
+}
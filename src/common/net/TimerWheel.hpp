@@ -0,0 +1,208 @@
+/*
+* export-giggle
+* TimerWheel.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_TIMERWHEEL_HPP
+#define EXPORT_GIGGLE_TIMERWHEEL_HPP
+
+#include "Net.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace giggle::common::net
+{
+
+	class TimerWheel;
+
+	/**
+	 * @brief The list links shared by timers and the wheel's slots.
+	 */
+	struct TimerLink
+	{
+		TimerLink* Next = this;
+		TimerLink* Prev = this;
+	};
+
+	/**
+	 * @brief A timer that can be armed on a TimerWheel.
+	 *
+	 * Timers are intrusive: the wheel links the timer object itself into
+	 * its slots, so arming, re-arming and cancelling never allocate. Embed
+	 * the timer in the object it times out, e.g. a connection. Destroying
+	 * an armed timer cancels it.
+	 */
+	class Timer : private TimerLink
+	{
+	public:
+		typedef std::function<void()> Callback;
+
+		Timer();
+		explicit Timer(Callback l_callback);
+		~Timer();
+
+		Timer(const Timer&) = delete;
+		Timer& operator = (const Timer&) = delete;
+
+		/**
+		 * @brief Sets the function invoked when the timer expires.
+		 */
+		void SetCallback(Callback l_callback);
+
+		/**
+		 * @brief Returns true while the timer is armed on a wheel.
+		 */
+		bool Armed() const;
+
+		/**
+		 * @brief Returns the time, in wheel milliseconds, the timer expires at.
+		 */
+		UInt64 Expiry() const;
+
+	private:
+
+		friend class TimerWheel;
+
+		TimerWheel*		_wheel;
+		UInt64			_expiry;
+		Callback		_callback;
+	};
+
+	/**
+	 * @brief A hierarchical timing wheel with millisecond ticks.
+	 *
+	 * The first level has 256 one millisecond slots, each of the four
+	 * levels above it 64 slots covering 64 times the span of the level
+	 * below, about 49 days in total. A timer goes straight into the slot
+	 * of its expiry on the coarsest level that still resolves it, and is
+	 * moved one level down every time the level below wraps around, so
+	 * arming, cancelling and expiring are all O(1) regardless of how
+	 * many timers are armed.
+	 *
+	 * Not thread safe; a wheel belongs to the thread driving it, which
+	 * calls Advance() with the current time and sleeps no longer than
+	 * NextTimeout() in between.
+	 */
+	class TimerWheel
+	{
+	public:
+		typedef std::function<void()> Task;
+
+		/**
+		 * @brief Creates the wheel.
+		 * @param l_now The current time, see Clock().
+		 */
+		explicit TimerWheel(UInt64 l_now = Clock());
+		~TimerWheel();
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel& operator = (const TimerWheel&) = delete;
+
+		/**
+		 * @brief Returns the monotonic clock, in milliseconds.
+		 */
+		static UInt64 Clock();
+
+		/**
+		 * @brief Returns the time of the last call to Advance(); cheaper
+		 * than Clock() and precise enough for timeouts.
+		 */
+		UInt64 Now() const;
+
+		/**
+		 * @brief Arms, or re-arms, a timer to expire l_delay milliseconds from Now().
+		 */
+		void Arm(Timer& l_timer, UInt64 l_delay);
+
+		/**
+		 * @brief Arms, or re-arms, a timer to expire at the given time.
+		 */
+		void ArmAt(Timer& l_timer, UInt64 l_time);
+
+		/**
+		 * @brief Disarms a timer; does nothing if it is not armed.
+		 */
+		void Cancel(Timer& l_timer);
+
+		/**
+		 * @brief Runs a task l_delay milliseconds from Now(). The timer
+		 * carrying the task is recycled once it ran.
+		 */
+		void Schedule(UInt64 l_delay, Task l_task);
+
+		/**
+		 * @brief Expires every timer due at or before l_now, invoking their callbacks.
+		 * @return The number of expired timers.
+		 */
+		std::size_t Advance(UInt64 l_now);
+
+		/**
+		 * @brief Returns the milliseconds from Now() until the wheel next needs
+		 * to be advanced, or -1 when no timer is armed.
+		 */
+		int NextTimeout() const;
+
+		/**
+		 * @brief Returns the number of armed timers.
+		 */
+		std::size_t Size() const;
+
+	private:
+
+		enum
+		{
+			ROOT_BITS = 8,
+			ROOT_SIZE = 1 << ROOT_BITS,
+			ROOT_MASK = ROOT_SIZE - 1,
+			LEVEL_BITS = 6,
+			LEVEL_SIZE = 1 << LEVEL_BITS,
+			LEVEL_MASK = LEVEL_SIZE - 1,
+			LEVELS = 4
+		};
+
+		/**
+		 * A timer carrying a scheduled task; recycled once the task ran.
+		 */
+		struct ScheduledTask
+		{
+			Timer Node;
+			Task Work;
+		};
+
+		static constexpr UInt64 MAX_DELAY = (UInt64(1) << (ROOT_BITS + LEVELS * LEVEL_BITS)) - 1;
+
+		static void Link(TimerLink& l_slot, Timer& l_timer);
+		static void Unlink(Timer& l_timer);
+
+		void Insert(Timer& l_timer);
+		void Cascade(UInt32 l_level, UInt32 l_index);
+		std::size_t Expire(TimerLink& l_slot);
+
+		UInt64					_now;
+		UInt64					_current;
+		std::size_t				_size;
+
+		TimerLink				_root[ROOT_SIZE];
+		TimerLink				_levels[LEVELS][LEVEL_SIZE];
+
+		std::vector<ScheduledTask*>	_tasks;
+		std::vector<ScheduledTask*>	_idleTasks;
+	};
+
+} // namespace net
+
+#endif //EXPORT_GIGGLE_TIMERWHEEL_HPP
@@ -0,0 +1,579 @@
+/*
+* export-giggle
+* UringReactor.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "UringReactor.hpp"
+
+#ifdef GIGGLE_NET_HAVE_IO_URING
+
+#include <exceptions/SystemException.hpp>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <climits>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+
+using namespace giggle::common;
+using namespace giggle::common::net;
+using namespace giggle::common::exception;
+
+namespace
+{
+	const UInt16 BUFFER_GROUP = 0;
+}
+
+UringReactor::UringReactor(UInt32 l_index, UInt32 l_port, UInt32 l_maxConnections, bool l_reusePort,
+						   const Connection::Handlers& l_handlers):
+	Reactor(l_index, l_port, l_maxConnections, l_reusePort, l_handlers),
+	_ring(nullptr),
+	_bufferRing(nullptr),
+	_bufferRingSize(0),
+	_bufferTail(0),
+	_bufferBlocks(),
+	_buffers(),
+	_operations(),
+	_closing(),
+	_sending(),
+	_receiving(),
+	_paused(),
+	_wakeupDescriptor(-1),
+	_stopRequested(false),
+	_mutex(),
+	_pending()
+{
+	_ring = new IoUring(URING_QUEUE_DEPTH);
+
+	try
+	{
+		_wakeupDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (_wakeupDescriptor < 0)
+		{
+			throw SystemException("Error creating wakeup descriptor.", std::strerror(errno), errno);
+		}
+
+		auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		_bufferRingSize = (URING_BUFFER_COUNT * sizeof(io_uring_buf) + pageSize - 1) / pageSize * pageSize;
+
+		auto ring = mmap(nullptr, _bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (ring == MAP_FAILED)
+		{
+			throw SystemException("Error mapping provided buffer ring.", std::strerror(errno), errno);
+		}
+		_bufferRing = static_cast<io_uring_buf_ring*>(ring);
+
+		// Carve the provided buffers out of pool blocks, so the kernel writes
+		// received data straight into memory owned by the reactor's pool.
+		auto perBlock = _memoryPool->BlockSize() / URING_BUFFER_SIZE;
+		if (perBlock == 0)
+		{
+			throw SystemException("Memory pool blocks are smaller than a receive buffer.");
+		}
+
+		_buffers.reserve(URING_BUFFER_COUNT);
+		while (_buffers.size() < URING_BUFFER_COUNT)
+		{
+			auto block = static_cast<char*>(_memoryPool->GetMemory());
+			_bufferBlocks.push_back(block);
+
+			for (std::size_t i = 0; i < perBlock && _buffers.size() < URING_BUFFER_COUNT; ++i)
+			{
+				_buffers.push_back(block + i * URING_BUFFER_SIZE);
+			}
+		}
+
+		_ring->RegisterBufferRing(_bufferRing, URING_BUFFER_COUNT, BUFFER_GROUP);
+
+		for (UInt32 i = 0; i < URING_BUFFER_COUNT; ++i)
+		{
+			RecycleBuffer(static_cast<UInt16>(i));
+		}
+
+		ArmWakeup();
+	}
+	catch (...)
+	{
+		ReleaseResources();
+		throw;
+	}
+}
+
+UringReactor::~UringReactor()
+{
+	_closing.clear();
+	ReleaseResources();
+}
+
+void UringReactor::ReleaseResources()
+{
+	// The ring goes first: once it is gone the kernel no longer writes into the buffers.
+	delete _ring;
+	_ring = nullptr;
+
+	if (_bufferRing != nullptr)
+	{
+		munmap(_bufferRing, _bufferRingSize);
+		_bufferRing = nullptr;
+	}
+
+	for (auto block : _bufferBlocks)
+	{
+		_memoryPool->Release(block);
+	}
+	_bufferBlocks.clear();
+	_buffers.clear();
+
+	if (_wakeupDescriptor >= 0)
+	{
+		close(_wakeupDescriptor);
+		_wakeupDescriptor = -1;
+	}
+}
+
+void UringReactor::Run()
+{
+	while (!_stopRequested)
+	{
+		auto result = _ring->Submit(1, _timers->NextTimeout());
+
+		if (result < 0 && result != -EINTR && result != -EAGAIN && result != -EBUSY && result != -ETIME)
+		{
+			std::cerr << std::strerror(-result) << std::endl;
+			break;
+		}
+
+		_timers->Advance(TimerWheel::Clock());
+
+		_ring->ForEachCompletion([this](const io_uring_cqe& l_cqe)
+								 {
+									 OnCompletion(l_cqe);
+								 });
+
+		RunPending();
+		FlushPending();
+	}
+
+	RunPending();
+	FlushPending();
+
+	CloseClients();
+	StopListening();
+
+	// Closing shut every socket down, so the remaining operations complete
+	// promptly; the kernel may read queued output until they do.
+	while (!_operations.empty())
+	{
+		auto result = _ring->Submit(1);
+		if (result < 0 && result != -EINTR)
+			break;
+
+		_ring->ForEachCompletion([this](const io_uring_cqe& l_cqe)
+								 {
+									 OnCompletion(l_cqe);
+								 });
+	}
+	_ring->Submit();
+
+	_closing.clear();
+	_operations.clear();
+	_sending.clear();
+	_receiving.clear();
+	_paused.clear();
+	_stopRequested = false;
+}
+
+void UringReactor::Stop()
+{
+	_stopRequested = true;
+
+	UInt64 one = 1;
+	auto written = write(_wakeupDescriptor, &one, sizeof(one));
+	(void) written;
+}
+
+void UringReactor::Post(Task l_task)
+{
+	{
+		std::lock_guard<std::mutex> lock{_mutex};
+		_pending.push_back(std::move(l_task));
+	}
+
+	UInt64 one = 1;
+	auto written = write(_wakeupDescriptor, &one, sizeof(one));
+	(void) written;
+}
+
+IoBackend UringReactor::Backend() const
+{
+	return IoBackend::IoUring;
+}
+
+void UringReactor::OnListening()
+{
+	ArmAccept();
+}
+
+void UringReactor::StopListening()
+{
+	// Cancelling the multishot accept releases the kernel's reference to the listening socket.
+	if (_serverDescriptor >= 0)
+	{
+		IoUring::PrepareCancel(NextSqe(), Encode(OP_ACCEPT, _serverDescriptor), Encode(OP_CANCEL, -1));
+	}
+
+	CloseListening();
+}
+
+void UringReactor::Watch(Connection& l_connection)
+{
+	ArmReceive(l_connection.Descriptor());
+}
+
+void UringReactor::Unwatch(Connection& l_connection)
+{
+	// Shutting the socket down completes the multishot recv with a final, empty result.
+	shutdown(l_connection.Descriptor(), SHUT_RDWR);
+}
+
+void UringReactor::Retire(std::unique_ptr<Connection> l_connection)
+{
+	auto descriptor = l_connection->Descriptor();
+	_paused.erase(descriptor);
+
+	if (_operations.find(descriptor) == _operations.end())
+	{
+		Reactor::Retire(std::move(l_connection));
+	}
+	else
+	{
+		_closing[descriptor] = std::move(l_connection);
+	}
+}
+
+UInt64 UringReactor::Encode(Operation l_operation, SocketFileDescriptor l_descriptor)
+{
+	return (static_cast<UInt64>(l_operation) << 32) | static_cast<UInt32>(l_descriptor);
+}
+
+io_uring_sqe* UringReactor::NextSqe()
+{
+	auto sqe = _ring->GetSqe();
+	if (sqe == nullptr)
+	{
+		throw SystemException("io_uring submission queue is full.");
+	}
+	return sqe;
+}
+
+void UringReactor::ArmAccept()
+{
+	IoUring::PrepareAccept(NextSqe(), _serverDescriptor, Encode(OP_ACCEPT, _serverDescriptor));
+}
+
+void UringReactor::ArmReceive(SocketFileDescriptor l_descriptor)
+{
+	IoUring::PrepareRecv(NextSqe(), l_descriptor, BUFFER_GROUP, Encode(OP_RECEIVE, l_descriptor));
+	Begin(l_descriptor);
+	_receiving.insert(l_descriptor);
+}
+
+void UringReactor::ArmWakeup()
+{
+	IoUring::PreparePoll(NextSqe(), _wakeupDescriptor, POLLIN, Encode(OP_WAKEUP, _wakeupDescriptor));
+}
+
+void UringReactor::OnCompletion(const io_uring_cqe& l_cqe)
+{
+	switch (static_cast<Operation>(l_cqe.user_data >> 32))
+	{
+		case OP_ACCEPT:
+			OnAccept(l_cqe);
+			break;
+		case OP_RECEIVE:
+			OnReceive(l_cqe);
+			break;
+		case OP_WAKEUP:
+			OnWakeup(l_cqe);
+			break;
+		case OP_SEND:
+			OnSend(l_cqe);
+			break;
+		case OP_POLL_OUT:
+			OnPollOut(l_cqe);
+			break;
+		case OP_CANCEL:
+			break;
+	}
+}
+
+void UringReactor::OnAccept(const io_uring_cqe& l_cqe)
+{
+	if (!(l_cqe.flags & IORING_CQE_F_MORE) && !_stopRequested && _serverDescriptor >= 0)
+	{
+		ArmAccept();
+	}
+
+	if (l_cqe.res < 0)
+	{
+		auto error = -l_cqe.res;
+
+		if (error == EMFILE || error == ENFILE)
+			DropPending();
+		else if (error != ECANCELED && error != EINTR && error != ECONNABORTED)
+			std::cerr << std::strerror(error) << std::endl;
+
+		return;
+	}
+
+	SocketAddress clientAddress{};
+	auto clientLength = static_cast<socklen_t>(sizeof(clientAddress));
+	getpeername(l_cqe.res, (struct sockaddr *) &clientAddress, &clientLength);
+
+	AddClient(l_cqe.res, clientAddress);
+}
+
+void UringReactor::OnReceive(const io_uring_cqe& l_cqe)
+{
+	auto descriptor = static_cast<SocketFileDescriptor>(l_cqe.user_data & 0xFFFFFFFF);
+	auto more = (l_cqe.flags & IORING_CQE_F_MORE) != 0;
+
+	if (!more)
+	{
+		_receiving.erase(descriptor);
+		Finish(descriptor);
+	}
+
+	auto connection = FindClient(descriptor);
+
+	if (l_cqe.flags & IORING_CQE_F_BUFFER)
+	{
+		auto buffer = static_cast<UInt16>(l_cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+
+		if (connection != nullptr && l_cqe.res > 0)
+		{
+			connection->Receive(_buffers[buffer], static_cast<std::size_t>(l_cqe.res));
+		}
+
+		RecycleBuffer(buffer);
+	}
+
+	if (connection == nullptr || connection->GetState() != Connection::State::Open)
+		return;
+
+	if (l_cqe.res == 0 || (l_cqe.res < 0 && l_cqe.res != -ENOBUFS && l_cqe.res != -ECANCELED))
+	{
+		connection->Close();
+		return;
+	}
+
+	// Stop reading from a peer that does not read our output, or when paused, see Resume().
+	if (!connection->Readable() && _paused.insert(descriptor).second && more)
+	{
+		IoUring::PrepareCancel(NextSqe(), Encode(OP_RECEIVE, descriptor), Encode(OP_CANCEL, descriptor));
+		return;
+	}
+
+	// The kernel ends a multishot recv when it runs out of buffers; they
+	// have been handed back by now, so simply start a new one.
+	if (!more && _paused.find(descriptor) == _paused.end())
+	{
+		ArmReceive(descriptor);
+	}
+}
+
+void UringReactor::Resume(Connection& l_connection)
+{
+	auto descriptor = l_connection.Descriptor();
+
+	if (_paused.erase(descriptor) > 0 && _receiving.find(descriptor) == _receiving.end())
+	{
+		ArmReceive(descriptor);
+	}
+}
+
+void UringReactor::OnWakeup(const io_uring_cqe& l_cqe)
+{
+	UInt64 count = 0;
+	while (read(_wakeupDescriptor, &count, sizeof(count)) > 0)
+	{
+	}
+
+	if (!(l_cqe.flags & IORING_CQE_F_MORE))
+	{
+		ArmWakeup();
+	}
+}
+
+void UringReactor::Flush(Connection& l_connection)
+{
+	auto descriptor = l_connection.Descriptor();
+
+	while (l_connection.GetState() == Connection::State::Open && l_connection.Queued() > 0 &&
+		   _sending.find(descriptor) == _sending.end())
+	{
+		UInt64 offset = 0;
+		std::size_t length = 0;
+
+		if (l_connection.GatherFile(offset, length) == nullptr)
+		{
+			auto& sending = _sending[descriptor];
+			sending.Vectors.resize(IOV_MAX);
+			sending.Vectors.resize(l_connection.Gather(sending.Vectors.data(), sending.Vectors.size()));
+
+			sending.Message = msghdr{};
+			sending.Message.msg_iov = sending.Vectors.data();
+			sending.Message.msg_iovlen = sending.Vectors.size();
+
+			IoUring::PrepareSendMsg(NextSqe(), descriptor, &sending.Message, MSG_NOSIGNAL, Encode(OP_SEND, descriptor));
+			Begin(descriptor);
+			return;
+		}
+
+		// There is no sendfile operation, so file regions are written from
+		// here with the non-blocking socket until its buffer is full.
+		std::size_t requested = 0;
+		auto written = WriteFile(l_connection, requested);
+
+		if (written >= 0)
+		{
+			l_connection.Sent(static_cast<std::size_t>(written));
+
+			if (static_cast<std::size_t>(written) < requested && l_connection.GetState() == Connection::State::Open)
+				ArmPollOut(descriptor);
+
+			continue;
+		}
+
+		if (errno == EINTR)
+			continue;
+
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			ArmPollOut(descriptor);
+			return;
+		}
+
+		if (errno != EPIPE && errno != ECONNRESET)
+			std::cerr << std::strerror(errno) << std::endl;
+
+		l_connection.Close();
+		return;
+	}
+}
+
+void UringReactor::ArmPollOut(SocketFileDescriptor l_descriptor)
+{
+	// An entry without vectors keeps Flush() from writing until the socket drained.
+	_sending[l_descriptor].Vectors.clear();
+
+	IoUring::PreparePoll(NextSqe(), l_descriptor, POLLOUT, Encode(OP_POLL_OUT, l_descriptor), false);
+	Begin(l_descriptor);
+}
+
+void UringReactor::OnPollOut(const io_uring_cqe& l_cqe)
+{
+	auto descriptor = static_cast<SocketFileDescriptor>(l_cqe.user_data & 0xFFFFFFFF);
+
+	_sending.erase(descriptor);
+	Finish(descriptor);
+
+	auto connection = FindClient(descriptor);
+	if (connection != nullptr && connection->GetState() == Connection::State::Open)
+	{
+		Flush(*connection);
+	}
+}
+
+void UringReactor::OnSend(const io_uring_cqe& l_cqe)
+{
+	auto descriptor = static_cast<SocketFileDescriptor>(l_cqe.user_data & 0xFFFFFFFF);
+
+	_sending.erase(descriptor);
+	Finish(descriptor);
+
+	auto connection = FindClient(descriptor);
+	if (connection == nullptr || connection->GetState() != Connection::State::Open)
+		return;
+
+	if (l_cqe.res < 0 && l_cqe.res != -EINTR && l_cqe.res != -EAGAIN)
+	{
+		if (l_cqe.res != -EPIPE && l_cqe.res != -ECONNRESET)
+			std::cerr << std::strerror(-l_cqe.res) << std::endl;
+
+		connection->Close();
+		return;
+	}
+
+	if (l_cqe.res > 0)
+	{
+		connection->Sent(static_cast<std::size_t>(l_cqe.res));
+	}
+
+	if (connection->GetState() == Connection::State::Open)
+	{
+		Flush(*connection);
+	}
+}
+
+void UringReactor::Begin(SocketFileDescriptor l_descriptor)
+{
+	++_operations[l_descriptor];
+}
+
+void UringReactor::Finish(SocketFileDescriptor l_descriptor)
+{
+	auto it = _operations.find(l_descriptor);
+	if (it == _operations.end())
+		return;
+
+	if (--it->second == 0)
+	{
+		_operations.erase(it);
+		_closing.erase(l_descriptor);
+	}
+}
+
+void UringReactor::RecycleBuffer(UInt16 l_buffer)
+{
+	// Index the ring as a plain array: compiled as C++, the header's flexible
+	// array member does not start at offset 0 as it does for the kernel.
+	auto entries = reinterpret_cast<io_uring_buf*>(_bufferRing);
+	auto& entry = entries[_bufferTail & (URING_BUFFER_COUNT - 1)];
+	entry.addr = reinterpret_cast<UInt64>(_buffers[l_buffer]);
+	entry.len = URING_BUFFER_SIZE;
+	entry.bid = l_buffer;
+
+	++_bufferTail;
+	__atomic_store_n(&_bufferRing->tail, _bufferTail, __ATOMIC_RELEASE);
+}
+
+void UringReactor::RunPending()
+{
+	std::vector<Task> tasks;
+	{
+		std::lock_guard<std::mutex> lock{_mutex};
+		tasks.swap(_pending);
+	}
+
+	for (auto& task : tasks)
+	{
+		task();
+	}
+}
+
+#endif // GIGGLE_NET_HAVE_IO_URING
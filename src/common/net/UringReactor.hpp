@@ -0,0 +1,156 @@
+/*
+* export-giggle
+* UringReactor.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_URINGREACTOR_HPP
+#define EXPORT_GIGGLE_URINGREACTOR_HPP
+
+#include "Reactor.hpp"
+#include "IoUring.hpp"
+
+#ifdef GIGGLE_NET_HAVE_IO_URING
+
+#include <mutex>
+#include <unordered_set>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace giggle::common::net
+{
+
+	/**
+	 * @brief A Reactor driven by io_uring completions.
+	 *
+	 * The listening socket is served by a single multishot accept and
+	 * every connection by a single multishot recv, so a steady stream of
+	 * messages costs no submissions at all. Received data lands in a
+	 * provided buffer ring registered with the kernel, whose buffers are
+	 * carved out of blocks of the reactor's MemoryPool; a buffer is handed
+	 * back to the ring as soon as the connection consumed it.
+	 *
+	 * Output is written with one SENDMSG at a time per connection,
+	 * gathering up to IOV_MAX queued segments; whatever was queued while
+	 * it was in flight goes out with the next one. File regions are
+	 * written with a non-blocking sendfile() on the reactor thread,
+	 * waiting for a one-shot POLLOUT whenever the socket buffer is full. The multishot recv of
+	 * a connection that is not Writable() is cancelled and only armed
+	 * again once its output drained.
+	 *
+	 * Descriptors are only closed once the kernel has reported the last
+	 * completion of every operation issued on them, so a completion can
+	 * never be attributed to a reused descriptor.
+	 */
+	class UringReactor : public Reactor
+	{
+	public:
+
+		/**
+		 * @brief Creates the ring and registers the provided buffers.
+		 * @throws SystemException if io_uring or provided buffer rings are unavailable.
+		 */
+		UringReactor(UInt32 l_index, UInt32 l_port, UInt32 l_maxConnections, bool l_reusePort,
+					 const Connection::Handlers& l_handlers);
+		~UringReactor() override;
+
+		void Run() override;
+		void Stop() override;
+		void Post(Task l_task) override;
+		IoBackend Backend() const override;
+
+	protected:
+
+		void OnListening() override;
+		void StopListening() override;
+		void Watch(Connection& l_connection) override;
+		void Unwatch(Connection& l_connection) override;
+		void Retire(std::unique_ptr<Connection> l_connection) override;
+		void Flush(Connection& l_connection) override;
+		void Resume(Connection& l_connection) override;
+
+	private:
+
+		enum Operation : UInt8
+		{
+			OP_ACCEPT = 1,
+			OP_RECEIVE,
+			OP_WAKEUP,
+			OP_CANCEL,
+			OP_SEND,
+			OP_POLL_OUT
+		};
+
+		/**
+		 * The message of an in-flight SENDMSG, which the kernel reads
+		 * until the operation completes. Also marks a connection waiting
+		 * for POLLOUT to continue a file region, with no vectors.
+		 */
+		struct Sending
+		{
+			msghdr				Message;
+			std::vector<iovec>	Vectors;
+		};
+
+		static UInt64 Encode(Operation l_operation, SocketFileDescriptor l_descriptor);
+
+		io_uring_sqe* NextSqe();
+
+		void ArmAccept();
+		void ArmReceive(SocketFileDescriptor l_descriptor);
+		void ArmWakeup();
+		void ArmPollOut(SocketFileDescriptor l_descriptor);
+
+		void OnCompletion(const io_uring_cqe& l_cqe);
+		void OnAccept(const io_uring_cqe& l_cqe);
+		void OnReceive(const io_uring_cqe& l_cqe);
+		void OnWakeup(const io_uring_cqe& l_cqe);
+		void OnSend(const io_uring_cqe& l_cqe);
+		void OnPollOut(const io_uring_cqe& l_cqe);
+
+		void Begin(SocketFileDescriptor l_descriptor);
+		void Finish(SocketFileDescriptor l_descriptor);
+
+		void RecycleBuffer(UInt16 l_buffer);
+		void RunPending();
+		void ReleaseResources();
+
+		IoUring*					_ring;
+
+		io_uring_buf_ring*			_bufferRing;
+		std::size_t					_bufferRingSize;
+		UInt16						_bufferTail;
+		std::vector<char*>			_bufferBlocks;
+		std::vector<char*>			_buffers;
+
+		std::unordered_map<SocketFileDescriptor, UInt32> _operations;
+		std::unordered_map<SocketFileDescriptor, std::unique_ptr<Connection>> _closing;
+		std::unordered_map<SocketFileDescriptor, Sending> _sending;
+		std::unordered_set<SocketFileDescriptor> _receiving;
+		std::unordered_set<SocketFileDescriptor> _paused;
+
+		int 						_wakeupDescriptor;
+		std::atomic_bool			_stopRequested;
+
+		std::mutex					_mutex;
+		std::vector<Task>			_pending;
+	};
+
+} // namespace net
+
+#endif // GIGGLE_NET_HAVE_IO_URING
+
+#endif //EXPORT_GIGGLE_URINGREACTOR_HPP
@@ -0,0 +1,185 @@
+/*
+* export-giggle
+* Affinity.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "Affinity.hpp"
+#include <exceptions/SystemException.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+
+using namespace giggle::common;
+using namespace giggle::common::threading;
+using namespace giggle::common::exception;
+
+namespace
+{
+	const char* const NODE_DIRECTORY = "/sys/devices/system/node";
+
+	/**
+	 * Returns the numbers of the nodeN entries of the node directory, in
+	 * ascending order; empty if the kernel exposes no NUMA topology.
+	 */
+	std::vector<UInt32> NodeNumbers()
+	{
+		std::vector<UInt32> nodes;
+
+		auto directory = opendir(NODE_DIRECTORY);
+		if (directory == nullptr)
+			return nodes;
+
+		while (auto entry = readdir(directory))
+		{
+			char* end = nullptr;
+			if (std::strncmp(entry->d_name, "node", 4) != 0)
+				continue;
+
+			auto number = std::strtoul(entry->d_name + 4, &end, 10);
+			if (end != entry->d_name + 4 && *end == '\0')
+				nodes.push_back(static_cast<UInt32>(number));
+		}
+
+		closedir(directory);
+		std::sort(nodes.begin(), nodes.end());
+		return nodes;
+	}
+}
+
+CpuList threading::ParseCpuList(const std::string& l_list)
+{
+	CpuList cpus;
+	std::istringstream stream(l_list);
+	std::string range;
+
+	while (std::getline(stream, range, ','))
+	{
+		char* end = nullptr;
+		auto first = std::strtoul(range.c_str(), &end, 10);
+		if (end == range.c_str())
+			continue;
+
+		auto last = first;
+		if (*end == '-')
+		{
+			auto from = end + 1;
+			last = std::strtoul(from, &end, 10);
+			if (end == from || last < first)
+				continue;
+		}
+
+		for (auto cpu = first; cpu <= last; ++cpu)
+		{
+			cpus.push_back(static_cast<UInt32>(cpu));
+		}
+	}
+
+	std::sort(cpus.begin(), cpus.end());
+	cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+	return cpus;
+}
+
+CpuList threading::AvailableCpus()
+{
+	try
+	{
+		return GetAffinity(pthread_self());
+	}
+	catch (const SystemException&)
+	{
+		CpuList cpus(std::max(1L, sysconf(_SC_NPROCESSORS_ONLN)));
+		for (std::size_t i = 0; i < cpus.size(); ++i)
+		{
+			cpus[i] = static_cast<UInt32>(i);
+		}
+		return cpus;
+	}
+}
+
+std::vector<CpuList> threading::NumaNodes()
+{
+	auto available = AvailableCpus();
+	std::vector<CpuList> nodes;
+
+	for (auto number : NodeNumbers())
+	{
+		std::ifstream file(std::string(NODE_DIRECTORY) + "/node" + std::to_string(number) + "/cpulist");
+		std::string list;
+		if (!std::getline(file, list))
+			continue;
+
+		CpuList cpus;
+		for (auto cpu : ParseCpuList(list))
+		{
+			if (std::binary_search(available.begin(), available.end(), cpu))
+				cpus.push_back(cpu);
+		}
+
+		// Memory-only nodes, and nodes this process may not run on.
+		if (!cpus.empty())
+			nodes.push_back(std::move(cpus));
+	}
+
+	if (nodes.empty())
+		nodes.push_back(std::move(available));
+
+	return nodes;
+}
+
+void threading::SetAffinity(pthread_t l_thread, const CpuList& l_cpus)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	for (auto cpu : l_cpus)
+	{
+		if (cpu < CPU_SETSIZE)
+			CPU_SET(cpu, &set);
+	}
+
+	auto error = pthread_setaffinity_np(l_thread, sizeof(set), &set);
+	if (error != 0)
+		throw SystemException("Could not set the thread affinity.", std::strerror(error), error);
+}
+
+CpuList threading::GetAffinity(pthread_t l_thread)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	auto error = pthread_getaffinity_np(l_thread, sizeof(set), &set);
+	if (error != 0)
+		throw SystemException("Could not get the thread affinity.", std::strerror(error), error);
+
+	CpuList cpus;
+	for (UInt32 cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+	{
+		if (CPU_ISSET(cpu, &set))
+			cpus.push_back(cpu);
+	}
+	return cpus;
+}
+
+void threading::SetThreadName(pthread_t l_thread, const std::string& l_name)
+{
+	pthread_setname_np(l_thread, l_name.substr(0, 15).c_str());
+}
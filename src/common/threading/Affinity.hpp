@@ -0,0 +1,73 @@
+/*
+* export-giggle
+* Affinity.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_AFFINITY_HPP
+#define EXPORT_GIGGLE_AFFINITY_HPP
+
+#include <Types.hpp>
+
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+namespace giggle::common::threading
+{
+
+	/// A set of CPU numbers, in ascending order.
+	typedef std::vector<UInt32> CpuList;
+
+	/**
+	 * @brief Parses a kernel CPU list such as "0-3,8,10-11".
+	 * Malformed entries are skipped.
+	 */
+	CpuList ParseCpuList(const std::string& l_list);
+
+	/**
+	 * @brief Returns the CPUs the calling thread may run on.
+	 */
+	CpuList AvailableCpus();
+
+	/**
+	 * @brief Returns the available CPUs of every NUMA node that has any,
+	 * read from /sys/devices/system/node. Machines without that topology,
+	 * or with a single node, get one node holding every available CPU.
+	 */
+	std::vector<CpuList> NumaNodes();
+
+	/**
+	 * @brief Restricts a thread to the given CPUs.
+	 * @throws SystemException if the CPUs are not usable, e.g. outside the process's cgroup.
+	 */
+	void SetAffinity(pthread_t l_thread, const CpuList& l_cpus);
+
+	/**
+	 * @brief Returns the CPUs a thread may run on.
+	 * @throws SystemException
+	 */
+	CpuList GetAffinity(pthread_t l_thread);
+
+	/**
+	 * @brief Names a thread, as shown by top -H, ps and perf.
+	 * Linux keeps 15 characters, so longer names are cut; failures are ignored.
+	 */
+	void SetThreadName(pthread_t l_thread, const std::string& l_name);
+
+} // namespace threading
+
+#endif //EXPORT_GIGGLE_AFFINITY_HPP
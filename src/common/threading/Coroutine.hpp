@@ -0,0 +1,429 @@
+/*
+* export-giggle
+* Coroutine.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_COROUTINE_HPP
+#define EXPORT_GIGGLE_COROUTINE_HPP
+
+/*
+ * The library itself builds as C++17; everything here is header-only
+ * and only available to translation units compiled with coroutine
+ * support, which then see GIGGLE_HAVE_COROUTINES defined.
+ */
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+#define GIGGLE_HAVE_COROUTINES 1
+#endif
+
+#ifdef GIGGLE_HAVE_COROUTINES
+
+#include "ThreadPool.hpp"
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace giggle::common::threading
+{
+
+	/**
+	 * @brief Somewhere coroutines can be resumed.
+	 */
+	class Executor
+	{
+	public:
+
+		virtual ~Executor() = default;
+
+		/**
+		 * @brief Resumes l_coroutine on a thread of the executor, never from within this call.
+		 */
+		virtual void Execute(std::coroutine_handle<> l_coroutine) = 0;
+	};
+
+	/**
+	 * @brief Resumes coroutines on the workers of a ThreadPool.
+	 */
+	class PoolExecutor : public Executor
+	{
+	public:
+
+		explicit PoolExecutor(ThreadPool& l_pool) :
+			_pool(l_pool)
+		{
+
+		}
+
+		void Execute(std::coroutine_handle<> l_coroutine) override
+		{
+			_pool.Post([l_coroutine]() { l_coroutine.resume(); });
+		}
+
+	private:
+
+		ThreadPool&	_pool;
+	};
+
+	template <class T = void>
+	class Task;
+
+	namespace detail
+	{
+		class PromiseBase
+		{
+		public:
+
+			/// Resumes whoever awaited the task, on the thread that finished it.
+			struct FinalAwaiter
+			{
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				template <class Promise>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> l_coroutine) noexcept
+				{
+					auto continuation = static_cast<PromiseBase&>(l_coroutine.promise())._continuation;
+					return continuation ? continuation : std::noop_coroutine();
+				}
+
+				void await_resume() const noexcept
+				{
+
+				}
+			};
+
+			std::suspend_always initial_suspend() const noexcept
+			{
+				return {};
+			}
+
+			FinalAwaiter final_suspend() const noexcept
+			{
+				return {};
+			}
+
+			void unhandled_exception() noexcept
+			{
+				_exception = std::current_exception();
+			}
+
+			void SetContinuation(std::coroutine_handle<> l_continuation)
+			{
+				_continuation = l_continuation;
+			}
+
+		protected:
+
+			void Rethrow() const
+			{
+				if (_exception)
+					std::rethrow_exception(_exception);
+			}
+
+		private:
+
+			std::coroutine_handle<>	_continuation;
+			std::exception_ptr		_exception;
+		};
+
+		template <class T>
+		class Promise : public PromiseBase
+		{
+		public:
+
+			Task<T> get_return_object() noexcept;
+
+			template <class U>
+			void return_value(U&& l_value)
+			{
+				_value.emplace(std::forward<U>(l_value));
+			}
+
+			T Result()
+			{
+				Rethrow();
+				return std::move(*_value);
+			}
+
+		private:
+
+			std::optional<T>	_value;
+		};
+
+		template <>
+		class Promise<void> : public PromiseBase
+		{
+		public:
+
+			Task<void> get_return_object() noexcept;
+
+			void return_void() const noexcept
+			{
+
+			}
+
+			void Result() const
+			{
+				Rethrow();
+			}
+		};
+
+		/**
+		 * A coroutine nobody awaits: it starts at once and frees itself
+		 * when it finishes. An exception escaping it terminates the process.
+		 */
+		struct Detached
+		{
+			struct promise_type
+			{
+				Detached get_return_object() const noexcept
+				{
+					return {};
+				}
+
+				std::suspend_never initial_suspend() const noexcept
+				{
+					return {};
+				}
+
+				std::suspend_never final_suspend() const noexcept
+				{
+					return {};
+				}
+
+				void return_void() const noexcept
+				{
+
+				}
+
+				void unhandled_exception() const noexcept
+				{
+					std::terminate();
+				}
+			};
+		};
+	}
+
+	/**
+	 * @brief A lazily started coroutine producing a T.
+	 *
+	 * Nothing runs until the task is awaited; the awaiting coroutine is
+	 * then suspended, the task runs on the same thread, and the awaiting
+	 * coroutine is resumed on whichever thread the task finished, getting
+	 * its value or exception. Both transfers are symmetric, so optimised
+	 * builds, where the compiler turns them into tail calls, do not grow
+	 * the stack however many tasks complete in a row; unoptimised GCC
+	 * builds do. A task is awaited once.
+	 */
+	template <class T>
+	class [[nodiscard]] Task
+	{
+	public:
+
+		typedef detail::Promise<T> promise_type;
+
+		Task(Task&& l_other) noexcept :
+			_coroutine(std::exchange(l_other._coroutine, nullptr))
+		{
+
+		}
+
+		Task& operator = (Task&& l_other) noexcept
+		{
+			if (this != &l_other)
+			{
+				if (_coroutine)
+					_coroutine.destroy();
+
+				_coroutine = std::exchange(l_other._coroutine, nullptr);
+			}
+
+			return *this;
+		}
+
+		Task(const Task&) = delete;
+		Task& operator = (const Task&) = delete;
+
+		~Task()
+		{
+			if (_coroutine)
+				_coroutine.destroy();
+		}
+
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> l_awaiting) noexcept
+		{
+			_coroutine.promise().SetContinuation(l_awaiting);
+			return _coroutine;
+		}
+
+		T await_resume()
+		{
+			return _coroutine.promise().Result();
+		}
+
+	private:
+
+		friend promise_type;
+
+		explicit Task(std::coroutine_handle<promise_type> l_coroutine) :
+			_coroutine(l_coroutine)
+		{
+
+		}
+
+		std::coroutine_handle<promise_type>	_coroutine;
+	};
+
+	namespace detail
+	{
+		template <class T>
+		Task<T> Promise<T>::get_return_object() noexcept
+		{
+			return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+		}
+
+		inline Task<void> Promise<void>::get_return_object() noexcept
+		{
+			return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+		}
+	}
+
+	/**
+	 * @brief Awaiting the result moves the coroutine to l_executor.
+	 * An executor that drops the work, like a stopped reactor, never
+	 * resumes the coroutine, and its frame leaks.
+	 */
+	inline auto Schedule(Executor& l_executor)
+	{
+		struct Awaiter
+		{
+			Executor& Target;
+
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> l_coroutine) const
+			{
+				Target.Execute(l_coroutine);
+			}
+
+			void await_resume() const noexcept
+			{
+
+			}
+		};
+
+		return Awaiter{l_executor};
+	}
+
+	namespace detail
+	{
+		inline Detached RunDetached(Executor& l_executor, Task<void> l_task)
+		{
+			co_await Schedule(l_executor);
+			co_await l_task;
+		}
+
+		struct Latch
+		{
+			std::mutex				Mutex;
+			std::condition_variable	Condition;
+			bool					Done = false;
+			std::exception_ptr		Exception;
+		};
+
+		inline Detached Complete(Task<void> l_task, Latch& l_latch)
+		{
+			try
+			{
+				co_await l_task;
+			}
+			catch (...)
+			{
+				l_latch.Exception = std::current_exception();
+			}
+
+			// Notified under the lock, as the waiter destroys the latch once it sees Done.
+			std::lock_guard<std::mutex> lock{l_latch.Mutex};
+			l_latch.Done = true;
+			l_latch.Condition.notify_one();
+		}
+
+		template <class T>
+		Task<void> Store(Task<T> l_task, std::optional<T>& l_value)
+		{
+			l_value.emplace(co_await l_task);
+		}
+	}
+
+	/**
+	 * @brief Starts l_task on l_executor without waiting for it.
+	 * The executor must outlive the task; an exception escaping the task
+	 * terminates the process, as it would from ThreadPool::Post().
+	 */
+	inline void Spawn(Executor& l_executor, Task<void> l_task)
+	{
+		detail::RunDetached(l_executor, std::move(l_task));
+	}
+
+	/**
+	 * @brief Runs l_task, starting on the calling thread, and blocks until it finished.
+	 * For threads outside any executor, such as main(); blocking a thread
+	 * the task needs to make progress deadlocks.
+	 * @return The task's value.
+	 * @throws The task's exception.
+	 */
+	template <class T>
+	T SyncWait(Task<T> l_task)
+	{
+		detail::Latch latch;
+		std::optional<typename std::conditional<std::is_void<T>::value, bool, T>::type> value;
+
+		if constexpr (std::is_void<T>::value)
+			detail::Complete(std::move(l_task), latch);
+		else
+			detail::Complete(detail::Store(std::move(l_task), value), latch);
+
+		{
+			std::unique_lock<std::mutex> lock{latch.Mutex};
+			latch.Condition.wait(lock, [&latch]() { return latch.Done; });
+		}
+
+		if (latch.Exception)
+			std::rethrow_exception(latch.Exception);
+
+		if constexpr (!std::is_void<T>::value)
+			return std::move(*value);
+	}
+
+} // namespace threading
+
+#endif // GIGGLE_HAVE_COROUTINES
+
+#endif //EXPORT_GIGGLE_COROUTINE_HPP
@@ -0,0 +1,89 @@
+/*
+* export-giggle
+* EventCount.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "EventCount.hpp"
+
+#include <climits>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace giggle::common;
+using namespace giggle::common::threading;
+
+namespace
+{
+	int Futex(std::atomic<UInt32>* l_word, int l_operation, UInt32 l_value)
+	{
+		static_assert(sizeof(std::atomic<UInt32>) == sizeof(UInt32), "futex words must be plain integers");
+		return static_cast<int>(syscall(SYS_futex, reinterpret_cast<UInt32*>(l_word), l_operation | FUTEX_PRIVATE_FLAG,
+										l_value, nullptr, nullptr, 0));
+	}
+}
+
+EventCount::EventCount():
+	_epoch(0),
+	_waiters(0)
+{
+
+}
+
+UInt32 EventCount::PrepareWait()
+{
+	_waiters.fetch_add(1, std::memory_order_seq_cst);
+	return _epoch.load(std::memory_order_seq_cst);
+}
+
+void EventCount::CancelWait()
+{
+	_waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void EventCount::Wait(UInt32 l_key)
+{
+	// Returns at once if the epoch moved on; spurious wake-ups just check again.
+	while (_epoch.load(std::memory_order_acquire) == l_key)
+	{
+		Futex(&_epoch, FUTEX_WAIT, l_key);
+	}
+
+	_waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void EventCount::NotifyOne()
+{
+	Notify(1);
+}
+
+void EventCount::NotifyAll()
+{
+	Notify(INT_MAX);
+}
+
+void EventCount::Notify(UInt32 l_count)
+{
+	// Orders the caller's change of the condition before the look at the waiters.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (_waiters.load(std::memory_order_seq_cst) == 0)
+		return;
+
+	_epoch.fetch_add(1, std::memory_order_seq_cst);
+	Futex(&_epoch, FUTEX_WAKE, l_count);
+}
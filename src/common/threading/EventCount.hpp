@@ -0,0 +1,90 @@
+/*
+* export-giggle
+* EventCount.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_EVENTCOUNT_HPP
+#define EXPORT_GIGGLE_EVENTCOUNT_HPP
+
+#include <Types.hpp>
+
+#include <atomic>
+
+namespace giggle::common::threading
+{
+
+	/**
+	 * @brief Lets threads sleep until a lock-free condition may have
+	 * changed, at no cost to the side making it change while nobody sleeps.
+	 *
+	 * A waiter announces itself with PrepareWait(), checks its condition
+	 * once more and then either calls CancelWait() or sleeps in Wait()
+	 * with the key it got. A notifier changes the condition first and then
+	 * calls Notify*(), which only bumps the epoch and makes a futex call
+	 * when some thread has announced itself. The announcement and the
+	 * change are both sequentially consistent, so either the waiter sees
+	 * the change when it checks again or the notifier sees the waiter, and
+	 * a wake-up can never be lost.
+	 */
+	class EventCount
+	{
+	public:
+
+		EventCount();
+
+		EventCount(const EventCount&) = delete;
+		EventCount& operator = (const EventCount&) = delete;
+
+		/**
+		 * @brief Announces a wait; check the condition again afterwards.
+		 * @return The key to pass to Wait().
+		 */
+		UInt32 PrepareWait();
+
+		/**
+		 * @brief Withdraws the announcement, when the condition held after all.
+		 */
+		void CancelWait();
+
+		/**
+		 * @brief Sleeps until a notification issued after PrepareWait(), ending the wait.
+		 */
+		void Wait(UInt32 l_key);
+
+		/**
+		 * @brief Wakes one waiting thread, if any.
+		 */
+		void NotifyOne();
+
+		/**
+		 * @brief Wakes every waiting thread.
+		 */
+		void NotifyAll();
+
+		/**
+		 * @brief Wakes up to l_count waiting threads.
+		 */
+		void Notify(UInt32 l_count);
+
+	private:
+
+		std::atomic<UInt32>	_epoch;
+		std::atomic<UInt32>	_waiters;
+	};
+
+} // namespace threading
+
+#endif //EXPORT_GIGGLE_EVENTCOUNT_HPP
@@ -0,0 +1,204 @@
+/*
+* export-giggle
+* InlineTask.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_INLINETASK_HPP
+#define EXPORT_GIGGLE_INLINETASK_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace giggle::common::threading
+{
+
+	/**
+	 * @brief A move-only void() callable that stores small closures in place.
+	 *
+	 * Closures of up to INLINE_SIZE bytes that can be moved without
+	 * throwing live inside the object, so wrapping them allocates
+	 * nothing; larger ones are moved to the heap. Being move-only, it
+	 * can hold move-only closures such as a std::packaged_task, which
+	 * std::function cannot.
+	 */
+	class InlineTask
+	{
+	public:
+
+		enum
+		{
+			INLINE_SIZE = 48
+		};
+
+		InlineTask() :
+			_ops(nullptr)
+		{
+
+		}
+
+		template <class F, class = typename std::enable_if<
+				!std::is_same<typename std::decay<F>::type, InlineTask>::value>::type>
+		InlineTask(F&& l_function) :
+			_ops(nullptr)
+		{
+			typedef typename std::decay<F>::type Function;
+
+			Construct<Function>(std::forward<F>(l_function), std::integral_constant<bool, FitsInline<Function>()>());
+		}
+
+		InlineTask(InlineTask&& l_other) noexcept :
+			_ops(l_other._ops)
+		{
+			if (_ops != nullptr)
+			{
+				_ops->Move(l_other._storage, _storage);
+				l_other._ops = nullptr;
+			}
+		}
+
+		InlineTask& operator = (InlineTask&& l_other) noexcept
+		{
+			if (this != &l_other)
+			{
+				Reset();
+				_ops = l_other._ops;
+
+				if (_ops != nullptr)
+				{
+					_ops->Move(l_other._storage, _storage);
+					l_other._ops = nullptr;
+				}
+			}
+
+			return *this;
+		}
+
+		InlineTask(const InlineTask&) = delete;
+		InlineTask& operator = (const InlineTask&) = delete;
+
+		~InlineTask()
+		{
+			Reset();
+		}
+
+		/**
+		 * @brief Runs the closure; the task must not be empty.
+		 */
+		void operator()()
+		{
+			_ops->Invoke(_storage);
+		}
+
+		explicit operator bool() const
+		{
+			return _ops != nullptr;
+		}
+
+		/**
+		 * @brief Destroys the closure, leaving the task empty.
+		 */
+		void Reset()
+		{
+			if (_ops != nullptr)
+			{
+				_ops->Destroy(_storage);
+				_ops = nullptr;
+			}
+		}
+
+	private:
+
+		template <class Function>
+		static constexpr bool FitsInline()
+		{
+			return sizeof(Function) <= INLINE_SIZE && alignof(Function) <= alignof(std::max_align_t) &&
+				   std::is_nothrow_move_constructible<Function>::value;
+		}
+
+		template <class Function, class F>
+		void Construct(F&& l_function, std::true_type)
+		{
+			new (_storage) Function(std::forward<F>(l_function));
+			_ops = &InlineOps<Function>::Table;
+		}
+
+		template <class Function, class F>
+		void Construct(F&& l_function, std::false_type)
+		{
+			*reinterpret_cast<Function**>(_storage) = new Function(std::forward<F>(l_function));
+			_ops = &HeapOps<Function>::Table;
+		}
+
+		struct Ops
+		{
+			void (*Invoke)(void*);
+			/// Moves the closure from the first storage to the second, destroying the source.
+			void (*Move)(void*, void*);
+			void (*Destroy)(void*);
+		};
+
+		template <class Function>
+		struct InlineOps
+		{
+			static void Invoke(void* l_storage)
+			{
+				(*static_cast<Function*>(l_storage))();
+			}
+
+			static void Move(void* l_from, void* l_to)
+			{
+				new (l_to) Function(std::move(*static_cast<Function*>(l_from)));
+				static_cast<Function*>(l_from)->~Function();
+			}
+
+			static void Destroy(void* l_storage)
+			{
+				static_cast<Function*>(l_storage)->~Function();
+			}
+
+			static constexpr Ops Table{&Invoke, &Move, &Destroy};
+		};
+
+		template <class Function>
+		struct HeapOps
+		{
+			static void Invoke(void* l_storage)
+			{
+				(**static_cast<Function**>(l_storage))();
+			}
+
+			static void Move(void* l_from, void* l_to)
+			{
+				*static_cast<Function**>(l_to) = *static_cast<Function**>(l_from);
+			}
+
+			static void Destroy(void* l_storage)
+			{
+				delete *static_cast<Function**>(l_storage);
+			}
+
+			static constexpr Ops Table{&Invoke, &Move, &Destroy};
+		};
+
+		alignas(std::max_align_t) unsigned char	_storage[INLINE_SIZE];
+		const Ops*								_ops;
+	};
+
+} // namespace threading
+
+#endif //EXPORT_GIGGLE_INLINETASK_HPP
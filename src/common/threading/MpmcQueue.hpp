@@ -0,0 +1,377 @@
+/*
+* export-giggle
+* MpmcQueue.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_MPMCQUEUE_HPP
+#define EXPORT_GIGGLE_MPMCQUEUE_HPP
+
+#include "EventCount.hpp"
+#include "Threading.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace giggle::common::threading
+{
+
+	/**
+	 * @brief A bounded, lock-free queue for any number of producers and
+	 * consumers, with the interface of ThreadSafeQueue.
+	 *
+	 * Every slot carries a sequence number telling whether it is free for
+	 * the producer holding a given position or filled for the consumer
+	 * holding it (Dmitry Vyukov's design): producers and consumers claim
+	 * positions with one compare-and-swap on their own counter and never
+	 * touch each other's, so neither side ever waits for a lock.
+	 *
+	 * WaitPop() sleeps on an EventCount when the queue stays empty for a
+	 * few yields, and Push() on another when it stays full. Either side
+	 * only makes a system call when a thread is actually asleep; otherwise
+	 * a notification costs one fence and one load. The yields keep a
+	 * briefly idle consumer awake, as every push would pay for a wake-up
+	 * call until a sleeping one is back on a CPU.
+	 *
+	 * T must be nothrow movable, as a claimed slot must be filled or emptied.
+	 */
+	template <class T>
+	class MpmcQueue
+	{
+	public:
+
+		enum
+		{
+			DEFAULT_CAPACITY = 1024,
+			/// Tries, yielding in between, before a blocking call goes to sleep.
+			SPIN_LIMIT = 64
+		};
+
+		/**
+		 * @brief Creates the queue.
+		 * @param l_capacity The number of items it holds, rounded up to a power of two.
+		 */
+		explicit MpmcQueue(std::size_t l_capacity = DEFAULT_CAPACITY);
+
+		/**
+		 * @brief Invalidates the queue and destroys the items still in it.
+		 */
+		~MpmcQueue();
+
+		MpmcQueue(const MpmcQueue&) = delete;
+		MpmcQueue& operator = (const MpmcQueue&) = delete;
+
+		/**
+		 * Attempt to get the first value in the queue.
+		 * Returns true if a value was successfully written to the out parameter, false otherwise.
+		 */
+		bool TryPop(T& l_out);
+
+		/**
+		 * Get the first value in the queue.
+		 * Will block until a value is available unless the queue is invalidated.
+		 * Returns true if a value was successfully written to the out parameter, false otherwise.
+		 */
+		bool WaitPop(T& l_out);
+
+		/**
+		 * Push a new value onto the queue, blocking while it is full.
+		 * Returns false if the queue was invalidated, in which case the value is dropped.
+		 */
+		bool Push(T l_value);
+
+		/**
+		 * Push a new value onto the queue if there is room.
+		 * Returns false if the queue is full or invalid, leaving l_value untouched.
+		 */
+		bool TryPush(T&& l_value);
+
+		/**
+		 * Check whether or not the queue is empty; only a snapshot under concurrency.
+		 */
+		bool Empty() const;
+
+		/**
+		 * Clear all items from the queue.
+		 */
+		void Clear();
+
+		/**
+		 * Invalidate the queue, waking every blocked thread.
+		 * It is an error to continue using a queue after this method has been called.
+		 */
+		void Invalidate();
+
+		/**
+		 * Returns whether or not this queue is valid.
+		 */
+		bool IsValid() const;
+
+		std::size_t Capacity() const;
+
+	private:
+
+		static_assert(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value,
+					  "MpmcQueue items must be nothrow movable.");
+
+		struct Cell
+		{
+			std::atomic<std::size_t>	Sequence;
+			alignas(T) unsigned char	Storage[sizeof(T)];
+
+			T* Value()
+			{
+				return reinterpret_cast<T*>(Storage);
+			}
+		};
+
+		bool Enqueue(T& l_value);
+		bool Dequeue(T& l_out);
+
+		const std::size_t				_mask;
+		Cell*							_cells;
+		std::atomic_bool				_valid;
+
+		alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _tail;
+		alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _head;
+		alignas(CACHE_LINE_SIZE) EventCount _notEmpty;
+		EventCount						_notFull;
+	};
+
+	template <class T>
+	MpmcQueue<T>::MpmcQueue(std::size_t l_capacity):
+		_mask(detail::RoundUpToPowerOfTwo(l_capacity < 2 ? 2 : l_capacity) - 1),
+		_cells(new Cell[_mask + 1]),
+		_valid(true),
+		_tail(0),
+		_head(0)
+	{
+		for (std::size_t i = 0; i <= _mask; ++i)
+		{
+			_cells[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	template <class T>
+	MpmcQueue<T>::~MpmcQueue()
+	{
+		Invalidate();
+
+		for (auto position = _head.load(); position != _tail.load(); ++position)
+		{
+			_cells[position & _mask].Value()->~T();
+		}
+
+		delete [] _cells;
+	}
+
+	template <class T>
+	bool MpmcQueue<T>::TryPop(T& l_out)
+	{
+		if (!_valid || !Dequeue(l_out))
+			return false;
+
+		_notFull.NotifyOne();
+		return true;
+	}
+
+	template <class T>
+	bool MpmcQueue<T>::WaitPop(T& l_out)
+	{
+		for (;;)
+		{
+			for (int spin = 0; spin < SPIN_LIMIT; ++spin)
+			{
+				if (TryPop(l_out))
+					return true;
+
+				std::this_thread::yield();
+			}
+
+			auto key = _notEmpty.PrepareWait();
+
+			if (!_valid)
+			{
+				_notEmpty.CancelWait();
+				return false;
+			}
+
+			if (Dequeue(l_out))
+			{
+				_notEmpty.CancelWait();
+				_notFull.NotifyOne();
+				return true;
+			}
+
+			_notEmpty.Wait(key);
+		}
+	}
+
+	template <class T>
+	bool MpmcQueue<T>::Push(T l_value)
+	{
+		for (;;)
+		{
+			for (int spin = 0; spin < SPIN_LIMIT; ++spin)
+			{
+				if (TryPush(std::move(l_value)))
+					return true;
+
+				std::this_thread::yield();
+			}
+
+			auto key = _notFull.PrepareWait();
+
+			if (!_valid)
+			{
+				_notFull.CancelWait();
+				return false;
+			}
+
+			if (Enqueue(l_value))
+			{
+				_notFull.CancelWait();
+				_notEmpty.NotifyOne();
+				return true;
+			}
+
+			_notFull.Wait(key);
+		}
+	}
+
+	template <class T>
+	bool MpmcQueue<T>::TryPush(T&& l_value)
+	{
+		if (!_valid || !Enqueue(l_value))
+			return false;
+
+		_notEmpty.NotifyOne();
+		return true;
+	}
+
+	template <class T>
+	bool MpmcQueue<T>::Empty() const
+	{
+		return _tail.load(std::memory_order_acquire) <= _head.load(std::memory_order_acquire);
+	}
+
+	template <class T>
+	void MpmcQueue<T>::Clear()
+	{
+		T value;
+		while (Dequeue(value))
+		{
+		}
+
+		_notFull.NotifyAll();
+	}
+
+	template <class T>
+	void MpmcQueue<T>::Invalidate()
+	{
+		_valid = false;
+		_notEmpty.NotifyAll();
+		_notFull.NotifyAll();
+	}
+
+	template <class T>
+	bool MpmcQueue<T>::IsValid() const
+	{
+		return _valid;
+	}
+
+	template <class T>
+	std::size_t MpmcQueue<T>::Capacity() const
+	{
+		return _mask + 1;
+	}
+
+	template <class T>
+	bool MpmcQueue<T>::Enqueue(T& l_value)
+	{
+		auto position = _tail.load(std::memory_order_relaxed);
+		Cell* cell;
+
+		for (;;)
+		{
+			cell = &_cells[position & _mask];
+			auto sequence = cell->Sequence.load(std::memory_order_acquire);
+			auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+			if (difference == 0)
+			{
+				// The slot is free for this position; claim the position.
+				if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+			{
+				// The slot still holds the item from a lap ago: full.
+				return false;
+			}
+			else
+			{
+				position = _tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		new (cell->Value()) T(std::move(l_value));
+		cell->Sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <class T>
+	bool MpmcQueue<T>::Dequeue(T& l_out)
+	{
+		auto position = _head.load(std::memory_order_relaxed);
+		Cell* cell;
+
+		for (;;)
+		{
+			cell = &_cells[position & _mask];
+			auto sequence = cell->Sequence.load(std::memory_order_acquire);
+			auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+			if (difference == 0)
+			{
+				if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+			{
+				// Not filled yet for this position: empty.
+				return false;
+			}
+			else
+			{
+				position = _head.load(std::memory_order_relaxed);
+			}
+		}
+
+		l_out = std::move(*cell->Value());
+		cell->Value()->~T();
+
+		// Free for the producer one lap ahead.
+		cell->Sequence.store(position + _mask + 1, std::memory_order_release);
+		return true;
+	}
+
+} // namespace threading
+
+#endif //EXPORT_GIGGLE_MPMCQUEUE_HPP
@@ -0,0 +1,424 @@
+/*
+* export-giggle
+* Parallel.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_PARALLEL_HPP
+#define EXPORT_GIGGLE_PARALLEL_HPP
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace giggle::common::threading
+{
+
+	/**
+	 * @brief A set of tasks on a ThreadPool that can be waited for together.
+	 *
+	 * Wait() does not block: the waiting thread runs pending tasks of the
+	 * pool until every task of the group finished, so fork-join code can
+	 * nest groups on the pool's own workers without starving it. The first
+	 * exception a task throws is kept and rethrown by Wait().
+	 */
+	class TaskGroup
+	{
+	public:
+
+		explicit TaskGroup(ThreadPool& l_pool) :
+			_pool(l_pool),
+			_pending(0)
+		{
+
+		}
+
+		TaskGroup(const TaskGroup&) = delete;
+		TaskGroup& operator = (const TaskGroup&) = delete;
+
+		/**
+		 * @brief Waits for the tasks still running, dropping their exception.
+		 */
+		~TaskGroup()
+		{
+			try
+			{
+				Wait();
+			}
+			catch (...)
+			{
+			}
+		}
+
+		/**
+		 * @brief Runs l_function on the pool as part of the group.
+		 */
+		template <class F>
+		void Run(F&& l_function)
+		{
+			_pending.fetch_add(1, std::memory_order_relaxed);
+
+			try
+			{
+				_pool.Post([this, function = std::forward<F>(l_function)]() mutable
+						   {
+							   {
+								   // Moved out, so nothing it captured outlives the count below.
+								   auto local = std::move(function);
+
+								   try
+								   {
+									   local();
+								   }
+								   catch (...)
+								   {
+									   Fail(std::current_exception());
+								   }
+							   }
+
+							   _pending.fetch_sub(1, std::memory_order_release);
+						   });
+			}
+			catch (...)
+			{
+				_pending.fetch_sub(1, std::memory_order_relaxed);
+				throw;
+			}
+		}
+
+		/**
+		 * @brief Runs pending tasks of the pool until every task of the group finished.
+		 * @throws The first exception thrown by a task of the group.
+		 */
+		void Wait()
+		{
+			while (_pending.load(std::memory_order_acquire) > 0)
+			{
+				if (!_pool.RunPending())
+					std::this_thread::yield();
+			}
+
+			std::exception_ptr exception;
+			{
+				std::lock_guard<std::mutex> lock{_mutex};
+				std::swap(exception, _exception);
+			}
+
+			if (exception)
+				std::rethrow_exception(exception);
+		}
+
+	private:
+
+		void Fail(std::exception_ptr l_exception)
+		{
+			std::lock_guard<std::mutex> lock{_mutex};
+			if (!_exception)
+				_exception = l_exception;
+		}
+
+		ThreadPool&					_pool;
+		std::atomic<std::size_t>	_pending;
+
+		std::mutex					_mutex;
+		std::exception_ptr			_exception;
+	};
+
+	namespace detail
+	{
+		enum
+		{
+			/// Chunks per thread an automatic grain aims for, so uneven chunks still balance out.
+			CHUNKS_PER_THREAD = 8,
+			/// The smallest run ParallelSort() sorts or merges on one thread.
+			MIN_SORT_GRAIN = 2048
+		};
+
+		/**
+		 * @brief Returns l_grain, or a grain giving every thread, the caller included, a few chunks of l_count.
+		 */
+		inline std::size_t Grain(std::size_t l_count, const ThreadPool& l_pool, std::size_t l_grain)
+		{
+			if (l_grain > 0)
+				return l_grain;
+
+			auto chunks = CHUNKS_PER_THREAD * (l_pool.Size() + 1);
+			return std::max<std::size_t>(1, (l_count + chunks - 1) / chunks);
+		}
+
+		template <class Body>
+		struct ForState
+		{
+			TaskGroup&		Group;
+			std::size_t		Grain;
+			const Body&		Function;
+		};
+
+		/**
+		 * Halves the range until it is no larger than the grain, handing the
+		 * upper halves to the pool, where idle workers steal the biggest first.
+		 */
+		template <class Index, class Body>
+		void ForRange(const ForState<Body>& l_state, Index l_first, Index l_last)
+		{
+			while (static_cast<std::size_t>(l_last - l_first) > l_state.Grain)
+			{
+				Index middle = l_first + (l_last - l_first) / 2;
+				l_state.Group.Run([&l_state, middle, l_last]() { ForRange(l_state, middle, l_last); });
+				l_last = middle;
+			}
+
+			for (; l_first < l_last; ++l_first)
+			{
+				l_state.Function(l_first);
+			}
+		}
+
+		/**
+		 * Merges the sorted runs [l_a, l_a + l_countA) and [l_b, l_b + l_countB)
+		 * into l_out, moving the elements. Large merges split at the middle
+		 * of the longer run and the matching point of the other, and merge
+		 * both halves in parallel.
+		 */
+		template <class RandomIt, class OutputIt, class Compare>
+		void MergeRange(ThreadPool& l_pool, RandomIt l_a, std::size_t l_countA, RandomIt l_b, std::size_t l_countB,
+						OutputIt l_out, Compare& l_compare, std::size_t l_grain)
+		{
+			if (l_countA + l_countB <= l_grain)
+			{
+				std::merge(std::make_move_iterator(l_a), std::make_move_iterator(l_a + l_countA),
+						   std::make_move_iterator(l_b), std::make_move_iterator(l_b + l_countB), l_out, l_compare);
+				return;
+			}
+
+			if (l_countA < l_countB)
+			{
+				std::swap(l_a, l_b);
+				std::swap(l_countA, l_countB);
+			}
+
+			auto middleA = l_countA / 2;
+			auto middleB = static_cast<std::size_t>(std::lower_bound(l_b, l_b + l_countB, l_a[middleA], l_compare) - l_b);
+
+			TaskGroup group(l_pool);
+			group.Run([&]() { MergeRange(l_pool, l_a, middleA, l_b, middleB, l_out, l_compare, l_grain); });
+			MergeRange(l_pool, l_a + middleA, l_countA - middleA, l_b + middleB, l_countB - middleB,
+					   l_out + middleA + middleB, l_compare, l_grain);
+			group.Wait();
+		}
+
+		/**
+		 * Sorts [l_first, l_first + l_count), leaving the result there or,
+		 * if l_intoBuffer, in the buffer at l_buffer. The halves are sorted
+		 * in parallel into the other array and merged back.
+		 */
+		template <class RandomIt, class BufferIt, class Compare>
+		void SortRange(ThreadPool& l_pool, RandomIt l_first, BufferIt l_buffer, std::size_t l_count, bool l_intoBuffer,
+					   Compare& l_compare, std::size_t l_grain)
+		{
+			if (l_count <= l_grain)
+			{
+				std::sort(l_first, l_first + l_count, l_compare);
+				if (l_intoBuffer)
+					std::move(l_first, l_first + l_count, l_buffer);
+				return;
+			}
+
+			auto half = l_count / 2;
+
+			TaskGroup group(l_pool);
+			group.Run([&]() { SortRange(l_pool, l_first, l_buffer, half, !l_intoBuffer, l_compare, l_grain); });
+			SortRange(l_pool, l_first + half, l_buffer + half, l_count - half, !l_intoBuffer, l_compare, l_grain);
+			group.Wait();
+
+			if (l_intoBuffer)
+				MergeRange(l_pool, l_first, half, l_first + half, l_count - half, l_buffer, l_compare, l_grain);
+			else
+				MergeRange(l_pool, l_buffer, half, l_buffer + half, l_count - half, l_first, l_compare, l_grain);
+		}
+	}
+
+	/**
+	 * @brief Calls l_body(i) for every i in [l_first, l_last) on l_pool.
+	 *
+	 * The range is split in halves recursively down to chunks of l_grain
+	 * indices, a few per thread when l_grain is 0. The calling thread
+	 * works on the range too and returns once every call returned.
+	 * @throws The first exception thrown by l_body.
+	 */
+	template <class Index, class Body>
+	void ParallelFor(ThreadPool& l_pool, Index l_first, Index l_last, const Body& l_body, std::size_t l_grain = 0)
+	{
+		if (l_first >= l_last)
+			return;
+
+		TaskGroup group(l_pool);
+		detail::ForState<Body> state{group, detail::Grain(static_cast<std::size_t>(l_last - l_first), l_pool, l_grain),
+									 l_body};
+
+		try
+		{
+			detail::ForRange(state, l_first, l_last);
+		}
+		catch (...)
+		{
+			// The tasks refer to state, so they must be finished first.
+			group.Wait();
+			throw;
+		}
+
+		group.Wait();
+	}
+
+	/**
+	 * @brief Combines l_transform(i) for every i in [l_first, l_last) with l_combine.
+	 *
+	 * Every chunk is folded on its own, starting from l_identity, and the
+	 * chunk results are combined in order on the calling thread, so
+	 * l_combine needs to be associative but not commutative.
+	 */
+	template <class Index, class T, class Transform, class Combine>
+	T ParallelReduce(ThreadPool& l_pool, Index l_first, Index l_last, T l_identity, const Transform& l_transform,
+					 const Combine& l_combine, std::size_t l_grain = 0)
+	{
+		if (l_first >= l_last)
+			return l_identity;
+
+		auto count = static_cast<std::size_t>(l_last - l_first);
+		auto grain = detail::Grain(count, l_pool, l_grain);
+		std::vector<T> partials((count + grain - 1) / grain, l_identity);
+
+		ParallelFor(l_pool, std::size_t(0), partials.size(), [&](std::size_t l_chunk)
+		{
+			auto first = l_first + static_cast<Index>(l_chunk * grain);
+			auto last = l_chunk + 1 < partials.size() ? first + static_cast<Index>(grain) : l_last;
+
+			T value = l_identity;
+			for (; first < last; ++first)
+			{
+				value = l_combine(std::move(value), l_transform(first));
+			}
+			partials[l_chunk] = std::move(value);
+		}, 1);
+
+		T result = std::move(l_identity);
+		for (auto& partial : partials)
+		{
+			result = l_combine(std::move(result), std::move(partial));
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Writes the inclusive prefix combination of [l_first, l_last) to l_out.
+	 *
+	 * Each chunk is reduced in parallel, the chunk totals are scanned on
+	 * the calling thread and each chunk is then scanned in parallel from
+	 * its offset, reading every input twice. Both ranges must be random
+	 * access; l_out may be l_first.
+	 * @return The end of the output.
+	 */
+	template <class RandomIt, class OutputIt, class T, class Combine>
+	OutputIt ParallelScan(ThreadPool& l_pool, RandomIt l_first, RandomIt l_last, OutputIt l_out, T l_identity,
+						  const Combine& l_combine, std::size_t l_grain = 0)
+	{
+		auto count = static_cast<std::size_t>(std::distance(l_first, l_last));
+		if (count == 0)
+			return l_out;
+
+		auto grain = detail::Grain(count, l_pool, l_grain);
+		std::vector<T> offsets((count + grain - 1) / grain, l_identity);
+
+		auto bounds = [&](std::size_t l_chunk, std::size_t& l_begin, std::size_t& l_end)
+		{
+			l_begin = l_chunk * grain;
+			l_end = std::min(count, l_begin + grain);
+		};
+
+		ParallelFor(l_pool, std::size_t(0), offsets.size(), [&](std::size_t l_chunk)
+		{
+			std::size_t begin, end;
+			bounds(l_chunk, begin, end);
+
+			T value = l_identity;
+			for (auto input = l_first + begin; input != l_first + end; ++input)
+			{
+				value = l_combine(std::move(value), *input);
+			}
+			offsets[l_chunk] = std::move(value);
+		}, 1);
+
+		// Each chunk's total becomes the combination of every chunk before it.
+		T running = l_identity;
+		for (auto& offset : offsets)
+		{
+			T total = std::move(offset);
+			offset = running;
+			running = l_combine(std::move(running), std::move(total));
+		}
+
+		ParallelFor(l_pool, std::size_t(0), offsets.size(), [&](std::size_t l_chunk)
+		{
+			std::size_t begin, end;
+			bounds(l_chunk, begin, end);
+
+			T value = offsets[l_chunk];
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				value = l_combine(std::move(value), l_first[i]);
+				l_out[i] = value;
+			}
+		}, 1);
+
+		return l_out + count;
+	}
+
+	/**
+	 * @brief Sorts [l_first, l_last) with l_compare, which need not be stable.
+	 *
+	 * A merge sort: runs of at least MIN_SORT_GRAIN elements are sorted
+	 * with std::sort, and both the halves and the merges above them run in
+	 * parallel, moving the elements through a buffer of the same size.
+	 */
+	template <class RandomIt, class Compare = std::less<>>
+	void ParallelSort(ThreadPool& l_pool, RandomIt l_first, RandomIt l_last, Compare l_compare = Compare(),
+					  std::size_t l_grain = 0)
+	{
+		typedef typename std::iterator_traits<RandomIt>::value_type Value;
+
+		auto count = static_cast<std::size_t>(l_last - l_first);
+		auto grain = std::max<std::size_t>(detail::Grain(count, l_pool, l_grain), detail::MIN_SORT_GRAIN);
+
+		if (count <= grain)
+		{
+			std::sort(l_first, l_last, l_compare);
+			return;
+		}
+
+		// The elements move to the buffer and are sorted back into place.
+		std::vector<Value> buffer(std::make_move_iterator(l_first), std::make_move_iterator(l_last));
+		detail::SortRange(l_pool, buffer.begin(), l_first, count, true, l_compare, grain);
+	}
+
+} // namespace threading
+
+#endif //EXPORT_GIGGLE_PARALLEL_HPP
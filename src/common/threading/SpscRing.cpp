@@ -0,0 +1,174 @@
+/*
+* export-giggle
+* SpscRing.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "SpscRing.hpp"
+#include <exceptions/SystemException.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace giggle::common;
+using namespace giggle::common::threading;
+
+SpscByteRing::SpscByteRing(std::size_t l_capacity, bool l_mirrored):
+	_capacity(detail::RoundUpToPowerOfTwo(std::max(l_capacity, static_cast<std::size_t>(sysconf(_SC_PAGESIZE))))),
+	_mirrored(l_mirrored),
+	_buffer(nullptr),
+	_head(0),
+	_tail(0)
+{
+	if (!_mirrored)
+	{
+		_buffer = new char[_capacity];
+		return;
+	}
+
+	auto descriptor = memfd_create("giggle-ring", MFD_CLOEXEC);
+	if (descriptor < 0)
+		throw exception::SystemException("Error creating ring buffer memory.", std::strerror(errno), errno);
+
+	if (ftruncate(descriptor, static_cast<off_t>(_capacity)) != 0)
+	{
+		auto error = errno;
+		close(descriptor);
+		throw exception::SystemException("Error sizing ring buffer memory.", std::strerror(error), error);
+	}
+
+	// Reserve twice the size, then map the same memory over both halves.
+	auto reserved = mmap(nullptr, _capacity * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	auto buffer = static_cast<char*>(reserved);
+
+	if (reserved == MAP_FAILED ||
+		mmap(buffer, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, descriptor, 0) == MAP_FAILED ||
+		mmap(buffer + _capacity, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, descriptor, 0) == MAP_FAILED)
+	{
+		auto error = errno;
+		if (reserved != MAP_FAILED)
+			munmap(reserved, _capacity * 2);
+		close(descriptor);
+		throw exception::SystemException("Error mapping ring buffer.", std::strerror(error), error);
+	}
+
+	// The mappings keep the memory alive.
+	close(descriptor);
+	_buffer = buffer;
+}
+
+SpscByteRing::~SpscByteRing()
+{
+	if (_mirrored)
+		munmap(_buffer, _capacity * 2);
+	else
+		delete [] _buffer;
+}
+
+char* SpscByteRing::WriteSpace(std::size_t& l_size)
+{
+	// A span covers all the free space, so the consumer's counter is read every time.
+	auto tail = _tail.load(std::memory_order_relaxed);
+	auto offset = tail & (_capacity - 1);
+	l_size = _capacity - (tail - _head.load(std::memory_order_acquire));
+
+	if (!_mirrored)
+		l_size = std::min(l_size, _capacity - offset);
+
+	return _buffer + offset;
+}
+
+void SpscByteRing::Commit(std::size_t l_size)
+{
+	_tail.store(_tail.load(std::memory_order_relaxed) + l_size, std::memory_order_release);
+}
+
+std::size_t SpscByteRing::Write(const char* l_data, std::size_t l_size)
+{
+	std::size_t written = 0;
+
+	// Twice at most without mirroring: up to the end of the buffer, then from its start.
+	while (written < l_size)
+	{
+		std::size_t space;
+		auto destination = WriteSpace(space);
+		if (space == 0)
+			break;
+
+		auto take = std::min(space, l_size - written);
+		std::memcpy(destination, l_data + written, take);
+		Commit(take);
+		written += take;
+	}
+
+	return written;
+}
+
+const char* SpscByteRing::ReadSpace(std::size_t& l_size)
+{
+	auto head = _head.load(std::memory_order_relaxed);
+	auto offset = head & (_capacity - 1);
+	l_size = _tail.load(std::memory_order_acquire) - head;
+
+	if (!_mirrored)
+		l_size = std::min(l_size, _capacity - offset);
+
+	return _buffer + offset;
+}
+
+void SpscByteRing::Consume(std::size_t l_size)
+{
+	_head.store(_head.load(std::memory_order_relaxed) + l_size, std::memory_order_release);
+}
+
+std::size_t SpscByteRing::Read(char* l_data, std::size_t l_size)
+{
+	std::size_t read = 0;
+
+	while (read < l_size)
+	{
+		std::size_t available;
+		auto source = ReadSpace(available);
+		if (available == 0)
+			break;
+
+		auto take = std::min(available, l_size - read);
+		std::memcpy(l_data + read, source, take);
+		Consume(take);
+		read += take;
+	}
+
+	return read;
+}
+
+std::size_t SpscByteRing::Size() const
+{
+	auto head = _head.load(std::memory_order_acquire);
+	return _tail.load(std::memory_order_acquire) - head;
+}
+
+std::size_t SpscByteRing::Capacity() const
+{
+	return _capacity;
+}
+
+bool SpscByteRing::Mirrored() const
+{
+	return _mirrored;
+}
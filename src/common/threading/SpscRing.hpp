@@ -0,0 +1,358 @@
+/*
+* export-giggle
+* SpscRing.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_SPSCRING_HPP
+#define EXPORT_GIGGLE_SPSCRING_HPP
+
+#include "Threading.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace giggle::common::threading
+{
+
+	/**
+	 * @brief A bounded, lock-free queue between exactly one producer
+	 * thread and one consumer thread.
+	 *
+	 * Items live in a power of two array of slots indexed by two ever
+	 * increasing counters: the producer only writes the tail and the
+	 * consumer only the head, each on its own cache line. Each side also
+	 * keeps a private copy of the other's counter and only reloads it
+	 * when the ring looks full (or empty), so in steady state a push or a
+	 * pop touches no cache line the other thread writes to. The batch
+	 * versions publish a whole run of items with a single store.
+	 *
+	 * Nothing blocks; callers decide how to wait when TryPush() or
+	 * TryPop() fail. Calling the producer methods from more than one
+	 * thread, or the consumer methods from more than one, is undefined.
+	 */
+	template <class T>
+	class SpscRing
+	{
+	public:
+
+		/**
+		 * @brief Creates the ring.
+		 * @param l_capacity The number of items it holds, rounded up to a power of two.
+		 */
+		explicit SpscRing(std::size_t l_capacity);
+
+		/**
+		 * @brief Destroys the items still queued.
+		 */
+		~SpscRing();
+
+		SpscRing(const SpscRing&) = delete;
+		SpscRing& operator = (const SpscRing&) = delete;
+
+		/**
+		 * @brief Queues an item. Producer only.
+		 * @return false if the ring is full, in which case l_value is left untouched.
+		 */
+		bool TryPush(T&& l_value);
+		bool TryPush(const T& l_value);
+
+		/**
+		 * @brief Queues as many of the l_count items at l_values as fit, moving
+		 * them out. Producer only.
+		 * @return The number of items queued, a prefix of l_values.
+		 */
+		std::size_t TryPush(T* l_values, std::size_t l_count);
+
+		/**
+		 * @brief Takes the oldest item. Consumer only.
+		 * @return false if the ring is empty.
+		 */
+		bool TryPop(T& l_value);
+
+		/**
+		 * @brief Takes up to l_max of the oldest items. Consumer only.
+		 * @return The number of items written to l_values.
+		 */
+		std::size_t TryPop(T* l_values, std::size_t l_max);
+
+		/**
+		 * @brief Returns the number of queued items; only a snapshot
+		 * when called while the other side is running.
+		 */
+		std::size_t Size() const;
+
+		std::size_t Capacity() const;
+
+		bool Empty() const;
+
+	private:
+
+		/// Makes room for up to l_count items, returning how many fit.
+		std::size_t Writable(std::size_t l_count);
+
+		/// Returns how many of up to l_count items are available.
+		std::size_t Readable(std::size_t l_count);
+
+		T* Slot(std::size_t l_index) const;
+
+		const std::size_t							_mask;
+		T*											_slots;
+
+		alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _head;
+		std::size_t									_cachedTail;
+
+		alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _tail;
+		std::size_t									_cachedHead;
+
+		char _padding[CACHE_LINE_SIZE - sizeof(std::size_t) * 2];
+	};
+
+	/**
+	 * @brief A bounded single-producer/single-consumer queue of bytes
+	 * whose free and used space can be read and written in place.
+	 *
+	 * The producer asks for WriteSpace(), copies or reads (say, from a
+	 * socket) straight into it and publishes the bytes with Commit(); the
+	 * consumer gets them from ReadSpace() and releases them with
+	 * Consume(). Same ordering rules as SpscRing; the counters are on
+	 * separate cache lines too, but as a span covers all the free (or
+	 * queued) space, each call reads the other side's counter.
+	 *
+	 * In mirrored mode the buffer is mapped twice, back to back, so the
+	 * bytes that wrap around the end appear again right after it and
+	 * every span is contiguous, whatever its position. Otherwise spans
+	 * stop at the end of the buffer and a second call returns the rest.
+	 */
+	class SpscByteRing
+	{
+	public:
+
+		/**
+		 * @brief Creates the ring.
+		 * @throws SystemException if the mirrored mapping fails.
+		 * @param l_capacity The size in bytes, rounded up to a power of two of at least a page.
+		 * @param l_mirrored Whether to map the buffer twice so spans never wrap.
+		 */
+		explicit SpscByteRing(std::size_t l_capacity, bool l_mirrored = true);
+		~SpscByteRing();
+
+		SpscByteRing(const SpscByteRing&) = delete;
+		SpscByteRing& operator = (const SpscByteRing&) = delete;
+
+		/**
+		 * @brief Returns the free space. Producer only.
+		 * @param l_size Receives the number of contiguous free bytes, 0 if the ring is full.
+		 */
+		char* WriteSpace(std::size_t& l_size);
+
+		/**
+		 * @brief Publishes l_size bytes written at WriteSpace(). Producer only.
+		 */
+		void Commit(std::size_t l_size);
+
+		/**
+		 * @brief Copies as much of the data as fits. Producer only.
+		 * @return The number of bytes queued.
+		 */
+		std::size_t Write(const char* l_data, std::size_t l_size);
+
+		/**
+		 * @brief Returns the queued bytes. Consumer only.
+		 * @param l_size Receives the number of contiguous queued bytes, 0 if the ring is empty.
+		 */
+		const char* ReadSpace(std::size_t& l_size);
+
+		/**
+		 * @brief Releases l_size bytes read at ReadSpace(). Consumer only.
+		 */
+		void Consume(std::size_t l_size);
+
+		/**
+		 * @brief Copies up to l_size queued bytes out. Consumer only.
+		 * @return The number of bytes taken.
+		 */
+		std::size_t Read(char* l_data, std::size_t l_size);
+
+		std::size_t Size() const;
+		std::size_t Capacity() const;
+		bool Mirrored() const;
+
+	private:
+
+		std::size_t									_capacity;
+		bool										_mirrored;
+		char*										_buffer;
+
+		alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _head;
+		alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _tail;
+
+		char _padding[CACHE_LINE_SIZE - sizeof(std::size_t)];
+	};
+
+	template <class T>
+	SpscRing<T>::SpscRing(std::size_t l_capacity):
+		_mask(detail::RoundUpToPowerOfTwo(l_capacity < 2 ? 2 : l_capacity) - 1),
+		_slots(std::allocator<T>().allocate(_mask + 1)),
+		_head(0),
+		_cachedTail(0),
+		_tail(0),
+		_cachedHead(0)
+	{
+
+	}
+
+	template <class T>
+	SpscRing<T>::~SpscRing()
+	{
+		for (auto index = _head.load(); index != _tail.load(); ++index)
+		{
+			Slot(index)->~T();
+		}
+
+		std::allocator<T>().deallocate(_slots, _mask + 1);
+	}
+
+	template <class T>
+	bool SpscRing<T>::TryPush(T&& l_value)
+	{
+		if (Writable(1) == 0)
+			return false;
+
+		auto tail = _tail.load(std::memory_order_relaxed);
+		new (Slot(tail)) T(std::move(l_value));
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <class T>
+	bool SpscRing<T>::TryPush(const T& l_value)
+	{
+		if (Writable(1) == 0)
+			return false;
+
+		auto tail = _tail.load(std::memory_order_relaxed);
+		new (Slot(tail)) T(l_value);
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <class T>
+	std::size_t SpscRing<T>::TryPush(T* l_values, std::size_t l_count)
+	{
+		auto count = Writable(l_count);
+		auto tail = _tail.load(std::memory_order_relaxed);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			new (Slot(tail + i)) T(std::move(l_values[i]));
+		}
+
+		_tail.store(tail + count, std::memory_order_release);
+		return count;
+	}
+
+	template <class T>
+	bool SpscRing<T>::TryPop(T& l_value)
+	{
+		if (Readable(1) == 0)
+			return false;
+
+		auto head = _head.load(std::memory_order_relaxed);
+		auto slot = Slot(head);
+		l_value = std::move(*slot);
+		slot->~T();
+		_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <class T>
+	std::size_t SpscRing<T>::TryPop(T* l_values, std::size_t l_max)
+	{
+		auto count = Readable(l_max);
+		auto head = _head.load(std::memory_order_relaxed);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			auto slot = Slot(head + i);
+			l_values[i] = std::move(*slot);
+			slot->~T();
+		}
+
+		_head.store(head + count, std::memory_order_release);
+		return count;
+	}
+
+	template <class T>
+	std::size_t SpscRing<T>::Size() const
+	{
+		auto head = _head.load(std::memory_order_acquire);
+		return _tail.load(std::memory_order_acquire) - head;
+	}
+
+	template <class T>
+	std::size_t SpscRing<T>::Capacity() const
+	{
+		return _mask + 1;
+	}
+
+	template <class T>
+	bool SpscRing<T>::Empty() const
+	{
+		return Size() == 0;
+	}
+
+	template <class T>
+	std::size_t SpscRing<T>::Writable(std::size_t l_count)
+	{
+		auto tail = _tail.load(std::memory_order_relaxed);
+		auto free = Capacity() - (tail - _cachedHead);
+
+		if (free < l_count)
+		{
+			_cachedHead = _head.load(std::memory_order_acquire);
+			free = Capacity() - (tail - _cachedHead);
+		}
+
+		return free < l_count ? free : l_count;
+	}
+
+	template <class T>
+	std::size_t SpscRing<T>::Readable(std::size_t l_count)
+	{
+		auto head = _head.load(std::memory_order_relaxed);
+		auto available = _cachedTail - head;
+
+		if (available < l_count)
+		{
+			_cachedTail = _tail.load(std::memory_order_acquire);
+			available = _cachedTail - head;
+		}
+
+		return available < l_count ? available : l_count;
+	}
+
+	template <class T>
+	T* SpscRing<T>::Slot(std::size_t l_index) const
+	{
+		return _slots + (l_index & _mask);
+	}
+
+} // namespace threading
+
+#endif //EXPORT_GIGGLE_SPSCRING_HPP
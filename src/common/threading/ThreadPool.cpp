@@ -0,0 +1,359 @@
+/*
+* export-giggle
+* ThreadPool.cpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <random>
+
+using namespace giggle::common;
+using namespace giggle::common::threading;
+
+struct ThreadPool::Worker
+{
+	Worker(ThreadPool* l_pool, unsigned l_seed):
+		Pool(l_pool),
+		Random(l_seed)
+	{
+
+	}
+
+	ThreadPool*						Pool;
+	WorkStealingDeque<Task*>		Deque;
+	std::thread						Thread;
+	std::minstd_rand				Random;
+};
+
+namespace
+{
+	/// The worker running on the calling thread, if any.
+	thread_local void* t_worker = nullptr;
+}
+
+ThreadPool::ThreadPool(size_t l_threads):
+	ThreadPool(l_threads, ThreadPoolOptions())
+{
+
+}
+
+ThreadPool::ThreadPool(size_t l_threads, const ThreadPoolOptions& l_options):
+	_tasks(sizeof(Task), PREALLOCATED_TASKS, 0, TASK_MAGAZINE_SIZE),
+	_injected(0),
+	_stop(false)
+{
+	try
+	{
+		for (size_t i = 0; i < l_threads; ++i)
+		{
+			_workers.push_back(new Worker(this, static_cast<unsigned>(i + 1)));
+		}
+
+		// Started once every deque exists, as workers steal from all of them.
+		for (auto worker : _workers)
+		{
+			worker->Thread = std::thread([this, worker]() { Run(*worker); });
+		}
+
+		Place(l_options);
+	}
+	catch (...)
+	{
+		Shutdown();
+		throw;
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	Shutdown();
+}
+
+void ThreadPool::Place(const ThreadPoolOptions& l_options)
+{
+	auto cpus = l_options.Cpus;
+	if (cpus.empty() && l_options.NumaNode >= 0)
+	{
+		auto nodes = NumaNodes();
+		cpus = nodes[static_cast<std::size_t>(l_options.NumaNode) % nodes.size()];
+	}
+
+	for (std::size_t i = 0; i < _workers.size(); ++i)
+	{
+		auto thread = _workers[i]->Thread.native_handle();
+
+		// Long names lose the end of the prefix rather than the index.
+		if (!l_options.Name.empty())
+		{
+			auto suffix = "-" + std::to_string(i);
+			SetThreadName(thread, l_options.Name.substr(0, 15 - std::min<std::size_t>(15, suffix.size())) + suffix);
+		}
+
+		if (cpus.empty())
+			continue;
+
+		if (l_options.PinEach)
+			SetAffinity(thread, CpuList{cpus[i % cpus.size()]});
+		else
+			SetAffinity(thread, cpus);
+	}
+}
+
+void ThreadPool::Shutdown()
+{
+	_stop = true;
+	_idle.NotifyAll();
+
+	for (auto worker : _workers)
+	{
+		if (worker->Thread.joinable())
+			worker->Thread.join();
+	}
+
+	for (auto worker : _workers)
+	{
+		delete worker;
+	}
+	_workers.clear();
+}
+
+std::size_t ThreadPool::Size() const
+{
+	return _workers.size();
+}
+
+bool ThreadPool::OnWorker() const
+{
+	auto worker = static_cast<Worker*>(t_worker);
+	return worker != nullptr && worker->Pool == this;
+}
+
+void ThreadPool::Submit(Task* l_task)
+{
+	if (OnWorker())
+	{
+		static_cast<Worker*>(t_worker)->Deque.Push(l_task);
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock{_injectionMutex};
+		_injection.push_back(l_task);
+		++_injected;
+	}
+
+	_idle.NotifyOne();
+}
+
+void ThreadPool::Submit(Task** l_tasks, std::size_t l_count)
+{
+	if (OnWorker())
+	{
+		auto worker = static_cast<Worker*>(t_worker);
+
+		for (std::size_t i = 0; i < l_count; ++i)
+		{
+			try
+			{
+				worker->Deque.Push(l_tasks[i]);
+			}
+			catch (...)
+			{
+				Discard(l_tasks + i, l_count - i);
+				throw;
+			}
+		}
+	}
+	else
+	{
+		try
+		{
+			std::lock_guard<std::mutex> lock{_injectionMutex};
+			_injection.insert(_injection.end(), l_tasks, l_tasks + l_count);
+			_injected += l_count;
+		}
+		catch (...)
+		{
+			Discard(l_tasks, l_count);
+			throw;
+		}
+	}
+
+	_idle.Notify(static_cast<UInt32>(std::min(l_count, _workers.size())));
+}
+
+void ThreadPool::Discard(Task** l_tasks, std::size_t l_count)
+{
+	for (std::size_t i = 0; i < l_count; ++i)
+	{
+		l_tasks[i]->~Task();
+		_tasks.Release(l_tasks[i]);
+	}
+}
+
+void ThreadPool::Run(Worker& l_worker)
+{
+	t_worker = &l_worker;
+
+	for (;;)
+	{
+		Task* task = nullptr;
+
+		for (int spin = 0; spin < SPIN_LIMIT && task == nullptr; ++spin)
+		{
+			task = FindTask(l_worker);
+			if (task == nullptr)
+				std::this_thread::yield();
+		}
+
+		if (task == nullptr)
+		{
+			auto key = _idle.PrepareWait();
+
+			task = FindTask(l_worker);
+			if (task == nullptr)
+			{
+				if (_stop)
+				{
+					_idle.CancelWait();
+					break;
+				}
+
+				_idle.Wait(key);
+				continue;
+			}
+
+			_idle.CancelWait();
+		}
+
+		Execute(task);
+	}
+
+	t_worker = nullptr;
+}
+
+bool ThreadPool::RunPending()
+{
+	auto task = OnWorker() ? FindTask(*static_cast<Worker*>(t_worker)) : FindTask();
+	if (task == nullptr)
+		return false;
+
+	Execute(task);
+	return true;
+}
+
+void ThreadPool::Execute(Task* l_task) noexcept
+{
+	(*l_task)();
+	l_task->~Task();
+	_tasks.Release(l_task);
+}
+
+ThreadPool::Task* ThreadPool::FindTask(Worker& l_worker)
+{
+	Task* task = nullptr;
+
+	if (l_worker.Deque.Pop(task))
+		return task;
+
+	if (_injected.load(std::memory_order_relaxed) > 0)
+	{
+		task = TakeInjected(l_worker);
+		if (task != nullptr)
+			return task;
+	}
+
+	// Start at a random victim, so thieves spread out.
+	auto count = _workers.size();
+	auto first = count > 1 ? l_worker.Random() % count : 0;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto victim = _workers[(first + i) % count];
+		if (victim != &l_worker && victim->Deque.Steal(task))
+			return task;
+	}
+
+	return nullptr;
+}
+
+ThreadPool::Task* ThreadPool::TakeInjected(Worker& l_worker)
+{
+	Task* tasks[BATCH_SIZE];
+	std::size_t count;
+
+	{
+		std::lock_guard<std::mutex> lock{_injectionMutex};
+
+		// A fair share, so one worker does not hoard a burst the others could run.
+		count = std::min<std::size_t>(BATCH_SIZE, (_injection.size() + _workers.size() - 1) / _workers.size());
+
+		std::copy(_injection.begin(), _injection.begin() + count, tasks);
+		_injection.erase(_injection.begin(), _injection.begin() + count);
+		_injected -= count;
+	}
+
+	if (count == 0)
+		return nullptr;
+
+	// The rest go to the deque, newest first, so they run in submission order; idle workers may steal them.
+	std::size_t pushed = 1;
+
+	try
+	{
+		for (; pushed < count; ++pushed)
+		{
+			l_worker.Deque.Push(tasks[count - pushed]);
+		}
+	}
+	catch (...)
+	{
+		// Whatever did not fit goes back where it came from.
+		std::lock_guard<std::mutex> lock{_injectionMutex};
+		_injection.insert(_injection.begin(), tasks + 1, tasks + count - pushed + 1);
+		_injected += count - pushed;
+	}
+
+	if (count > 1)
+		_idle.NotifyOne();
+
+	return tasks[0];
+}
+
+ThreadPool::Task* ThreadPool::FindTask()
+{
+	Task* task = nullptr;
+
+	if (_injected.load(std::memory_order_relaxed) > 0)
+	{
+		std::lock_guard<std::mutex> lock{_injectionMutex};
+		if (!_injection.empty())
+		{
+			task = _injection.front();
+			_injection.pop_front();
+			--_injected;
+			return task;
+		}
+	}
+
+	for (auto victim : _workers)
+	{
+		if (victim->Deque.Steal(task))
+			return task;
+	}
+
+	return nullptr;
+}
@@ -19,66 +19,165 @@
 #ifndef EXPORT_GIGGLE_THREADPOOL_HPP
 #define EXPORT_GIGGLE_THREADPOOL_HPP
 
+#include "Affinity.hpp"
+#include "EventCount.hpp"
+#include "InlineTask.hpp"
+#include "WorkStealingDeque.hpp"
+
+#include <memory/MemoryPool.hpp>
+
+#include <atomic>
+#include <deque>
 #include <vector>
-#include <queue>
 #include <memory>
 #include <thread>
 #include <mutex>
-#include <condition_variable>
 #include <future>
 #include <functional>
 #include <stdexcept>
+#include <string>
 
 namespace giggle::common::threading {
 
+	/**
+	 * @brief Where the workers of a ThreadPool run and what they are called.
+	 */
+	struct ThreadPoolOptions
+	{
+		/// Workers are named Name-<index>, with Name cut to fit the 15 characters Linux keeps; empty leaves them unnamed.
+		std::string Name = "pool";
+		/// The CPUs the workers run on; empty lets them float, unless NumaNode is set.
+		CpuList Cpus;
+		/// When Cpus is empty, the NUMA node whose CPUs are used, see NumaNodes(); -1 for none.
+		/// Node numbers wrap around, so a single-node machine simply uses its only node.
+		int NumaNode = -1;
+		/// Pins worker i to the single CPU Cpus[i % size] instead of letting every worker use all of them.
+		bool PinEach = false;
+	};
+
+	/**
+	 * @brief A work-stealing thread pool.
+	 *
+	 * Every worker owns a WorkStealingDeque. Tasks submitted by a task
+	 * running on a worker go to that worker's deque, where it picks them
+	 * up newest first, so a task that spawns subtasks keeps its data in
+	 * cache and takes no lock. Tasks submitted from other threads go to a
+	 * shared injection queue. A worker out of work takes from its own
+	 * deque, then the injection queue, then steals the oldest task of
+	 * another worker, and only sleeps after a few rounds of finding
+	 * nothing; submitting wakes a sleeping worker, if there is one.
+	 *
+	 * Tasks are InlineTasks placed in fixed-size nodes taken from a
+	 * MemoryPool, whose per-thread magazines hand them out without a lock,
+	 * so in steady state Post() of a small closure allocates nothing.
+	 * enqueue() adds the shared state of its future and nothing else.
+	 *
+	 * Workers can be named and confined to a set of CPUs, such as those of
+	 * a NUMA node, see ThreadPoolOptions; memory they touch first is then
+	 * allocated on that node.
+	 *
+	 * The destructor runs every task submitted so far, including those
+	 * they submit in turn, before joining the workers; only other threads
+	 * are refused once it started.
+	 */
 	class ThreadPool {
 	public:
+
+		typedef InlineTask Task;
+
 		explicit ThreadPool(size_t);
+
+		/**
+		 * @brief Starts l_threads workers placed as l_options says.
+		 * @throws SystemException if the workers cannot be given the requested CPUs.
+		 */
+		ThreadPool(size_t l_threads, const ThreadPoolOptions& l_options);
+
 		template<class F, class... Args>
 		auto enqueue(F&& f, Args&&... args)
 		-> std::future<typename std::result_of<F(Args...)>::type>;
+
+		/**
+		 * @brief Submits l_function to run once, without a way to wait for it.
+		 * An exception escaping l_function terminates the process, as it
+		 * would on a std::thread; use enqueue() to get it back instead.
+		 * @throws std::runtime_error if the pool is stopping and the caller is not one of its tasks.
+		 */
+		template<class F>
+		void Post(F&& l_function);
+
+		/**
+		 * @brief Posts a copy of every callable in [l_first, l_last), as Post() would.
+		 * Pass move iterators to move them instead.
+		 * Tasks are submitted in groups of up to BATCH_SIZE, each under a
+		 * single lock, waking as many sleeping workers as it has tasks.
+		 * If making a task throws, those of the earlier groups already run.
+		 * @throws std::runtime_error if the pool is stopping and the caller is not one of its tasks.
+		 */
+		template<class Iterator>
+		void EnqueueBatch(Iterator l_first, Iterator l_last);
+
 		~ThreadPool();
+
+		/**
+		 * @brief Returns the number of workers.
+		 */
+		std::size_t Size() const;
+
+		/**
+		 * @brief Runs one pending task on the calling thread, if there is one.
+		 * Lets a thread waiting for tasks of this pool help run them
+		 * instead of blocking. A worker looks where it would for its next
+		 * task; any other thread takes from the injection queue or steals.
+		 * @return Whether a task ran.
+		 */
+		bool RunPending();
+
 	private:
-		// need to keep track of threads so we can join them
-		std::vector< std::thread > workers;
-		// the task queue
-		std::queue< std::function<void()> > tasks;
-
-		// synchronization
-		std::mutex queue_mutex;
-		std::condition_variable condition;
-		bool stop;
-	};
 
-	/**
-	 * The constructor just launches some amount of workers
-	 */
-	inline ThreadPool::ThreadPool(size_t threads)
-			:   stop(false)
-	{
-		for(size_t i = 0;i<threads;++i)
-			workers.emplace_back(
-					[this]
-					{
-						for(;;)
-						{
-							std::function<void()> task;
-
-							{
-								std::unique_lock<std::mutex> lock(this->queue_mutex);
-								this->condition.wait(lock,
-													 [this]{ return this->stop || !this->tasks.empty(); });
-								if(this->stop && this->tasks.empty())
-									return;
-								task = std::move(this->tasks.front());
-								this->tasks.pop();
-							}
-
-							task();
-						}
-					}
-			);
-	}
+		struct Worker;
+
+		enum
+		{
+			/// Rounds of looking for work, yielding in between, before a worker sleeps.
+			SPIN_LIMIT = 64,
+			/// Task nodes allocated up front.
+			PREALLOCATED_TASKS = 256,
+			/// Task nodes each thread caches; a thread that only submits drains it every this many tasks.
+			TASK_MAGAZINE_SIZE = 64,
+			/// Tasks EnqueueBatch() submits at once, and the most a worker takes from the injection queue.
+			BATCH_SIZE = 32
+		};
+
+		/// True if the calling thread is one of this pool's workers.
+		bool OnWorker() const;
+
+		/// Names and pins the started workers.
+		void Place(const ThreadPoolOptions& l_options);
+		/// Runs what is left, then joins and frees the workers.
+		void Shutdown();
+
+		void Submit(Task* l_task);
+		/// Submits l_count tasks, discarding those it could not submit if it throws.
+		void Submit(Task** l_tasks, std::size_t l_count);
+		void Discard(Task** l_tasks, std::size_t l_count);
+		void Run(Worker& l_worker);
+		void Execute(Task* l_task) noexcept;
+		Task* FindTask(Worker& l_worker);
+		Task* TakeInjected(Worker& l_worker);
+		/// Finds a task for a thread that is not a worker.
+		Task* FindTask();
+
+		memory::MemoryPool		_tasks;
+		std::vector<Worker*>	_workers;
+
+		std::mutex				_injectionMutex;
+		std::deque<Task*>		_injection;
+		std::atomic<size_t>		_injected;
+
+		EventCount				_idle;
+		std::atomic_bool		_stop;
+	};
 
 	/**
 	 * Add new work item to the pool
@@ -89,36 +188,80 @@ namespace giggle::common::threading {
 	{
 		using return_type = typename std::result_of<F(Args...)>::type;
 
-		auto task = std::make_shared< std::packaged_task<return_type()> >(
+		// packaged_task is move-only, which the InlineTask holds directly
+		std::packaged_task<return_type()> task(
 				std::bind(std::forward<F>(f), std::forward<Args>(args)...)
 		);
 
-		std::future<return_type> res = task->get_future();
-		{
-			std::unique_lock<std::mutex> lock(queue_mutex);
+		std::future<return_type> res = task.get_future();
+		Post(std::move(task));
+		return res;
+	}
+
+	template<class F>
+	void ThreadPool::Post(F&& l_function)
+	{
+		// don't allow enqueueing after stopping the pool, except from the tasks it still runs
+		if(_stop && !OnWorker())
+			throw std::runtime_error("enqueue on stopped ThreadPool");
 
-			// don't allow enqueueing after stopping the pool
-			if(stop)
-				throw std::runtime_error("enqueue on stopped ThreadPool");
+		auto node = _tasks.GetMemory();
+		Task* task = nullptr;
 
-			tasks.emplace([task](){ (*task)(); });
+		try
+		{
+			task = new (node) Task(std::forward<F>(l_function));
+			Submit(task);
+		}
+		catch (...)
+		{
+			if (task != nullptr)
+				task->~Task();
+
+			_tasks.Release(node);
+			throw;
 		}
-		condition.notify_one();
-		return res;
 	}
 
-	/**
-	 * @brief The destructor joins all threads
-	 */
-	inline ThreadPool::~ThreadPool()
+	template<class Iterator>
+	void ThreadPool::EnqueueBatch(Iterator l_first, Iterator l_last)
 	{
+		if(_stop && !OnWorker())
+			throw std::runtime_error("enqueue on stopped ThreadPool");
+
+		Task* tasks[BATCH_SIZE];
+
+		while (l_first != l_last)
 		{
-			std::unique_lock<std::mutex> lock(queue_mutex);
-			stop = true;
+			std::size_t count = 0;
+
+			try
+			{
+				for (; l_first != l_last && count < BATCH_SIZE; ++l_first)
+				{
+					auto node = _tasks.GetMemory();
+
+					try
+					{
+						tasks[count] = new (node) Task(*l_first);
+					}
+					catch (...)
+					{
+						_tasks.Release(node);
+						throw;
+					}
+
+					++count;
+				}
+			}
+			catch (...)
+			{
+				Discard(tasks, count);
+				throw;
+			}
+
+			Submit(tasks, count);
 		}
-		condition.notify_all();
-		for(std::thread &worker: workers)
-			worker.join();
 	}
 
 }
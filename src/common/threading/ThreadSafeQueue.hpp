@@ -19,8 +19,10 @@
 #ifndef EXPORT_GIGGLE_THREADSAFEQUEUE_HPP
 #define EXPORT_GIGGLE_THREADSAFEQUEUE_HPP
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <mutex>
 #include <queue>
 #include <utility>
@@ -64,10 +66,7 @@ namespace giggle::common::threading {
 		bool WaitPop(T& out)
 		{
 			std::unique_lock<std::mutex> lock{m_mutex};
-			m_condition.wait(lock, [this]()
-			{
-				return !m_queue.empty() || !m_valid;
-			});
+			Wait(lock);
 			/*
 			 * Using the condition in the predicate ensures that spurious wakeups with a valid
 			 * but empty queue will not proceed, so only need to check for validity before proceeding.
@@ -81,6 +80,38 @@ namespace giggle::common::threading {
 			return true;
 		}
 
+		/**
+		 * Attempt to get up to max values from the front of the queue, under a single lock.
+		 * Writes them to the out iterator and returns how many it wrote.
+		 */
+		template<typename OutputIterator>
+		std::size_t TryPopBatch(OutputIterator out, std::size_t max)
+		{
+			std::lock_guard<std::mutex> lock{m_mutex};
+			if(!m_valid)
+			{
+				return 0;
+			}
+			return PopLocked(out, max);
+		}
+
+		/**
+		 * Get up to max values from the front of the queue, under a single lock.
+		 * Will block until a value is available unless clear is called or the instance is destructed.
+		 * Writes them to the out iterator and returns how many it wrote, 0 if the queue was invalidated.
+		 */
+		template<typename OutputIterator>
+		std::size_t PopBatch(OutputIterator out, std::size_t max)
+		{
+			std::unique_lock<std::mutex> lock{m_mutex};
+			Wait(lock);
+			if(!m_valid)
+			{
+				return 0;
+			}
+			return PopLocked(out, max);
+		}
+
 		/**
 		 * Push a new value onto the queue.
 		 */
@@ -91,6 +122,43 @@ namespace giggle::common::threading {
 			m_condition.notify_one();
 		}
 
+		/**
+		 * Push a copy of every value in [first, last) onto the queue, under a single lock.
+		 * Pass move iterators to move them instead. Wakes one waiting thread per value,
+		 * or all of them if there are more values than waiting threads.
+		 */
+		template<typename Iterator>
+		void PushRange(Iterator first, Iterator last)
+		{
+			std::lock_guard<std::mutex> lock{m_mutex};
+			std::size_t count = 0;
+			try
+			{
+				for(; first != last; ++first, ++count)
+				{
+					m_queue.push(*first);
+				}
+			}
+			catch(...)
+			{
+				// what made it in is still served
+				m_condition.notify_all();
+				throw;
+			}
+
+			if(count >= m_waiters)
+			{
+				m_condition.notify_all();
+			}
+			else
+			{
+				while(count-- > 0)
+				{
+					m_condition.notify_one();
+				}
+			}
+		}
+
 		/**
 		 * Check whether or not the queue is empty.
 		 */
@@ -138,7 +206,30 @@ namespace giggle::common::threading {
 
 	private:
 
+		void Wait(std::unique_lock<std::mutex>& lock)
+		{
+			++m_waiters;
+			m_condition.wait(lock, [this]()
+			{
+				return !m_queue.empty() || !m_valid;
+			});
+			--m_waiters;
+		}
+
+		template<typename OutputIterator>
+		std::size_t PopLocked(OutputIterator out, std::size_t max)
+		{
+			auto count = std::min(max, m_queue.size());
+			for(std::size_t i = 0; i < count; ++i)
+			{
+				*out++ = std::move(m_queue.front());
+				m_queue.pop();
+			}
+			return count;
+		}
+
 		std::atomic_bool m_valid{true};
+		std::size_t m_waiters{0};
 		mutable std::mutex m_mutex;
 		std::queue<T> m_queue;
 		std::condition_variable m_condition;
@@ -0,0 +1,44 @@
+/*
+* export-giggle
+* Threading.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_THREADING_HPP
+#define EXPORT_GIGGLE_THREADING_HPP
+
+#include <Types.hpp>
+#include <cstddef>
+
+namespace giggle::common::threading
+{
+
+	/// Data written by different threads is kept this far apart to avoid false sharing.
+	const std::size_t CACHE_LINE_SIZE = 64;
+
+	namespace detail
+	{
+		inline std::size_t RoundUpToPowerOfTwo(std::size_t l_value)
+		{
+			std::size_t power = 1;
+			while (power < l_value)
+				power <<= 1;
+			return power;
+		}
+	}
+
+} // namespace threading
+
+#endif //EXPORT_GIGGLE_THREADING_HPP
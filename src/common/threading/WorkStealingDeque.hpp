@@ -0,0 +1,253 @@
+/*
+* export-giggle
+* WorkStealingDeque.hpp
+* Created by Nuno Levezinho on 17/10/2026.
+*
+* Copyright (c) 2018 [Nuno Levezinho] All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*/
+
+#ifndef EXPORT_GIGGLE_WORKSTEALINGDEQUE_HPP
+#define EXPORT_GIGGLE_WORKSTEALINGDEQUE_HPP
+
+#include "Threading.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace giggle::common::threading
+{
+
+	/**
+	 * @brief A Chase-Lev work-stealing deque.
+	 *
+	 * The owning thread pushes and pops at the bottom, like a stack,
+	 * without any read-modify-write unless the deque is down to its last
+	 * item; any other thread may steal the oldest item from the top with
+	 * a single compare-and-swap. Owners working depth first on what they
+	 * just spawned keep their data in cache, while thieves take the big,
+	 * old chunks of work.
+	 *
+	 * The array grows when full; arrays that were replaced are kept until
+	 * the deque is destroyed, as a thief may still be reading one. Items
+	 * are copied around racily, so T must be trivially copyable (a pointer
+	 * to the actual work, typically). Follows Lê, Pop, Cohen and Zappa
+	 * Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models".
+	 */
+	template <class T>
+	class WorkStealingDeque
+	{
+	public:
+
+		enum
+		{
+			DEFAULT_CAPACITY = 256
+		};
+
+		/**
+		 * @param l_capacity The initial capacity, rounded up to a power of two.
+		 */
+		explicit WorkStealingDeque(std::size_t l_capacity = DEFAULT_CAPACITY);
+		~WorkStealingDeque();
+
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		WorkStealingDeque& operator = (const WorkStealingDeque&) = delete;
+
+		/**
+		 * @brief Adds an item at the bottom. Owner only.
+		 */
+		void Push(T l_item);
+
+		/**
+		 * @brief Takes the newest item. Owner only.
+		 * @return false if the deque is empty.
+		 */
+		bool Pop(T& l_item);
+
+		/**
+		 * @brief Takes the oldest item. Any thread.
+		 * @return false if the deque is empty or another thread took the item first.
+		 */
+		bool Steal(T& l_item);
+
+		/**
+		 * @brief Returns the number of items; only a snapshot.
+		 */
+		std::size_t Size() const;
+
+		bool Empty() const;
+
+	private:
+
+		static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque items must be trivially copyable.");
+
+		struct Array
+		{
+			explicit Array(std::size_t l_capacity);
+			~Array();
+
+			T Get(std::int64_t l_index) const;
+			void Put(std::int64_t l_index, T l_item);
+
+			const std::int64_t		Mask;
+			std::atomic<T>*			Items;
+		};
+
+		Array* Grow(Array* l_array, std::int64_t l_bottom, std::int64_t l_top);
+
+		alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> _top;
+		alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> _bottom;
+		std::atomic<Array*>		_array;
+		std::vector<Array*>		_retired;
+	};
+
+	template <class T>
+	WorkStealingDeque<T>::Array::Array(std::size_t l_capacity):
+		Mask(static_cast<std::int64_t>(l_capacity) - 1),
+		Items(new std::atomic<T>[l_capacity])
+	{
+
+	}
+
+	template <class T>
+	WorkStealingDeque<T>::Array::~Array()
+	{
+		delete [] Items;
+	}
+
+	template <class T>
+	T WorkStealingDeque<T>::Array::Get(std::int64_t l_index) const
+	{
+		return Items[l_index & Mask].load(std::memory_order_relaxed);
+	}
+
+	template <class T>
+	void WorkStealingDeque<T>::Array::Put(std::int64_t l_index, T l_item)
+	{
+		Items[l_index & Mask].store(l_item, std::memory_order_relaxed);
+	}
+
+	template <class T>
+	WorkStealingDeque<T>::WorkStealingDeque(std::size_t l_capacity):
+		_top(0),
+		_bottom(0),
+		_array(new Array(detail::RoundUpToPowerOfTwo(l_capacity < 2 ? 2 : l_capacity))),
+		_retired()
+	{
+
+	}
+
+	template <class T>
+	WorkStealingDeque<T>::~WorkStealingDeque()
+	{
+		for (auto array : _retired)
+			delete array;
+
+		delete _array.load();
+	}
+
+	template <class T>
+	void WorkStealingDeque<T>::Push(T l_item)
+	{
+		auto bottom = _bottom.load(std::memory_order_relaxed);
+		auto top = _top.load(std::memory_order_acquire);
+		auto array = _array.load(std::memory_order_relaxed);
+
+		if (bottom - top > array->Mask)
+		{
+			array = Grow(array, bottom, top);
+		}
+
+		array->Put(bottom, l_item);
+		_bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	template <class T>
+	bool WorkStealingDeque<T>::Pop(T& l_item)
+	{
+		auto bottom = _bottom.load(std::memory_order_relaxed) - 1;
+		auto array = _array.load(std::memory_order_relaxed);
+		_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto top = _top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			// Empty.
+			_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		l_item = array->Get(bottom);
+		if (top < bottom)
+			return true;
+
+		// The last item: race the thieves for it.
+		auto won = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return won;
+	}
+
+	template <class T>
+	bool WorkStealingDeque<T>::Steal(T& l_item)
+	{
+		auto top = _top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto bottom = _bottom.load(std::memory_order_acquire);
+
+		if (top >= bottom)
+			return false;
+
+		auto item = _array.load(std::memory_order_acquire)->Get(top);
+		if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return false;
+
+		l_item = item;
+		return true;
+	}
+
+	template <class T>
+	std::size_t WorkStealingDeque<T>::Size() const
+	{
+		auto bottom = _bottom.load(std::memory_order_relaxed);
+		auto top = _top.load(std::memory_order_relaxed);
+		return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+	}
+
+	template <class T>
+	bool WorkStealingDeque<T>::Empty() const
+	{
+		return Size() == 0;
+	}
+
+	template <class T>
+	typename WorkStealingDeque<T>::Array* WorkStealingDeque<T>::Grow(Array* l_array, std::int64_t l_bottom,
+																		std::int64_t l_top)
+	{
+		auto array = new Array(static_cast<std::size_t>(l_array->Mask + 1) * 2);
+
+		for (auto index = l_top; index < l_bottom; ++index)
+		{
+			array->Put(index, l_array->Get(index));
+		}
+
+		_retired.push_back(l_array);
+		_array.store(array, std::memory_order_release);
+		return array;
+	}
+
+} // namespace threading
+
+#endif //EXPORT_GIGGLE_WORKSTEALINGDEQUE_HPP